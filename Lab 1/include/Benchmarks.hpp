@@ -0,0 +1,286 @@
+#pragma once
+
+#include <imgui.h>
+
+#include <core/include/Clock.hpp>
+#include <core/include/FramePacer.hpp>
+#include <wrappers/include/winthread.hpp>
+
+#include <bit>
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#if defined(RETRO_COMM)
+namespace retro::comm
+{
+    class communicator;
+}
+#endif
+
+namespace retro::benchmark
+{
+    struct LatencySummary
+    {
+        double mean = 0.0;
+        double p50 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+
+        size_t samples = 0;
+    };
+
+    inline double Percentile(const std::vector<double>& sorted, double percentile)
+    {
+        if (sorted.empty())
+        {
+            return 0.0;
+        }
+
+        const auto index = static_cast<size_t>(percentile * static_cast<double>(sorted.size() - 1));
+        return sorted.at(index);
+    }
+
+    inline LatencySummary Summarize(std::vector<double> samples)
+    {
+        LatencySummary summary;
+
+        if (samples.empty())
+        {
+            return summary;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        double total = 0.0;
+        for (const auto sample : samples)
+        {
+            total += sample;
+        }
+
+        summary.samples = samples.size();
+        summary.mean = total / static_cast<double>(samples.size());
+        summary.p50 = Percentile(samples, 0.50);
+        summary.p99 = Percentile(samples, 0.99);
+        summary.max = samples.back();
+
+        return summary;
+    }
+
+    // Log-linear histogram (16 linear buckets per power of two, ~6% relative error). Cheap enough to record
+    // every single sample from a hot loop, unlike pushing them all into a vector
+    class LatencyHistogram
+    {
+    public:
+
+        void Add(uint64_t value)
+        {
+            m_buckets.at(BucketIndex(value))++;
+            m_count++;
+        }
+
+        void Merge(const LatencyHistogram& other)
+        {
+            for (size_t i = 0; i < m_buckets.size(); i++)
+            {
+                m_buckets.at(i) += other.m_buckets.at(i);
+            }
+
+            m_count += other.m_count;
+        }
+
+        [[nodiscard]] uint64_t Percentile(double percentile) const
+        {
+            const auto target = static_cast<uint64_t>(percentile * static_cast<double>(m_count));
+            uint64_t seen = 0;
+
+            for (size_t i = 0; i < m_buckets.size(); i++)
+            {
+                seen += m_buckets.at(i);
+
+                if (seen > target)
+                {
+                    return BucketValue(i);
+                }
+            }
+
+            return 0;
+        }
+
+        [[nodiscard]] uint64_t Count() const
+        {
+            return m_count;
+        }
+
+    private:
+
+        static constexpr size_t sub_buckets = 16;
+
+        static size_t BucketIndex(uint64_t value)
+        {
+            if (value < sub_buckets)
+            {
+                return static_cast<size_t>(value);
+            }
+
+            const auto shift = std::bit_width(value) - 5;
+            return (shift + 1) * sub_buckets + static_cast<size_t>((value >> shift) & (sub_buckets - 1));
+        }
+
+        static uint64_t BucketValue(size_t index)
+        {
+            const auto group = index / sub_buckets;
+            const auto sub = index % sub_buckets;
+
+            return group == 0 ? sub : (sub_buckets + sub) << (group - 1);
+        }
+
+    private:
+
+        std::array<uint64_t, 61 * sub_buckets> m_buckets { };
+
+        uint64_t m_count = 0;
+
+    };
+
+    inline bool DrawButtonConditionally(const std::string& label, bool disabled, const std::string& hint)
+    {
+        if (disabled)
+        {
+            ImGui::PushStyleVar(ImGuiStyleVar_Alpha, 0.5f);
+            ImGui::Button(label.c_str());
+            ImGui::PopStyleVar();
+
+            if (!hint.empty() && (ImGui::IsItemHovered() || ImGui::IsItemActive()))
+            {
+                ImGui::SetTooltip("%s", hint.c_str());
+            }
+
+            return false;
+        }
+        else
+        {
+            return ImGui::Button(label.c_str());
+        }
+    }
+
+    // One row of a 5 column "name | mean | p50 | p99 | max" table, values in microseconds
+    inline void DrawLatencyRow(const char * label, const LatencySummary& summary)
+    {
+        ImGui::TableNextRow();
+
+        ImGui::TableSetColumnIndex(0);
+        ImGui::Text("%s", label);
+
+        ImGui::TableSetColumnIndex(1);
+        ImGui::Text("%.2f us", summary.mean);
+
+        ImGui::TableSetColumnIndex(2);
+        ImGui::Text("%.2f us", summary.p50);
+
+        ImGui::TableSetColumnIndex(3);
+        ImGui::Text("%.2f us", summary.p99);
+
+        ImGui::TableSetColumnIndex(4);
+        ImGui::Text("%.2f us", summary.max);
+    }
+
+    inline bool BeginLatencyTable(const char * id)
+    {
+        if (ImGui::BeginTable(id, 5, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedSame))
+        {
+            ImGui::TableSetupColumn("Mode");
+            ImGui::TableSetupColumn("Mean");
+            ImGui::TableSetupColumn("p50");
+            ImGui::TableSetupColumn("p99");
+            ImGui::TableSetupColumn("Max");
+            ImGui::TableHeadersRow();
+
+            return true;
+        }
+
+        return false;
+    }
+
+    // The thread a benchmark window runs its suite on, and how many of the suite's runs are done. One per
+    // window, a suite runs at a time
+    class BenchmarkSuite
+    {
+    public:
+
+        // Disabled while the suite is running, returns true when clicked
+        bool DrawRunButton(const std::string& label, const std::string& busy_hint)
+        {
+            return DrawButtonConditionally(label, IsRunning(), busy_hint);
+        }
+
+        // Runs job on the suite's thread; it calls Advance() after each of its total runs
+        template<typename Func>
+        void Run(int total, Func&& job)
+        {
+            m_done.store(0, std::memory_order_relaxed);
+            m_total.store(total, std::memory_order_relaxed);
+
+            m_thread.run(
+                    [job = std::forward<Func>(job)]() mutable
+                    {
+                        // The UI keeps its busy refresh rate for as long as the suite runs
+                        core::FramePacer::JobScope scope;
+                        job();
+                    });
+        }
+
+        // Any thread
+        void Advance()
+        {
+            m_done.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool IsRunning() const
+        {
+            return m_thread.is_running();
+        }
+
+        void DrawProgress() const
+        {
+            const auto done = m_done.load(std::memory_order_relaxed);
+            const auto total = std::max(m_total.load(std::memory_order_relaxed), 1);
+
+            ImGui::ProgressBar(static_cast<float>(done) / static_cast<float>(total));
+        }
+
+    private:
+
+        thread::winthread m_thread;
+
+        std::atomic<int> m_done { 0 };
+        std::atomic<int> m_total { 0 };
+
+    };
+
+    void RenderPoolBenchmarkWindow();
+
+    void RenderLockBenchmarkWindow();
+
+    void RenderQueueBenchmarkWindow();
+
+    void RenderDispatchBenchmarkWindow();
+
+    void RenderBarrierBenchmarkWindow();
+
+    void RenderCounterBenchmarkWindow();
+
+    void RenderReclaimBenchmarkWindow();
+
+    void RenderLifecycleBenchmarkWindow();
+
+#if defined(RETRO_COMM)
+    void RenderCollectivesBenchmarkWindow();
+
+    // What the worker processes of the collectives benchmark run instead of the UI, see main()
+    int RunCollectivesWorker(comm::communicator& world);
+#endif
+}
@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <wrappers/include/winmutex.hpp>
+#include <wrappers/include/adaptive_mutex.hpp>
 #include <wrappers/include/winthread.hpp>
 
 namespace retro
@@ -0,0 +1,253 @@
+#include <Benchmarks.hpp>
+
+#include <wrappers/include/pool.hpp>
+#include <wrappers/include/team.hpp>
+#include <wrappers/include/barrier.hpp>
+#include <wrappers/include/winthread.hpp>
+
+#include <array>
+#include <cfloat>
+#include <atomic>
+#include <chrono>
+#include <barrier>
+#include <string_view>
+
+using namespace retro;
+
+namespace
+{
+    using clock_type = core::Clock;
+
+    struct SyncResult
+    {
+        const char * method = "";
+
+        int threads = 0;
+        double iteration_ns = 0.0;
+    };
+
+    int iterations = 10000;
+    int max_threads_count = 64;
+
+    benchmark::BenchmarkSuite benchmark_suite;
+
+    std::vector<SyncResult> results;
+
+    // Every thread crosses the barrier iterations times, nothing else happens in between: what is left is
+    // the pure cost of one synchronization step of an iterative kernel
+    template<typename Arrive>
+    double MeasureBarrier(int threads, int count, Arrive&& arrive)
+    {
+        std::atomic<int> ready { 0 };
+        std::atomic<bool> go { false };
+
+        std::vector<thread::winthread> workers;
+        workers.reserve(threads);
+
+        for (int i = 0; i < threads; i++)
+        {
+            workers.emplace_back(
+                    [&, index = static_cast<uint32_t>(i)]()
+                    {
+                        ready.fetch_add(1);
+                        while (!go.load(std::memory_order_acquire))
+                        {
+                            std::this_thread::yield();
+                        }
+
+                        for (int iteration = 0; iteration < count; iteration++)
+                        {
+                            arrive(index);
+                        }
+                    });
+            workers.back().run();
+        }
+
+        while (ready.load() < threads)
+        {
+            std::this_thread::yield();
+        }
+
+        const auto start = clock_type::now();
+        go.store(true, std::memory_order_release);
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        return std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / count;
+    }
+
+    SyncResult MeasureCentral(int threads, int count)
+    {
+        sync::barrier barrier(threads);
+        return { "sync::barrier", threads, MeasureBarrier(threads, count, [&](uint32_t) { barrier.arrive_and_wait(); }) };
+    }
+
+    SyncResult MeasureTree(int threads, int count)
+    {
+        sync::tree_barrier barrier(threads);
+        return { "sync::tree_barrier", threads, MeasureBarrier(threads, count, [&](uint32_t index) { barrier.arrive_and_wait(index); }) };
+    }
+
+    SyncResult MeasurePhaser(int threads, int count)
+    {
+        sync::phaser phaser(threads);
+        return { "sync::phaser", threads, MeasureBarrier(threads, count, [&](uint32_t) { phaser.arrive_and_wait(); }) };
+    }
+
+    SyncResult MeasureStd(int threads, int count)
+    {
+        std::barrier barrier(threads);
+        return { "std::barrier", threads, MeasureBarrier(threads, count, [&](uint32_t) { barrier.arrive_and_wait(); }) };
+    }
+
+    // One dispatch of an empty body per iteration, i.e. a kernel that goes back to its caller every step
+    SyncResult MeasureTeamRun(int threads, int count)
+    {
+        thread::team team(threads);
+
+        const auto start = clock_type::now();
+
+        for (int iteration = 0; iteration < count; iteration++)
+        {
+            team.run([](uint32_t, uint32_t) { });
+        }
+
+        return { "team::run", threads, std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / count };
+    }
+
+    // What a parallel for per iteration amounts to: fork threads jobs onto the pool and join them all
+    SyncResult MeasurePoolForkJoin(int threads, int count)
+    {
+        auto& workers = thread::pool::shared();
+        std::vector<thread::pool::handle> handles(threads);
+
+        const auto start = clock_type::now();
+
+        for (int iteration = 0; iteration < count; iteration++)
+        {
+            for (auto& handle : handles)
+            {
+                handle = workers.submit([]() { });
+            }
+
+            for (const auto& handle : handles)
+            {
+                handle.wait();
+            }
+        }
+
+        return { "pool fork/join", threads, std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / count };
+    }
+
+    using SyncRunner = SyncResult(*)(int, int);
+
+    const std::array<std::pair<const char*, SyncRunner>, 6> sync_runners =
+    {{
+            { "sync::barrier", &MeasureCentral },
+            { "sync::tree_barrier", &MeasureTree },
+            { "sync::phaser", &MeasurePhaser },
+            { "std::barrier", &MeasureStd },
+            { "team::run", &MeasureTeamRun },
+            { "pool fork/join", &MeasurePoolForkJoin }
+    }};
+
+    // 2, 4, 8, ... up to max_threads, always including max_threads itself
+    std::vector<int> ThreadSteps(int max_threads)
+    {
+        std::vector<int> steps;
+
+        for (int threads = 2; threads < max_threads; threads *= 2)
+        {
+            steps.push_back(threads);
+        }
+
+        steps.push_back(max_threads);
+        return steps;
+    }
+
+    void DrawScalingPlot()
+    {
+        for (const auto& [name, runner] : sync_runners)
+        {
+            std::vector<float> cost;
+
+            for (const auto& result : results)
+            {
+                if (std::string_view(result.method) == name)
+                {
+                    cost.push_back(static_cast<float>(result.iteration_ns / 1000.0));
+                }
+            }
+
+            ImGui::PlotLines(name, cost.data(), static_cast<int>(cost.size()), 0, "us per iteration vs threads", 0.0F, FLT_MAX, ImVec2(0, 50));
+        }
+    }
+}
+
+void benchmark::RenderBarrierBenchmarkWindow()
+{
+    ImGui::Begin("Synchronization cost");
+
+    ImGui::SliderInt("Max threads", &max_threads_count, 2, 64);
+    ImGui::SliderInt("Iterations", &iterations, 100, 100000);
+
+    if (benchmark_suite.DrawRunButton("Run suite", "Benchmark is already running"))
+    {
+        const auto steps = ThreadSteps(max_threads_count);
+
+        benchmark_suite.Run(static_cast<int>(steps.size() * sync_runners.size()),
+                [steps, count = iterations]()
+                {
+                    std::vector<SyncResult> entries;
+
+                    for (const auto& [name, runner] : sync_runners)
+                    {
+                        for (const auto threads : steps)
+                        {
+                            entries.push_back(runner(threads, count));
+                            benchmark_suite.Advance();
+                        }
+                    }
+
+                    results = std::move(entries);
+                });
+    }
+
+    if (benchmark_suite.IsRunning())
+    {
+        benchmark_suite.DrawProgress();
+    }
+    else if (!results.empty())
+    {
+        DrawScalingPlot();
+
+        if (ImGui::BeginTable("Sync results", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+        {
+            ImGui::TableSetupColumn("Method");
+            ImGui::TableSetupColumn("Threads");
+            ImGui::TableSetupColumn("Per iteration");
+            ImGui::TableHeadersRow();
+
+            for (const auto& result : results)
+            {
+                ImGui::TableNextRow();
+
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", result.method);
+
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%d", result.threads);
+
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.2f us", result.iteration_ns / 1000.0);
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
+    ImGui::End();
+}
@@ -0,0 +1,321 @@
+#include <Benchmarks.hpp>
+
+#if defined(RETRO_COMM)
+
+#include <comm/include/comm.hpp>
+#include <wrappers/include/winthread.hpp>
+
+#include <span>
+#include <array>
+#include <cfloat>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+
+using namespace retro;
+
+namespace
+{
+    using clock_type = core::Clock;
+
+    // Broadcast from rank 0 at the start of every run, so it has to stay trivially copyable
+    struct CollectivesConfig
+    {
+        int kind = 0;
+        int processes = 4;
+        int max_kib = 1024;
+        int iterations = 200;
+    };
+
+    struct CollectiveResult
+    {
+        const char * name = "";
+
+        std::vector<size_t> sizes;
+
+        // Per size, microseconds per operation and megabytes per second moved through each rank
+        std::vector<float> latencies;
+        std::vector<float> bandwidths;
+    };
+
+    CollectivesConfig config;
+
+    benchmark::BenchmarkSuite benchmark_suite;
+
+    std::vector<CollectiveResult> results;
+    std::string last_error;
+
+    // Buffers big enough for the largest message; the root of scatter/gather needs a block per rank
+    struct Buffers
+    {
+        std::vector<double> input;
+        std::vector<double> output;
+        std::vector<double> blocks;
+    };
+
+    using Operation = void(*)(comm::communicator&, Buffers&, size_t count);
+
+    // Half a round trip between ranks 0 and 1, the other ranks sit it out
+    void PingPong(comm::communicator& world, Buffers& buffers, size_t count)
+    {
+        const auto message = std::span<double>(buffers.input.data(), count);
+
+        if (world.rank() == 0)
+        {
+            world.send(1, std::span<const double>(message));
+            world.recv(1, message);
+        }
+        else if (world.rank() == 1)
+        {
+            world.recv(0, message);
+            world.send(0, std::span<const double>(message));
+        }
+    }
+
+    void Barrier(comm::communicator& world, Buffers&, size_t)
+    {
+        world.barrier();
+    }
+
+    void Broadcast(comm::communicator& world, Buffers& buffers, size_t count)
+    {
+        world.broadcast(std::span<double>(buffers.input.data(), count));
+    }
+
+    void Reduce(comm::communicator& world, Buffers& buffers, size_t count)
+    {
+        world.reduce(std::span<const double>(buffers.input.data(), count), std::span<double>(buffers.output.data(), count), std::plus<>());
+    }
+
+    void Allreduce(comm::communicator& world, Buffers& buffers, size_t count)
+    {
+        world.allreduce(std::span<const double>(buffers.input.data(), count), std::span<double>(buffers.output.data(), count), std::plus<>());
+    }
+
+    void Scatter(comm::communicator& world, Buffers& buffers, size_t count)
+    {
+        world.scatter(std::span<const double>(buffers.blocks.data(), count * world.size()), std::span<double>(buffers.output.data(), count));
+    }
+
+    void Gather(comm::communicator& world, Buffers& buffers, size_t count)
+    {
+        world.gather(std::span<const double>(buffers.input.data(), count), std::span<double>(buffers.blocks.data(), count * world.size()));
+    }
+
+    const std::array<std::pair<const char *, Operation>, 7> operations =
+    {{
+            { "Send/recv", &PingPong },
+            { "Barrier", &Barrier },
+            { "Broadcast", &Broadcast },
+            { "Reduce", &Reduce },
+            { "Allreduce", &Allreduce },
+            { "Scatter", &Scatter },
+            { "Gather", &Gather }
+    }};
+
+    // 8 bytes up to the configured maximum in steps of 4x
+    std::vector<size_t> MessageSizes(const CollectivesConfig& settings)
+    {
+        std::vector<size_t> sizes;
+
+        for (size_t bytes = sizeof(double); bytes <= static_cast<size_t>(settings.max_kib) * 1024; bytes *= 4)
+        {
+            sizes.push_back(bytes);
+        }
+
+        return sizes;
+    }
+
+    // The SPMD part, every rank runs it. Only rank 0's clock counts: the iterations are fenced by barriers, so
+    // the time per operation includes a share of one barrier, which is what a real step would pay as well
+    std::vector<CollectiveResult> RunSuite(comm::communicator& world, CollectivesConfig settings)
+    {
+        world.broadcast(std::span<CollectivesConfig>(&settings, 1));
+
+        const auto sizes = MessageSizes(settings);
+        const auto max_count = sizes.empty() ? 1 : sizes.back() / sizeof(double);
+
+        Buffers buffers;
+        buffers.input.assign(max_count, 1.0);
+        buffers.output.assign(max_count, 0.0);
+        buffers.blocks.assign(max_count * world.size(), 1.0);
+
+        std::vector<CollectiveResult> suite;
+
+        for (const auto& [name, operation] : operations)
+        {
+            CollectiveResult result;
+            result.name = name;
+
+            // A barrier moves no payload, one row is enough
+            const auto& measured_sizes = operation == &Barrier ? std::vector<size_t>(1, 0) : sizes;
+
+            for (const auto bytes : measured_sizes)
+            {
+                const auto count = bytes / sizeof(double);
+
+                // Warm-up: faults the rings in and lets every rank get scheduled once
+                operation(world, buffers, count);
+                world.barrier();
+
+                const auto started = clock_type::now();
+
+                for (int i = 0; i < settings.iterations; i++)
+                {
+                    operation(world, buffers, count);
+                }
+
+                world.barrier();
+
+                const auto seconds = std::chrono::duration<double>(clock_type::now() - started).count();
+                auto per_operation = seconds / settings.iterations;
+
+                // A round trip is two messages
+                if (operation == &PingPong)
+                {
+                    per_operation /= 2.0;
+                }
+
+                result.sizes.push_back(bytes);
+                result.latencies.push_back(static_cast<float>(per_operation * 1e6));
+                result.bandwidths.push_back(static_cast<float>(static_cast<double>(bytes) / per_operation / 1e6));
+            }
+
+            suite.push_back(std::move(result));
+
+            if (world.rank() == 0)
+            {
+                benchmark_suite.Advance();
+            }
+        }
+
+        return suite;
+    }
+
+    void DrawSize(size_t bytes)
+    {
+        if (bytes >= 1024 * 1024)
+        {
+            ImGui::Text("%zu MiB", bytes / (1024 * 1024));
+        }
+        else if (bytes >= 1024)
+        {
+            ImGui::Text("%zu KiB", bytes / 1024);
+        }
+        else
+        {
+            ImGui::Text("%zu B", bytes);
+        }
+    }
+
+    void DrawResult(const CollectiveResult& result)
+    {
+        if (!ImGui::TreeNode(result.name))
+        {
+            return;
+        }
+
+        if (ImGui::BeginTable(result.name, 3, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedSame))
+        {
+            ImGui::TableSetupColumn("Size");
+            ImGui::TableSetupColumn("Latency");
+            ImGui::TableSetupColumn("Bandwidth");
+            ImGui::TableHeadersRow();
+
+            for (size_t i = 0; i < result.sizes.size(); i++)
+            {
+                ImGui::TableNextRow();
+
+                ImGui::TableSetColumnIndex(0);
+                DrawSize(result.sizes.at(i));
+
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.2f us", result.latencies.at(i));
+
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.1f MB/s", result.bandwidths.at(i));
+            }
+
+            ImGui::EndTable();
+        }
+
+        // Sizes grow 4x per point, so the curves read as log-log-ish: flat while latency bound, then climbing
+        if (result.sizes.size() > 1)
+        {
+            ImGui::PlotLines("Latency, us", result.latencies.data(), static_cast<int>(result.latencies.size()), 0, nullptr, 0.0F, FLT_MAX, ImVec2(0, 60));
+            ImGui::PlotLines("Bandwidth, MB/s", result.bandwidths.data(), static_cast<int>(result.bandwidths.size()), 0, nullptr, 0.0F, FLT_MAX, ImVec2(0, 60));
+        }
+
+        ImGui::TreePop();
+    }
+}
+
+int benchmark::RunCollectivesWorker(comm::communicator& world)
+{
+    try
+    {
+        RunSuite(world, CollectivesConfig { });
+    }
+    catch (const std::exception& error)
+    {
+        std::fprintf(stderr, "Rank %d: %s\n", world.rank(), error.what());
+        return 1;
+    }
+
+    return 0;
+}
+
+void benchmark::RenderCollectivesBenchmarkWindow()
+{
+    ImGui::Begin("Collectives");
+
+    ImGui::Combo("Transport", &config.kind, comm::transport_names.data(), static_cast<int>(comm::transport_names.size()));
+    ImGui::SliderInt("Processes", &config.processes, 2, 16);
+    ImGui::SliderInt("Max message, KiB", &config.max_kib, 1, 16384, "%d", ImGuiSliderFlags_Logarithmic);
+    ImGui::SliderInt("Iterations", &config.iterations, 10, 10000, "%d", ImGuiSliderFlags_Logarithmic);
+
+    if (benchmark_suite.DrawRunButton("Run suite", "Benchmark is already running"))
+    {
+        benchmark_suite.Run(static_cast<int>(operations.size()),
+                [settings = config]()
+                {
+                    try
+                    {
+                        comm::launch_options options;
+                        options.processes = settings.processes;
+                        options.kind = static_cast<comm::transport_kind>(settings.kind);
+
+                        auto world = comm::launch(options);
+
+                        results = RunSuite(*world, settings);
+                        last_error.clear();
+                    }
+                    catch (const std::exception& error)
+                    {
+                        results.clear();
+                        last_error = error.what();
+                    }
+                });
+    }
+
+    if (benchmark_suite.IsRunning())
+    {
+        benchmark_suite.DrawProgress();
+    }
+    else if (!last_error.empty())
+    {
+        ImGui::TextColored(ImVec4(1.0F, 0.4F, 0.4F, 1.0F), "%s", last_error.c_str());
+    }
+    else
+    {
+        for (const auto& result : results)
+        {
+            DrawResult(result);
+        }
+    }
+
+    ImGui::End();
+}
+
+#endif
@@ -0,0 +1,280 @@
+#include <Benchmarks.hpp>
+
+#include <wrappers/include/cpu.hpp>
+#include <wrappers/include/sharded.hpp>
+#include <wrappers/include/winthread.hpp>
+
+#include <array>
+#include <cfloat>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+
+using namespace retro;
+
+namespace
+{
+    using clock_type = core::Clock;
+
+    struct CounterResult
+    {
+        const char * method = "";
+
+        int threads = 0;
+        double million_ops_per_second = 0.0;
+    };
+
+    int increments = 1000000;
+    int max_threads_count = 16;
+
+    benchmark::BenchmarkSuite benchmark_suite;
+
+    std::vector<CounterResult> results;
+
+    // Every thread does nothing but increments count times, threads * count / elapsed is the throughput of
+    // the counter itself. The final value is checked, a counter losing updates would look fast
+    template<typename Increment, typename Read>
+    double MeasureCounter(int threads, int count, Increment&& increment, Read&& read)
+    {
+        std::atomic<int> ready { 0 };
+        std::atomic<bool> go { false };
+
+        std::vector<thread::winthread> workers;
+        workers.reserve(threads);
+
+        for (int i = 0; i < threads; i++)
+        {
+            workers.emplace_back(
+                    [&, index = static_cast<size_t>(i)]()
+                    {
+                        ready.fetch_add(1);
+                        while (!go.load(std::memory_order_acquire))
+                        {
+                            std::this_thread::yield();
+                        }
+
+                        for (int iteration = 0; iteration < count; iteration++)
+                        {
+                            increment(index);
+                        }
+                    });
+            workers.back().run();
+        }
+
+        while (ready.load() < threads)
+        {
+            std::this_thread::yield();
+        }
+
+        const auto start = clock_type::now();
+        go.store(true, std::memory_order_release);
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        const auto elapsed = std::chrono::duration<double, std::micro>(clock_type::now() - start).count();
+
+        if (read() != static_cast<uint64_t>(threads) * static_cast<uint64_t>(count))
+        {
+            throw std::runtime_error("Error: Counter lost increments");
+        }
+
+        return static_cast<double>(threads) * count / elapsed;
+    }
+
+    // The cache line every core fights over
+    CounterResult MeasureSharedAtomic(int threads, int count)
+    {
+        std::atomic<uint64_t> counter { 0 };
+
+        return { "Shared atomic", threads, MeasureCounter(threads, count,
+                                                          [&](size_t) { counter.fetch_add(1, std::memory_order_relaxed); },
+                                                          [&]() { return counter.load(); }) };
+    }
+
+    // A slot per thread, but eight of them per cache line: nothing is shared, the line still ping-pongs
+    CounterResult MeasurePackedSlots(int threads, int count)
+    {
+        const auto slots = std::make_unique<std::atomic<uint64_t>[]>(threads);
+
+        const auto read = [&]()
+        {
+            uint64_t total = 0;
+            for (int i = 0; i < threads; i++)
+            {
+                total += slots[i].load();
+            }
+
+            return total;
+        };
+
+        return { "Per-thread slots, packed", threads, MeasureCounter(threads, count,
+                                                                     [&](size_t index) { slots[index].fetch_add(1, std::memory_order_relaxed); },
+                                                                     read) };
+    }
+
+    struct alignas(sync::cache_line_size) PaddedSlot
+    {
+        std::atomic<uint64_t> value { 0 };
+    };
+
+    // The upper bound: what sharded_counter would do if it knew each thread's slot up front
+    CounterResult MeasurePaddedSlots(int threads, int count)
+    {
+        const auto slots = std::make_unique<PaddedSlot[]>(threads);
+
+        const auto read = [&]()
+        {
+            uint64_t total = 0;
+            for (int i = 0; i < threads; i++)
+            {
+                total += slots[i].value.load();
+            }
+
+            return total;
+        };
+
+        return { "Per-thread slots, padded", threads, MeasureCounter(threads, count,
+                                                                     [&](size_t index) { slots[index].value.fetch_add(1, std::memory_order_relaxed); },
+                                                                     read) };
+    }
+
+    CounterResult MeasureSharded(int threads, int count)
+    {
+        concurrent::sharded_counter<uint64_t> counter;
+
+        return { "sharded_counter", threads, MeasureCounter(threads, count,
+                                                            [&](size_t) { counter.increment(); },
+                                                            [&]() { return counter.load(); }) };
+    }
+
+    using CounterRunner = CounterResult(*)(int, int);
+
+    const std::array<std::pair<const char*, CounterRunner>, 4> counter_runners =
+    {{
+            { "Shared atomic", &MeasureSharedAtomic },
+            { "Per-thread slots, packed", &MeasurePackedSlots },
+            { "Per-thread slots, padded", &MeasurePaddedSlots },
+            { "sharded_counter", &MeasureSharded }
+    }};
+
+    // 1, 2, 4, ... up to max_threads, always including max_threads itself
+    std::vector<int> ThreadSteps(int max_threads)
+    {
+        std::vector<int> steps;
+
+        for (int threads = 1; threads < max_threads; threads *= 2)
+        {
+            steps.push_back(threads);
+        }
+
+        steps.push_back(max_threads);
+        return steps;
+    }
+
+    void DrawScalingPlot()
+    {
+        for (const auto& [name, runner] : counter_runners)
+        {
+            std::vector<float> throughput;
+
+            for (const auto& result : results)
+            {
+                if (std::string_view(result.method) == name)
+                {
+                    throughput.push_back(static_cast<float>(result.million_ops_per_second));
+                }
+            }
+
+            ImGui::PlotLines(name, throughput.data(), static_cast<int>(throughput.size()), 0, "Mops/s vs threads", 0.0F, FLT_MAX, ImVec2(0, 50));
+        }
+    }
+}
+
+void benchmark::RenderCounterBenchmarkWindow()
+{
+    static std::string last_error;
+
+    ImGui::Begin("False sharing");
+
+    ImGui::SliderInt("Max threads", &max_threads_count, 1, 64);
+    ImGui::SliderInt("Increments per thread", &increments, 10000, 10000000);
+
+    if (benchmark_suite.DrawRunButton("Run suite", "Benchmark is already running"))
+    {
+        const auto steps = ThreadSteps(max_threads_count);
+
+        last_error.clear();
+
+        benchmark_suite.Run(static_cast<int>(steps.size() * counter_runners.size()),
+                [steps, count = increments]()
+                {
+                    std::vector<CounterResult> entries;
+
+                    try
+                    {
+                        for (const auto& [name, runner] : counter_runners)
+                        {
+                            for (const auto threads : steps)
+                            {
+                                entries.push_back(runner(threads, count));
+                                benchmark_suite.Advance();
+                            }
+                        }
+                    }
+                    catch (const std::exception& e)
+                    {
+                        last_error = e.what();
+                    }
+
+                    results = std::move(entries);
+                });
+    }
+
+    if (benchmark_suite.IsRunning())
+    {
+        benchmark_suite.DrawProgress();
+    }
+    else
+    {
+        if (!last_error.empty())
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", last_error.c_str());
+        }
+
+        if (!results.empty())
+        {
+            DrawScalingPlot();
+
+            if (ImGui::BeginTable("Counter results", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+            {
+                ImGui::TableSetupColumn("Counter");
+                ImGui::TableSetupColumn("Threads");
+                ImGui::TableSetupColumn("Throughput");
+                ImGui::TableHeadersRow();
+
+                for (const auto& result : results)
+                {
+                    ImGui::TableNextRow();
+
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::Text("%s", result.method);
+
+                    ImGui::TableSetColumnIndex(1);
+                    ImGui::Text("%d", result.threads);
+
+                    ImGui::TableSetColumnIndex(2);
+                    ImGui::Text("%.1f Mops/s", result.million_ops_per_second);
+                }
+
+                ImGui::EndTable();
+            }
+        }
+    }
+
+    ImGui::End();
+}
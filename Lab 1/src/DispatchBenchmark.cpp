@@ -0,0 +1,211 @@
+#include <Benchmarks.hpp>
+
+#include <wrappers/include/winthread.hpp>
+#include <wrappers/include/unique_function.hpp>
+
+#include <new>
+#include <tuple>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+
+using namespace retro;
+
+namespace
+{
+    // Allocations made by the calling thread. The replacement below serves the whole executable, all it adds
+    // to every allocation is this thread-local increment
+    thread_local uint64_t allocations_count = 0;
+}
+
+void * operator new(std::size_t size)
+{
+    allocations_count++;
+
+    if (void * pMemory = std::malloc(size == 0 ? 1 : size))
+    {
+        return pMemory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void * pMemory) noexcept
+{
+    std::free(pMemory);
+}
+
+void operator delete(void * pMemory, std::size_t) noexcept
+{
+    std::free(pMemory);
+}
+
+namespace
+{
+    using clock_type = core::Clock;
+
+    struct DispatchResult
+    {
+        const char * path = "";
+        size_t capture_bytes = 0;
+
+        double allocations_per_task = 0.0;
+
+        // Building the task, calling it once and destroying it, i.e. what a winthread::run() pays
+        double submit_ns = 0.0;
+
+        // Calling an already built task
+        double call_ns = 0.0;
+    };
+
+    template<size_t Bytes>
+    struct Payload
+    {
+        std::array<unsigned char, Bytes> bytes { };
+    };
+
+    volatile uint64_t sink = 0;
+
+    int iterations = 1000000;
+
+    std::vector<DispatchResult> results;
+
+    // What winthread::run(func, args...) used to store: copies of the callable and of an argument tuple,
+    // type-erased through std::function
+    template<typename Func, typename... Args>
+    std::function<void()> BindLegacy(const Func& runnable, const Args&... args)
+    {
+        auto args_tuple = std::make_tuple(args...);
+        return [runnable, args_tuple]() mutable
+        {
+            std::apply(runnable, args_tuple);
+        };
+    }
+
+    // Same as winthread::bind_runnable
+    template<typename Func, typename... Args>
+    thread::unique_function<void()> BindUnique(Func&& runnable, Args&&... args)
+    {
+        return [runnable = std::forward<Func>(runnable), args_tuple = std::make_tuple(std::forward<Args>(args)...)]() mutable
+        {
+            std::apply(runnable, args_tuple);
+        };
+    }
+
+    template<typename Make>
+    DispatchResult MeasurePath(const char * path, size_t capture_bytes, int count, Make&& make)
+    {
+        DispatchResult result;
+
+        result.path = path;
+        result.capture_bytes = capture_bytes;
+
+        const auto allocations_before = allocations_count;
+        const auto submit_start = clock_type::now();
+
+        for (int i = 0; i < count; i++)
+        {
+            auto task = make(i);
+            task();
+        }
+
+        const auto submit_elapsed = clock_type::now() - submit_start;
+        const auto allocations = allocations_count - allocations_before;
+
+        auto task = make(0);
+        const auto call_start = clock_type::now();
+
+        for (int i = 0; i < count; i++)
+        {
+            task();
+        }
+
+        const auto call_elapsed = clock_type::now() - call_start;
+
+        result.allocations_per_task = static_cast<double>(allocations) / count;
+        result.submit_ns = std::chrono::duration<double, std::nano>(submit_elapsed).count() / count;
+        result.call_ns = std::chrono::duration<double, std::nano>(call_elapsed).count() / count;
+
+        return result;
+    }
+
+    template<size_t Bytes>
+    void MeasureCapture(int count, std::vector<DispatchResult>& entries)
+    {
+        Payload<Bytes> payload;
+        payload.bytes.fill(1);
+
+        const auto runnable = [payload](int value)
+        {
+            sink = sink + payload.bytes.front() + value;
+        };
+
+        entries.push_back(MeasurePath("std::function", Bytes, count, [&](int i) { return BindLegacy(runnable, i); }));
+        entries.push_back(MeasurePath("unique_function", Bytes, count, [&](int i) { return BindUnique(runnable, i); }));
+    }
+}
+
+void benchmark::RenderDispatchBenchmarkWindow()
+{
+    static thread::winthread benchmark_thread;
+
+    ImGui::Begin("Task dispatch");
+
+    ImGui::SliderInt("Tasks", &iterations, 1000, 10000000);
+
+    if (DrawButtonConditionally("Measure", benchmark_thread.is_running(), "Benchmark is already running"))
+    {
+        benchmark_thread.run(
+                [count = iterations]()
+                {
+                    core::FramePacer::JobScope job;
+
+                    std::vector<DispatchResult> entries;
+
+                    MeasureCapture<8>(count, entries);
+                    MeasureCapture<32>(count, entries);
+                    MeasureCapture<64>(count, entries);
+                    MeasureCapture<256>(count, entries);
+
+                    results = std::move(entries);
+                });
+    }
+
+    if (benchmark_thread.is_running())
+    {
+        ImGui::Text("Measuring...");
+    }
+    else if (!results.empty() && ImGui::BeginTable("Dispatch results", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+    {
+        ImGui::TableSetupColumn("Task type");
+        ImGui::TableSetupColumn("Captured bytes");
+        ImGui::TableSetupColumn("Allocations per task");
+        ImGui::TableSetupColumn("Submit, ns");
+        ImGui::TableSetupColumn("Call, ns");
+        ImGui::TableHeadersRow();
+
+        for (const auto& result : results)
+        {
+            ImGui::TableNextRow();
+
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", result.path);
+
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%zu", result.capture_bytes);
+
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.2f", result.allocations_per_task);
+
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.1f", result.submit_ns);
+
+            ImGui::TableSetColumnIndex(4);
+            ImGui::Text("%.2f", result.call_ns);
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
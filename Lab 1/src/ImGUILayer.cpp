@@ -1,7 +1,14 @@
 #include <ImGUILayer.hpp>
+#include <Benchmarks.hpp>
+#include <core/include/Clock.hpp>
 #include <core/include/Timer.hpp>
+#include <ui/include/TracePanel.hpp>
+#include <ui/include/FramePacingPanel.hpp>
+#include <ui/include/LockProfilerPanel.hpp>
+#include <wrappers/include/seqlock.hpp>
 
 #include <array>
+#include <atomic>
 #include <iostream>
 #include <algorithm>
 
@@ -17,11 +24,27 @@ namespace
 {
     constexpr const char * async_default = "retro+";
 
-    int sleep_duration = 500;
+    // Published by the UI whenever a control changes, every thread reads it once as it starts its work
+    struct ThreadParameters
+    {
+        int sleep_duration = 500;
+        bool apply_lock_guard = false;
+    };
+
+    concurrent::seqlock<ThreadParameters> thread_parameters;
+
     bool track_timer = false;
-    bool apply_lock_guard = false;
+    double last_exec_time_ms = 0.0;
+
+    // Set right before the threads are started; together with the finish times the workers stamp themselves
+    // this gives the real wall time of a run instead of the frame at which the UI noticed it had ended. Both
+    // on core::Clock, like the live readout
+    core::Clock::time_point run_all_start;
+
+    // Latest end of a thread body since the last "Run all", in Clock ticks; 0 if none has ended yet
+    std::atomic<core::Clock::rep> last_finish_ticks { 0 };
 
-    mutex::winmutex async_mutex;
+    mutex::adaptive_mutex async_mutex;
     std::string async_test = async_default;
 
     const std::array<const char*, 5> priority_names =
@@ -35,22 +58,38 @@ namespace
 
     void async_invoke_func(size_t append)
     {
-        auto local_apply_guard = apply_lock_guard;
+        const auto parameters = thread_parameters.load();
 
-        if (local_apply_guard)
+        if (parameters.apply_lock_guard)
         {
             async_mutex.lock();
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep_duration));
+        // In slices: on POSIX pause() only takes hold at a safe point, and the thread would otherwise reach the
+        // first one after the whole sleep
+        constexpr auto slice = std::chrono::milliseconds(10);
+        const auto wake_up = std::chrono::steady_clock::now() + std::chrono::milliseconds(parameters.sleep_duration);
+
+        for (auto now = std::chrono::steady_clock::now(); now < wake_up; now = std::chrono::steady_clock::now())
+        {
+            thread::winthread::safe_point();
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(slice, wake_up - now));
+        }
 
         std::cerr << "Append!" << std::endl;
         async_test += std::to_string(append) + "-";
 
-        if (local_apply_guard)
+        if (parameters.apply_lock_guard)
         {
             async_mutex.unlock();
         }
+
+        const auto finish = core::Clock::now().time_since_epoch().count();
+        auto latest = last_finish_ticks.load(std::memory_order_relaxed);
+
+        while (latest < finish && !last_finish_ticks.compare_exchange_weak(latest, finish, std::memory_order_relaxed))
+        {
+        }
     }
 
     void DisplayBoolColored(const char* label, bool value)
@@ -65,6 +104,8 @@ namespace
 
 void ImGUILayer::OnAttach()
 {
+    async_mutex.set_name("async_mutex");
+
     m_window = std::make_unique<graphics::Window>();
 
     // Setup Dear ImGui context
@@ -113,10 +154,12 @@ void ImGUILayer::OnAttach()
 bool ImGUILayer::OnUpdate(ts delta)
 {
     const auto& io = ImGui::GetIO();
-    for (const auto& event : m_window->PollEvents())
-    {
-        core::EventsPoll::AddEvent(event);
-    }
+    // Sleeps until input, a finished job or the next low rate refresh, see core::FramePacer
+    auto& pacer = core::FramePacer::Get();
+    const auto events = m_window->PollEvents(pacer.GetWaitTimeout());
+    pacer.BeginFrame(events);
+
+    core::EventBus::Get().PostAll(events);
 
     ImGui_ImplDX11_NewFrame();
     ImGui_ImplSDL2_NewFrame();
@@ -149,6 +192,7 @@ bool ImGUILayer::OnUpdate(ts delta)
     }
 
     m_window->GetDirectXSwapChain()->Present(1, 0);
+    pacer.EndFrame();
 
     return true;
 }
@@ -176,7 +220,8 @@ void ImGUILayer::Render()
 
     ImGui::Begin("Threads");
 
-    ImGui::SliderInt("Sleep duration: ", &sleep_duration, 100, 2000);
+    auto parameters = thread_parameters.load();
+    bool are_parameters_changed = ImGui::SliderInt("Sleep duration: ", &parameters.sleep_duration, 100, 2000);
 
     ImGui::TextColored({ 1.0F, 0.5F, 0.5F, 1.0F }, "Not so atomic string: %s", async_test.c_str());
 
@@ -185,7 +230,12 @@ void ImGUILayer::Render()
         async_test = async_default;
     }
 
-    ImGui::Checkbox("Wrap resource in mutex?", &apply_lock_guard);
+    are_parameters_changed |= ImGui::Checkbox("Wrap resource in mutex?", &parameters.apply_lock_guard);
+
+    if (are_parameters_changed)
+    {
+        thread_parameters.publish(parameters);
+    }
 
     if (ImGui::Button("Add new thread"))
     {
@@ -267,7 +317,12 @@ void ImGUILayer::Render()
         track_timer = false;
         m_all_threads_run_timer.Stop();
 
-        exec_time_history.push_back((m_all_threads_run_timer.Tick<std::chrono::microseconds>() / 1000.0).count());
+        // Terminated threads never reach their stamp, if none did the UI's own reading has to do
+        const auto finish_ticks = last_finish_ticks.load(std::memory_order_relaxed);
+        const auto run_all_finish = finish_ticks != 0 ? core::Clock::time_point(core::Clock::duration(finish_ticks)) : core::Clock::now();
+
+        last_exec_time_ms = std::chrono::duration<double, std::milli>(run_all_finish - run_all_start).count();
+        exec_time_history.push_back(last_exec_time_ms);
     }
 
     if (!m_threads.empty())
@@ -276,6 +331,8 @@ void ImGUILayer::Render()
         {
             track_timer = true;
             m_all_threads_run_timer.Run();
+            last_finish_ticks.store(0, std::memory_order_relaxed);
+            run_all_start = core::Clock::now();
             std::for_each(m_threads.begin(), m_threads.end(), [](auto& thread) { thread.run(); });
         }
         ImGui::SameLine();
@@ -298,9 +355,9 @@ void ImGUILayer::Render()
         }
     }
 
-    const auto exec_time = m_all_threads_run_timer.Tick<std::chrono::microseconds>() / 1000.0;
+    const auto exec_time = track_timer ? (m_all_threads_run_timer.Tick<std::chrono::microseconds>() / 1000.0).count() : last_exec_time_ms;
 
-    ImGui::Text("Execution time: %f", exec_time.count());
+    ImGui::Text("Execution time: %f", exec_time);
 
     if (!exec_time_history.empty())
     {
@@ -320,4 +377,21 @@ void ImGUILayer::Render()
     }
 
     ImGui::End();
+
+    benchmark::RenderPoolBenchmarkWindow();
+    benchmark::RenderLockBenchmarkWindow();
+    benchmark::RenderQueueBenchmarkWindow();
+    benchmark::RenderDispatchBenchmarkWindow();
+    benchmark::RenderBarrierBenchmarkWindow();
+    benchmark::RenderCounterBenchmarkWindow();
+    benchmark::RenderReclaimBenchmarkWindow();
+    benchmark::RenderLifecycleBenchmarkWindow();
+
+#if defined(RETRO_COMM)
+    benchmark::RenderCollectivesBenchmarkWindow();
+#endif
+
+    ui::RenderLockProfilerPanel();
+    ui::RenderFramePacingPanel();
+    ui::RenderTracePanel();
 }
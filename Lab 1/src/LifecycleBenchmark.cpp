@@ -0,0 +1,402 @@
+#include <Benchmarks.hpp>
+
+#include <wrappers/include/cpu.hpp>
+#include <wrappers/include/pool.hpp>
+#include <wrappers/include/futex.hpp>
+#include <wrappers/include/winthread.hpp>
+
+#include <array>
+#include <mutex>
+#include <cfloat>
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+
+using namespace retro;
+
+namespace
+{
+    using clock_type = core::Clock;
+
+    struct LatencyResult
+    {
+        const char * name = "";
+
+        std::vector<double> samples;
+        benchmark::LatencySummary summary;
+    };
+
+    struct LifecycleConfig
+    {
+        int samples = 1000;
+
+        // Between two samples, long enough for the other side to be parked for real. Without it a blocking
+        // wait would often find the next wake-up already pending and never sleep at all
+        int gap_us = 200;
+    };
+
+    LifecycleConfig config;
+
+    benchmark::BenchmarkSuite benchmark_suite;
+
+    std::vector<LatencyResult> lifecycle_results;
+    std::vector<LatencyResult> wakeup_results;
+
+    double ToMicroseconds(clock_type::duration duration)
+    {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    void Gap(const LifecycleConfig& settings)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(settings.gap_us));
+    }
+
+    LatencyResult MakeResult(const char * name, std::vector<double> samples)
+    {
+        LatencyResult result;
+
+        result.name = name;
+        result.summary = benchmark::Summarize(samples);
+        result.samples = std::move(samples);
+
+        return result;
+    }
+
+    // A thread per job: create, start, join and destroy a winthread. Start is from the constructor to the
+    // job's first instruction, total until the winthread is gone again
+    void MeasureFreshThread(const LifecycleConfig& settings, std::vector<LatencyResult>& entries)
+    {
+        std::vector<double> start;
+        std::vector<double> total;
+
+        for (int i = 0; i < settings.samples; i++)
+        {
+            Gap(settings);
+
+            clock_type::time_point started;
+            const auto created = clock_type::now();
+
+            {
+                thread::winthread worker([&started]() { started = clock_type::now(); });
+                worker.run();
+                worker.join();
+            }
+
+            const auto destroyed = clock_type::now();
+
+            start.push_back(ToMicroseconds(started - created));
+            total.push_back(ToMicroseconds(destroyed - created));
+        }
+
+        entries.push_back(MakeResult("Fresh winthread, start", std::move(start)));
+        entries.push_back(MakeResult("Fresh winthread, create to join", std::move(total)));
+    }
+
+    // The same job handed to a pool worker that had the gap to park
+    void MeasureParkedWorker(const LifecycleConfig& settings, std::vector<LatencyResult>& entries)
+    {
+        auto& workers = thread::pool::shared();
+
+        std::vector<double> start;
+        std::vector<double> total;
+
+        for (int i = 0; i < settings.samples; i++)
+        {
+            Gap(settings);
+
+            clock_type::time_point started;
+            const auto submitted = clock_type::now();
+
+            workers.submit([&started]() { started = clock_type::now(); }).wait();
+
+            const auto finished = clock_type::now();
+
+            start.push_back(ToMicroseconds(started - submitted));
+            total.push_back(ToMicroseconds(finished - submitted));
+        }
+
+        entries.push_back(MakeResult("Parked pool worker, start", std::move(start)));
+        entries.push_back(MakeResult("Parked pool worker, submit to wait", std::move(total)));
+    }
+
+    // From resume() returning control to the thread making progress again. On Windows pause() suspends the
+    // thread wherever it is, elsewhere it parks at the next winthread::safe_point()
+    void MeasurePauseResume(const LifecycleConfig& settings, std::vector<LatencyResult>& entries)
+    {
+        std::atomic<uint64_t> progress { 0 };
+        std::atomic<bool> stop { false };
+
+        thread::winthread spinner(
+                [&]()
+                {
+                    while (!stop.load(std::memory_order_relaxed))
+                    {
+                        thread::winthread::safe_point();
+                        progress.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+        spinner.run();
+
+        std::vector<double> latencies;
+
+        for (int i = 0; i < settings.samples; i++)
+        {
+            spinner.pause();
+            Gap(settings);
+
+            const auto paused_at = progress.load();
+            const auto resumed = clock_type::now();
+
+            spinner.resume();
+
+            // Yielding, a spinning benchmark thread could keep the resumed one off its core
+            while (progress.load() == paused_at)
+            {
+                std::this_thread::yield();
+            }
+
+            latencies.push_back(ToMicroseconds(clock_type::now() - resumed));
+        }
+
+        stop.store(true);
+        spinner.join();
+
+        entries.push_back(MakeResult("Pause to resume", std::move(latencies)));
+    }
+
+    // Wake-up channels: the waiter blocks in Wait() until the generation moves past the one it has seen,
+    // Wake() moves it and lets the waiter know
+    struct ConditionVariableChannel
+    {
+        std::mutex wait_mutex;
+        std::condition_variable condition;
+
+        std::atomic<uint32_t> generation { 0 };
+
+        void Wait(uint32_t seen)
+        {
+            std::unique_lock lock(wait_mutex);
+            condition.wait(lock, [&]() { return generation.load(std::memory_order_relaxed) != seen; });
+        }
+
+        void Wake()
+        {
+            {
+                std::lock_guard lock(wait_mutex);
+                generation.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            condition.notify_one();
+        }
+    };
+
+    struct FutexChannel
+    {
+        std::atomic<uint32_t> generation { 0 };
+
+        void Wait(uint32_t seen)
+        {
+            while (generation.load(std::memory_order_acquire) == seen)
+            {
+                sync::futex_wait(generation, seen);
+            }
+        }
+
+        void Wake()
+        {
+            generation.fetch_add(1, std::memory_order_release);
+            sync::futex_wake_one(generation);
+        }
+    };
+
+    struct AtomicWaitChannel
+    {
+        std::atomic<uint32_t> generation { 0 };
+
+        void Wait(uint32_t seen)
+        {
+            generation.wait(seen, std::memory_order_acquire);
+        }
+
+        void Wake()
+        {
+            generation.fetch_add(1, std::memory_order_release);
+            generation.notify_one();
+        }
+    };
+
+    // Never sleeps, so the latency is cache line transfer only, paid for with a core burned while waiting
+    struct SpinChannel
+    {
+        std::atomic<uint32_t> generation { 0 };
+
+        void Wait(uint32_t seen)
+        {
+            while (generation.load(std::memory_order_acquire) == seen)
+            {
+                sync::cpu_relax();
+            }
+        }
+
+        void Wake()
+        {
+            generation.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    // The benchmark thread stamps the time and wakes a waiter, which measures how long it took to get going.
+    // One wake-up in flight at a time: the next one only goes out after the waiter acknowledged the last
+    template<typename Channel>
+    LatencyResult MeasureWakeUp(const char * name, const LifecycleConfig& settings)
+    {
+        Channel channel;
+
+        std::atomic<clock_type::rep> signalled { 0 };
+        std::atomic<uint32_t> acknowledged { 0 };
+
+        std::vector<double> latencies;
+        latencies.reserve(settings.samples);
+
+        thread::winthread waiter(
+                [&]()
+                {
+                    for (uint32_t seen = 0; seen < static_cast<uint32_t>(settings.samples); seen++)
+                    {
+                        channel.Wait(seen);
+
+                        const auto woken = clock_type::now();
+                        const auto sent = clock_type::time_point(clock_type::duration(signalled.load(std::memory_order_relaxed)));
+
+                        latencies.push_back(ToMicroseconds(woken - sent));
+                        acknowledged.store(seen + 1, std::memory_order_release);
+                    }
+                });
+        waiter.run();
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(settings.samples); i++)
+        {
+            Gap(settings);
+
+            signalled.store(clock_type::now().time_since_epoch().count(), std::memory_order_relaxed);
+            channel.Wake();
+
+            while (acknowledged.load(std::memory_order_acquire) != i + 1)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        waiter.join();
+
+        return MakeResult(name, std::move(latencies));
+    }
+
+    using LifecycleRunner = void(*)(const LifecycleConfig&, std::vector<LatencyResult>&);
+
+    const std::array<LifecycleRunner, 3> lifecycle_runners =
+    {
+            &MeasureFreshThread,
+            &MeasureParkedWorker,
+            &MeasurePauseResume
+    };
+
+    using WakeUpRunner = LatencyResult(*)(const char *, const LifecycleConfig&);
+
+    const std::array<std::pair<const char *, WakeUpRunner>, 4> wakeup_runners =
+    {{
+            { "Condition variable", &MeasureWakeUp<ConditionVariableChannel> },
+            { "Futex", &MeasureWakeUp<FutexChannel> },
+            { "Atomic wait", &MeasureWakeUp<AtomicWaitChannel> },
+            { "Spin", &MeasureWakeUp<SpinChannel> }
+    }};
+
+    // Bins up to the p99 sample, the slower ones all land in the last bin instead of squashing the rest
+    void DrawHistogram(const LatencyResult& result)
+    {
+        constexpr size_t bins_count = 48;
+
+        const auto upper = std::max(result.summary.p99, 0.001);
+
+        std::array<float, bins_count> bins { };
+        for (const auto sample : result.samples)
+        {
+            bins.at(std::min(static_cast<size_t>(sample / upper * bins_count), bins_count - 1)) += 1.0F;
+        }
+
+        std::array<char, 64> overlay { };
+        std::snprintf(overlay.data(), overlay.size(), "0 .. %.1f us", upper);
+
+        ImGui::PlotHistogram(result.name, bins.data(), static_cast<int>(bins.size()), 0, overlay.data(), 0.0F, FLT_MAX, ImVec2(0, 60));
+    }
+
+    void DrawResults(const char * id, const std::vector<LatencyResult>& results)
+    {
+        if (results.empty())
+        {
+            return;
+        }
+
+        if (benchmark::BeginLatencyTable(id))
+        {
+            for (const auto& result : results)
+            {
+                benchmark::DrawLatencyRow(result.name, result.summary);
+            }
+
+            ImGui::EndTable();
+        }
+
+        for (const auto& result : results)
+        {
+            DrawHistogram(result);
+        }
+    }
+}
+
+void benchmark::RenderLifecycleBenchmarkWindow()
+{
+    ImGui::Begin("Thread lifecycle");
+
+    ImGui::SliderInt("Samples", &config.samples, 100, 10000);
+    ImGui::SliderInt("Gap between samples, us", &config.gap_us, 0, 5000);
+
+    if (benchmark_suite.DrawRunButton("Run suite", "Benchmark is already running"))
+    {
+        benchmark_suite.Run(static_cast<int>(lifecycle_runners.size() + wakeup_runners.size()),
+                [settings = config]()
+                {
+                    std::vector<LatencyResult> lifecycle;
+                    std::vector<LatencyResult> wakeup;
+
+                    for (const auto runner : lifecycle_runners)
+                    {
+                        runner(settings, lifecycle);
+                        benchmark_suite.Advance();
+                    }
+
+                    for (const auto& [name, runner] : wakeup_runners)
+                    {
+                        wakeup.push_back(runner(name, settings));
+                        benchmark_suite.Advance();
+                    }
+
+                    lifecycle_results = std::move(lifecycle);
+                    wakeup_results = std::move(wakeup);
+                });
+    }
+
+    if (benchmark_suite.IsRunning())
+    {
+        benchmark_suite.DrawProgress();
+    }
+    else
+    {
+        // The price of a thread per job against a worker that is already there, next to the wake-up alone
+        DrawResults("Lifecycle latency", lifecycle_results);
+        DrawResults("Wake-up latency", wakeup_results);
+    }
+
+    ImGui::End();
+}
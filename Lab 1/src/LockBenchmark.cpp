@@ -0,0 +1,324 @@
+#include <Benchmarks.hpp>
+
+#include <wrappers/include/cpu.hpp>
+#include <wrappers/include/winmutex.hpp>
+#include <wrappers/include/winthread.hpp>
+#include <wrappers/include/spin_locks.hpp>
+#include <wrappers/include/adaptive_mutex.hpp>
+
+#include <mutex>
+#include <cfloat>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string_view>
+
+using namespace retro;
+
+namespace
+{
+    using clock_type = core::Clock;
+
+    enum class CriticalSection
+    {
+        EMPTY,
+        CACHE_LINE_WRITE,
+        STRING_APPEND
+    };
+
+    const std::array<const char*, 3> critical_section_names =
+    {
+            "Empty",
+            "Cache line write",
+            "String append"
+    };
+
+    struct RunConfig
+    {
+        int threads = 1;
+        int duration_ms = 200;
+        CriticalSection section = CriticalSection::EMPTY;
+    };
+
+    struct RunResult
+    {
+        const char * lock_name = "";
+
+        int threads = 0;
+        double ops_per_second = 0.0;
+
+        // Jain's index over per-thread acquisition counts: 1.0 is perfectly fair, 1/threads is one thread hogging
+        double fairness = 0.0;
+        uint64_t p99_acquire_ns = 0;
+
+        std::vector<uint64_t> acquisitions;
+    };
+
+    struct alignas(sync::cache_line_size) SharedLine
+    {
+        uint64_t words[sync::cache_line_size / sizeof(uint64_t)] = { };
+    };
+
+    struct alignas(sync::cache_line_size) WorkerStats
+    {
+        uint64_t acquisitions = 0;
+        benchmark::LatencyHistogram acquire_latency;
+    };
+
+    int max_threads_count = 4;
+    int duration_ms = 200;
+    int critical_section = 0;
+
+    benchmark::BenchmarkSuite benchmark_suite;
+
+    std::vector<RunResult> results;
+
+    double JainFairness(const std::vector<uint64_t>& counts)
+    {
+        double sum = 0.0;
+        double sum_of_squares = 0.0;
+
+        for (const auto count : counts)
+        {
+            sum += static_cast<double>(count);
+            sum_of_squares += static_cast<double>(count) * static_cast<double>(count);
+        }
+
+        return sum_of_squares > 0.0 ? (sum * sum) / (static_cast<double>(counts.size()) * sum_of_squares) : 0.0;
+    }
+
+    // All threads are released at once and hammer the lock until the deadline. Every acquisition is timed
+    // from the lock() call until it returns, the critical section itself is not part of the latency
+    template<typename Lock>
+    RunResult MeasureLock(const char * name, const RunConfig& config)
+    {
+        Lock lock;
+
+        SharedLine shared_line;
+        std::string shared_string;
+
+        std::atomic<int> ready { 0 };
+        std::atomic<bool> go { false };
+        std::atomic<bool> stop { false };
+
+        std::vector<WorkerStats> stats(config.threads);
+        std::vector<thread::winthread> workers;
+        workers.reserve(config.threads);
+
+        for (int i = 0; i < config.threads; i++)
+        {
+            workers.emplace_back(
+                    [&, index = i]()
+                    {
+                        auto& local = stats.at(index);
+
+                        ready.fetch_add(1);
+                        while (!go.load(std::memory_order_acquire))
+                        {
+                            sync::cpu_relax();
+                        }
+
+                        while (!stop.load(std::memory_order_relaxed))
+                        {
+                            const auto before = clock_type::now();
+                            lock.lock();
+                            const auto acquired = clock_type::now();
+
+                            switch (config.section)
+                            {
+                                case CriticalSection::EMPTY:
+                                    break;
+
+                                case CriticalSection::CACHE_LINE_WRITE:
+                                    for (auto& word : shared_line.words)
+                                    {
+                                        word++;
+                                    }
+                                    break;
+
+                                case CriticalSection::STRING_APPEND:
+                                    if (shared_string.size() > 4096)
+                                    {
+                                        shared_string.clear();
+                                    }
+                                    shared_string += std::to_string(index) + "-";
+                                    break;
+                            }
+
+                            lock.unlock();
+
+                            local.acquisitions++;
+                            local.acquire_latency.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(acquired - before).count());
+                        }
+                    });
+            workers.back().run();
+        }
+
+        while (ready.load() < config.threads)
+        {
+            std::this_thread::yield();
+        }
+
+        const auto start = clock_type::now();
+        go.store(true, std::memory_order_release);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.duration_ms));
+        stop.store(true, std::memory_order_relaxed);
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        const auto elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+
+        RunResult result;
+        benchmark::LatencyHistogram latency;
+        uint64_t total = 0;
+
+        for (const auto& local : stats)
+        {
+            total += local.acquisitions;
+            latency.Merge(local.acquire_latency);
+            result.acquisitions.push_back(local.acquisitions);
+        }
+
+        result.lock_name = name;
+        result.threads = config.threads;
+        result.ops_per_second = static_cast<double>(total) / elapsed;
+        result.fairness = JainFairness(result.acquisitions);
+        result.p99_acquire_ns = latency.Percentile(0.99);
+
+        return result;
+    }
+
+    using LockRunner = RunResult(*)(const char *, const RunConfig&);
+
+    const std::array<std::pair<const char*, LockRunner>, 7> lock_runners =
+    {{
+            { "winmutex", &MeasureLock<mutex::winmutex> },
+            { "adaptive_mutex", &MeasureLock<mutex::adaptive_mutex> },
+            { "std::mutex", &MeasureLock<std::mutex> },
+            { "TTAS", &MeasureLock<mutex::ttas_lock> },
+            { "Ticket", &MeasureLock<mutex::ticket_lock> },
+            { "MCS", &MeasureLock<mutex::mcs_lock> },
+            { "CLH", &MeasureLock<mutex::clh_lock> }
+    }};
+
+    // 1, 2, 4, ... up to max_threads, always including max_threads itself
+    std::vector<int> ThreadSteps(int max_threads)
+    {
+        std::vector<int> steps;
+
+        for (int threads = 1; threads < max_threads; threads *= 2)
+        {
+            steps.push_back(threads);
+        }
+
+        steps.push_back(max_threads);
+        return steps;
+    }
+
+    void DrawScalingPlot()
+    {
+        for (const auto& [name, runner] : lock_runners)
+        {
+            std::vector<float> throughput;
+
+            for (const auto& result : results)
+            {
+                if (std::string_view(result.lock_name) == name)
+                {
+                    throughput.push_back(static_cast<float>(result.ops_per_second / 1e6));
+                }
+            }
+
+            ImGui::PlotLines(name, throughput.data(), static_cast<int>(throughput.size()), 0, "Mops/s vs threads", 0.0F, FLT_MAX, ImVec2(0, 50));
+        }
+    }
+}
+
+void benchmark::RenderLockBenchmarkWindow()
+{
+    ImGui::Begin("Lock scaling");
+
+    ImGui::SliderInt("Max threads", &max_threads_count, 1, static_cast<int>(std::thread::hardware_concurrency()) * 2);
+    ImGui::SliderInt("Run duration, ms", &duration_ms, 50, 2000);
+    ImGui::Combo("Critical section", &critical_section, critical_section_names.data(), static_cast<int>(critical_section_names.size()));
+
+    if (benchmark_suite.DrawRunButton("Run suite", "Benchmark is already running"))
+    {
+        const auto steps = ThreadSteps(max_threads_count);
+
+        benchmark_suite.Run(static_cast<int>(steps.size() * lock_runners.size()),
+                [steps, duration = duration_ms, section = static_cast<CriticalSection>(critical_section)]()
+                {
+                    std::vector<RunResult> entries;
+
+                    for (const auto& [name, runner] : lock_runners)
+                    {
+                        for (const auto threads : steps)
+                        {
+                            RunConfig config;
+
+                            config.threads = threads;
+                            config.section = section;
+                            config.duration_ms = duration;
+
+                            entries.push_back(runner(name, config));
+                            benchmark_suite.Advance();
+                        }
+                    }
+
+                    results = std::move(entries);
+                });
+    }
+
+    if (benchmark_suite.IsRunning())
+    {
+        benchmark_suite.DrawProgress();
+    }
+    else if (!results.empty())
+    {
+        DrawScalingPlot();
+
+        if (ImGui::BeginTable("Lock results", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+        {
+            ImGui::TableSetupColumn("Lock");
+            ImGui::TableSetupColumn("Threads");
+            ImGui::TableSetupColumn("Mops/s");
+            ImGui::TableSetupColumn("Fairness");
+            ImGui::TableSetupColumn("p99 acquire");
+            ImGui::TableSetupColumn("Acquisitions per thread");
+            ImGui::TableHeadersRow();
+
+            for (const auto& result : results)
+            {
+                ImGui::TableNextRow();
+
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", result.lock_name);
+
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%d", result.threads);
+
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.2f", result.ops_per_second / 1e6);
+
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%.3f", result.fairness);
+
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%llu ns", static_cast<unsigned long long>(result.p99_acquire_ns));
+
+                ImGui::TableSetColumnIndex(5);
+                const auto [min, max] = std::minmax_element(result.acquisitions.begin(), result.acquisitions.end());
+                ImGui::Text("min %llu / max %llu", static_cast<unsigned long long>(*min), static_cast<unsigned long long>(*max));
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
+    ImGui::End();
+}
@@ -0,0 +1,100 @@
+#include <Benchmarks.hpp>
+
+#include <wrappers/include/pool.hpp>
+#include <wrappers/include/winthread.hpp>
+
+#include <chrono>
+
+using namespace retro;
+
+namespace
+{
+    using clock_type = core::Clock;
+
+    int samples_count = 1000;
+
+    benchmark::LatencySummary pool_latency;
+    benchmark::LatencySummary thread_latency;
+
+    double ToMicroseconds(clock_type::duration duration)
+    {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    // Time from handing the job over to the job's first instruction. Jobs are submitted one at a time, so every
+    // pool sample also pays for waking up a parked worker, just like a button press in a lab would
+    std::vector<double> MeasurePoolSubmit(int samples)
+    {
+        auto& workers = thread::pool::shared();
+        std::vector<double> latencies;
+        latencies.reserve(samples);
+
+        for (int i = 0; i < samples; i++)
+        {
+            clock_type::time_point started;
+
+            const auto submitted = clock_type::now();
+            workers.submit([&started]() { started = clock_type::now(); }).wait();
+
+            latencies.push_back(ToMicroseconds(started - submitted));
+        }
+
+        return latencies;
+    }
+
+    std::vector<double> MeasureThreadRun(int samples)
+    {
+        std::vector<double> latencies;
+        latencies.reserve(samples);
+
+        clock_type::time_point started;
+        thread::winthread worker([&started]() { started = clock_type::now(); });
+
+        for (int i = 0; i < samples; i++)
+        {
+            const auto submitted = clock_type::now();
+            worker.run();
+            worker.join();
+
+            latencies.push_back(ToMicroseconds(started - submitted));
+        }
+
+        return latencies;
+    }
+}
+
+void benchmark::RenderPoolBenchmarkWindow()
+{
+    static thread::winthread benchmark_thread;
+
+    ImGui::Begin("Thread pool");
+
+    ImGui::Text("Pool workers: %zu", thread::pool::shared().size());
+    ImGui::SliderInt("Samples", &samples_count, 100, 10000);
+
+    if (DrawButtonConditionally("Measure submit-to-start latency", benchmark_thread.is_running(), "Benchmark is already running"))
+    {
+        benchmark_thread.run(
+                [samples = samples_count]()
+                {
+                    core::FramePacer::JobScope job;
+
+                    pool_latency = Summarize(MeasurePoolSubmit(samples));
+                    thread_latency = Summarize(MeasureThreadRun(samples));
+                });
+    }
+
+    if (benchmark_thread.is_running())
+    {
+        ImGui::Text("Measuring...");
+    }
+    else if (pool_latency.samples > 0 && BeginLatencyTable("Submit latency"))
+    {
+        DrawLatencyRow("pool::submit", pool_latency);
+        DrawLatencyRow("winthread::run", thread_latency);
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
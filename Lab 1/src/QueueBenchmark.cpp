@@ -0,0 +1,227 @@
+#include <Benchmarks.hpp>
+
+#include <wrappers/include/cpu.hpp>
+#include <wrappers/include/winthread.hpp>
+#include <wrappers/include/mpmc_queue.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <numeric>
+
+using namespace retro;
+
+namespace
+{
+    using clock_type = core::Clock;
+
+    struct QueueResult
+    {
+        std::string scenario;
+
+        int producers = 0;
+        int consumers = 0;
+
+        double items_per_second = 0.0;
+        bool checksum_ok = false;
+    };
+
+    int threads_count = 4;
+    int items_per_producer = 1000000;
+    int batch_size = 1;
+    int queue_capacity = 1024;
+
+    std::vector<QueueResult> results;
+
+    // Producers push their share (blocking when the ring is full), consumers drain until every item has been
+    // seen. The sum of all popped values is checked, so a lost or duplicated item shows up in the table
+    QueueResult MeasureQueue(int producers, int consumers, int items, int batch, int capacity)
+    {
+        concurrent::mpmc_queue<uint64_t> queue(capacity);
+
+        const auto total = static_cast<uint64_t>(producers) * static_cast<uint64_t>(items);
+
+        std::atomic<int> ready { 0 };
+        std::atomic<bool> go { false };
+        std::atomic<uint64_t> consumed { 0 };
+        std::atomic<uint64_t> checksum { 0 };
+
+        std::vector<thread::winthread> workers;
+        workers.reserve(producers + consumers);
+
+        const auto wait_for_start = [&]()
+        {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire))
+            {
+                sync::cpu_relax();
+            }
+        };
+
+        for (int p = 0; p < producers; p++)
+        {
+            workers.emplace_back(
+                    [&]()
+                    {
+                        std::vector<uint64_t> buffer(batch);
+                        wait_for_start();
+
+                        for (int i = 0; i < items; i += batch)
+                        {
+                            const auto count = std::min(batch, items - i);
+
+                            if (count == 1)
+                            {
+                                queue.push(static_cast<uint64_t>(i));
+                            }
+                            else
+                            {
+                                std::iota(buffer.begin(), buffer.begin() + count, static_cast<uint64_t>(i));
+                                queue.push_bulk(buffer.begin(), buffer.begin() + count);
+                            }
+                        }
+                    });
+        }
+
+        for (int c = 0; c < consumers; c++)
+        {
+            workers.emplace_back(
+                    [&]()
+                    {
+                        std::vector<uint64_t> buffer(batch);
+                        uint64_t local_sum = 0;
+                        sync::backoff backoff;
+
+                        wait_for_start();
+
+                        while (consumed.load(std::memory_order_relaxed) < total)
+                        {
+                            size_t popped = 0;
+
+                            if (batch == 1)
+                            {
+                                if (auto item = queue.try_pop())
+                                {
+                                    local_sum += *item;
+                                    popped = 1;
+                                }
+                            }
+                            else
+                            {
+                                popped = queue.try_pop_bulk(buffer.begin(), buffer.size());
+                                local_sum = std::accumulate(buffer.begin(), buffer.begin() + static_cast<ptrdiff_t>(popped), local_sum);
+                            }
+
+                            if (popped > 0)
+                            {
+                                consumed.fetch_add(popped, std::memory_order_relaxed);
+                                backoff.reset();
+                            }
+                            else
+                            {
+                                backoff.pause();
+                            }
+                        }
+
+                        checksum.fetch_add(local_sum);
+                    });
+        }
+
+        for (auto& worker : workers)
+        {
+            worker.run();
+        }
+
+        while (ready.load() < producers + consumers)
+        {
+            std::this_thread::yield();
+        }
+
+        const auto start = clock_type::now();
+        go.store(true, std::memory_order_release);
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        const auto elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+
+        QueueResult result;
+
+        result.producers = producers;
+        result.consumers = consumers;
+        result.items_per_second = static_cast<double>(total) / elapsed;
+        result.checksum_ok = checksum.load() == static_cast<uint64_t>(producers) * (static_cast<uint64_t>(items) * (items - 1) / 2);
+
+        return result;
+    }
+}
+
+void benchmark::RenderQueueBenchmarkWindow()
+{
+    static thread::winthread benchmark_thread;
+
+    ImGui::Begin("MPMC queue");
+
+    ImGui::SliderInt("Threads (N)", &threads_count, 2, static_cast<int>(std::thread::hardware_concurrency()) * 2);
+    ImGui::SliderInt("Items per producer", &items_per_producer, 10000, 10000000);
+    ImGui::SliderInt("Batch size", &batch_size, 1, 256);
+    ImGui::SliderInt("Queue capacity", &queue_capacity, 2, 65536);
+
+    if (DrawButtonConditionally("Measure", benchmark_thread.is_running(), "Benchmark is already running"))
+    {
+        benchmark_thread.run(
+                [n = threads_count, items = items_per_producer, batch = batch_size, capacity = queue_capacity]()
+                {
+                    core::FramePacer::JobScope job;
+
+                    std::vector<QueueResult> entries;
+
+                    entries.push_back(MeasureQueue(1, 1, items, batch, capacity));
+                    entries.back().scenario = "1P1C";
+
+                    entries.push_back(MeasureQueue(n, 1, items, batch, capacity));
+                    entries.back().scenario = "NP1C";
+
+                    entries.push_back(MeasureQueue(n, n, items, batch, capacity));
+                    entries.back().scenario = "NPNC";
+
+                    results = std::move(entries);
+                });
+    }
+
+    if (benchmark_thread.is_running())
+    {
+        ImGui::Text("Measuring...");
+    }
+    else if (!results.empty() && ImGui::BeginTable("Queue throughput", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+    {
+        ImGui::TableSetupColumn("Scenario");
+        ImGui::TableSetupColumn("Producers / consumers");
+        ImGui::TableSetupColumn("Mitems/s");
+        ImGui::TableSetupColumn("Checksum");
+        ImGui::TableHeadersRow();
+
+        for (const auto& result : results)
+        {
+            ImGui::TableNextRow();
+
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", result.scenario.c_str());
+
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%d / %d", result.producers, result.consumers);
+
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.2f", result.items_per_second / 1e6);
+
+            ImGui::TableSetColumnIndex(3);
+            ImGui::TextColored(result.checksum_ok ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "%s", result.checksum_ok ? "OK" : "MISMATCH");
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
@@ -0,0 +1,331 @@
+#include <Benchmarks.hpp>
+
+#include <wrappers/include/reclaim.hpp>
+#include <wrappers/include/sharded.hpp>
+#include <wrappers/include/winthread.hpp>
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace retro;
+
+namespace
+{
+    using clock_type = core::Clock;
+
+    // Created and destroyed objects over all threads. Every snapshot bumps one of them, a shared atomic
+    // would be the hottest line of the whole benchmark
+    concurrent::sharded_counter<uint64_t> snapshots_created;
+    concurrent::sharded_counter<uint64_t> snapshots_destroyed;
+
+    // What a publisher hands out, e.g. a finished simulation grid. The destructor poisons the check word,
+    // so a reader that got hold of a freed snapshot sees it torn as long as the memory was not reused yet
+    struct Snapshot
+    {
+        explicit Snapshot(uint64_t snapshot_version)
+            : version(snapshot_version)
+            , check(~snapshot_version)
+        {
+            payload.fill(snapshot_version);
+            snapshots_created.increment();
+        }
+
+        ~Snapshot()
+        {
+            check = version;
+            snapshots_destroyed.increment();
+        }
+
+        [[nodiscard]] bool IsIntact() const
+        {
+            return check == ~version && payload.front() == version && payload.back() == version;
+        }
+
+        uint64_t version;
+        uint64_t check;
+
+        std::array<uint64_t, 14> payload { };
+    };
+
+    struct StressConfig
+    {
+        int readers = 4;
+        int writers = 1;
+        int duration_ms = 500;
+    };
+
+    struct StressResult
+    {
+        const char * scheme = "";
+
+        double reads_per_second = 0.0;
+        double publishes_per_second = 0.0;
+
+        uint64_t torn_reads = 0;
+
+        // Retired snapshots waiting to be freed, the highest count a writer saw
+        size_t peak_pending = 0;
+
+        // Snapshots never freed once the scheme was torn down, anything but 0 is a leak
+        int64_t leaked = 0;
+    };
+
+    StressConfig config;
+
+    benchmark::BenchmarkSuite benchmark_suite;
+
+    std::vector<StressResult> results;
+
+    // Readers load the current snapshot and validate it for the whole duration, writers replace it as fast
+    // as they can and hand the old one to the scheme. Read returns whether the snapshot was intact, publish
+    // returns the scheme's pending count
+    template<typename Read, typename Publish>
+    StressResult RunStress(const char * scheme, const StressConfig& settings, Read&& read, Publish&& publish)
+    {
+        struct alignas(sync::cache_line_size) ThreadCounts
+        {
+            uint64_t operations = 0;
+            uint64_t torn = 0;
+            size_t peak_pending = 0;
+        };
+
+        std::vector<ThreadCounts> counts(settings.readers + settings.writers);
+
+        std::atomic<bool> stop { false };
+        std::vector<thread::winthread> workers;
+
+        for (int i = 0; i < settings.readers + settings.writers; i++)
+        {
+            const bool is_reader = i < settings.readers;
+
+            workers.emplace_back(
+                    [&, is_reader, index = static_cast<size_t>(i)]()
+                    {
+                        auto& own = counts.at(index);
+
+                        while (!stop.load(std::memory_order_relaxed))
+                        {
+                            if (is_reader)
+                            {
+                                own.torn += read() ? 0 : 1;
+                            }
+                            else
+                            {
+                                own.peak_pending = std::max(own.peak_pending, publish());
+                            }
+
+                            own.operations++;
+                        }
+                    });
+            workers.back().run();
+        }
+
+        const auto start = clock_type::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(settings.duration_ms));
+        stop.store(true);
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        const auto elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+
+        StressResult result;
+        result.scheme = scheme;
+
+        for (size_t i = 0; i < counts.size(); i++)
+        {
+            const auto& entry = counts.at(i);
+
+            if (i < static_cast<size_t>(settings.readers))
+            {
+                result.reads_per_second += static_cast<double>(entry.operations) / elapsed;
+                result.torn_reads += entry.torn;
+            }
+            else
+            {
+                result.publishes_per_second += static_cast<double>(entry.operations) / elapsed;
+                result.peak_pending = std::max(result.peak_pending, entry.peak_pending);
+            }
+        }
+
+        return result;
+    }
+
+    StressResult MeasureEpochs(const StressConfig& settings)
+    {
+        std::atomic<uint64_t> version { 0 };
+
+        concurrent::epoch_domain domain;
+        std::atomic<Snapshot *> current { new Snapshot(0) };
+
+        auto result = RunStress("Epoch based", settings,
+                                [&]()
+                                {
+                                    concurrent::epoch_guard guard(domain);
+                                    return current.load(std::memory_order_acquire)->IsIntact();
+                                },
+                                [&]()
+                                {
+                                    auto * pOld = current.exchange(new Snapshot(++version), std::memory_order_acq_rel);
+                                    domain.retire(pOld);
+
+                                    return domain.pending();
+                                });
+
+        delete current.load();
+        return result;
+    }
+
+    StressResult MeasureHazardPointers(const StressConfig& settings)
+    {
+        std::atomic<uint64_t> version { 0 };
+
+        concurrent::hazard_domain domain;
+        std::atomic<Snapshot *> current { new Snapshot(0) };
+
+        auto result = RunStress("Hazard pointers", settings,
+                                [&]()
+                                {
+                                    concurrent::hazard_pointer hazard(domain);
+                                    return hazard.protect(current)->IsIntact();
+                                },
+                                [&]()
+                                {
+                                    auto * pOld = current.exchange(new Snapshot(++version), std::memory_order_acq_rel);
+                                    domain.retire(pOld);
+
+                                    return domain.pending();
+                                });
+
+        delete current.load();
+        return result;
+    }
+
+    // What the labs do today: a lock around a shared_ptr, readers copy it and hold their own reference
+    StressResult MeasureMutexSharedPtr(const StressConfig& settings)
+    {
+        std::atomic<uint64_t> version { 0 };
+
+        std::mutex current_sync;
+        std::shared_ptr<Snapshot> current = std::make_shared<Snapshot>(0);
+
+        return RunStress("Mutex + shared_ptr", settings,
+                         [&]()
+                         {
+                             std::shared_ptr<Snapshot> local;
+
+                             {
+                                 std::lock_guard lock(current_sync);
+                                 local = current;
+                             }
+
+                             return local->IsIntact();
+                         },
+                         [&]()
+                         {
+                             auto next = std::make_shared<Snapshot>(++version);
+
+                             std::lock_guard lock(current_sync);
+                             current = std::move(next);
+
+                             return size_t { 0 };
+                         });
+    }
+
+    using StressRunner = StressResult(*)(const StressConfig&);
+
+    const std::array<StressRunner, 3> stress_runners =
+    {
+            &MeasureEpochs,
+            &MeasureHazardPointers,
+            &MeasureMutexSharedPtr
+    };
+}
+
+void benchmark::RenderReclaimBenchmarkWindow()
+{
+    ImGui::Begin("Memory reclamation");
+
+    ImGui::SliderInt("Readers", &config.readers, 1, 32);
+    ImGui::SliderInt("Writers", &config.writers, 1, 8);
+    ImGui::SliderInt("Duration per scheme, ms", &config.duration_ms, 100, 5000);
+
+    if (benchmark_suite.DrawRunButton("Run stress test", "Stress test is already running"))
+    {
+        benchmark_suite.Run(static_cast<int>(stress_runners.size()),
+                [settings = config]()
+                {
+                    std::vector<StressResult> entries;
+
+                    for (const auto runner : stress_runners)
+                    {
+                        const auto created_before = snapshots_created.load();
+                        const auto destroyed_before = snapshots_destroyed.load();
+
+                        // The scheme is gone once the runner returns, whatever it still held is freed by then
+                        auto result = runner(settings);
+
+                        const auto created = snapshots_created.load() - created_before;
+                        const auto destroyed = snapshots_destroyed.load() - destroyed_before;
+
+                        result.leaked = static_cast<int64_t>(created) - static_cast<int64_t>(destroyed);
+                        entries.push_back(result);
+
+                        benchmark_suite.Advance();
+                    }
+
+                    results = std::move(entries);
+                });
+    }
+
+    if (benchmark_suite.IsRunning())
+    {
+        benchmark_suite.DrawProgress();
+    }
+    else if (!results.empty() && ImGui::BeginTable("Reclamation results", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+    {
+        ImGui::TableSetupColumn("Scheme");
+        ImGui::TableSetupColumn("Reads, M/s");
+        ImGui::TableSetupColumn("Publishes, K/s");
+        ImGui::TableSetupColumn("Peak pending");
+        ImGui::TableSetupColumn("Torn reads");
+        ImGui::TableSetupColumn("Leaked");
+        ImGui::TableHeadersRow();
+
+        for (const auto& result : results)
+        {
+            ImGui::TableNextRow();
+
+            ImGui::TableSetColumnIndex(0);
+            ImGui::Text("%s", result.scheme);
+
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.2f", result.reads_per_second / 1e6);
+
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.1f", result.publishes_per_second / 1e3);
+
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%zu", result.peak_pending);
+
+            // A torn read is a snapshot freed under a reader, a leak one that was never freed at all
+            const bool is_broken = result.torn_reads != 0 || result.leaked != 0;
+
+            ImGui::TableSetColumnIndex(4);
+            ImGui::TextColored(is_broken ? ImVec4(1.0f, 0.0f, 0.0f, 1.0f) : ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%llu", static_cast<unsigned long long>(result.torn_reads));
+
+            ImGui::TableSetColumnIndex(5);
+            ImGui::TextColored(is_broken ? ImVec4(1.0f, 0.0f, 0.0f, 1.0f) : ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%lld", static_cast<long long>(result.leaked));
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
@@ -1,10 +1,23 @@
 #include <ImGUILayer.hpp>
 #include <core/include/Application.hpp>
 
+#if defined(RETRO_COMM)
+# include <Benchmarks.hpp>
+# include <comm/include/comm.hpp>
+#endif
+
 using namespace retro;
 
 int SDL_main(int argc, char** argv)
 {
+#if defined(RETRO_COMM)
+    // The collectives benchmark starts this executable again as its worker ranks, those never open a window
+    if (auto world = comm::attach(argc, argv))
+    {
+        return benchmark::RunCollectivesWorker(*world);
+    }
+#endif
+
     core::Application app;
     app.EmplaceLayer<ImGUILayer>("ImGUILayer");
 
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Matrix.hpp>
+#include <core/include/HeadlessLayer.hpp>
+
+namespace retro
+{
+    // The GEMM kernel without the window, started with --headless. Takes --rows, --inner, --cols and
+    // --threads; the operands are randomized once, every iteration multiplies them again
+    class HeadlessMultiplicationLayer
+        : public core::HeadlessLayer
+    {
+    public:
+
+        explicit HeadlessMultiplicationLayer(core::HeadlessOptions options);
+
+        void OnAttach() override;
+
+    protected:
+
+        bool RunIteration(uint64_t index) override;
+
+        void Report(std::ostream& out) override;
+
+    private:
+
+        matrix::MatrixType m_a;
+        matrix::MatrixType m_b;
+        matrix::MatrixType m_product;
+
+        double m_best_seconds { 0.0 };
+
+    };
+}
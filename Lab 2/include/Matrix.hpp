@@ -0,0 +1,16 @@
+#pragma once
+
+#include <vector>
+
+namespace retro::matrix
+{
+    using MatrixType = std::vector<std::vector<double>>;
+
+    // Values in [-100, 100]. Rows are filled on the pool with the priority of the calling job, so a randomize
+    // started as an interactive job stays interactive all the way down
+    MatrixType MakeRandomMatrix(int rows, int cols);
+
+    // Row-parallel GEMM on the calling thread's OpenMP team, what the pipeline window and the headless runner
+    // time
+    MatrixType MultiplyParallel(const MatrixType& a, const MatrixType& b);
+}
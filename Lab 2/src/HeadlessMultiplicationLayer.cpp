@@ -0,0 +1,66 @@
+#include <HeadlessMultiplicationLayer.hpp>
+#include <core/include/Clock.hpp>
+
+#include <ostream>
+#include <utility>
+#include <algorithm>
+
+#include <omp.h>
+
+using namespace retro;
+
+HeadlessMultiplicationLayer::HeadlessMultiplicationLayer(core::HeadlessOptions options)
+    : HeadlessLayer("Multiplication", std::move(options))
+{
+}
+
+void HeadlessMultiplicationLayer::OnAttach()
+{
+    if (const auto threads = m_options.GetInt("threads", 0); threads > 0)
+    {
+        omp_set_num_threads(static_cast<int>(threads));
+    }
+
+    const auto rows = static_cast<int>(m_options.GetInt("rows", 512));
+    const auto inner = static_cast<int>(m_options.GetInt("inner", 512));
+    const auto cols = static_cast<int>(m_options.GetInt("cols", 512));
+
+    m_a = matrix::MakeRandomMatrix(rows, inner);
+    m_b = matrix::MakeRandomMatrix(inner, cols);
+}
+
+bool HeadlessMultiplicationLayer::RunIteration(uint64_t index)
+{
+    const auto start = core::Clock::Seconds();
+
+    m_product = matrix::MultiplyParallel(m_a, m_b);
+
+    const auto seconds = core::Clock::Seconds() - start;
+    m_best_seconds = index == 0 ? seconds : std::min(m_best_seconds, seconds);
+
+    return true;
+}
+
+void HeadlessMultiplicationLayer::Report(std::ostream& out)
+{
+    const auto rows = m_a.size();
+    const auto inner = m_b.size();
+    const auto cols = m_b.empty() ? 0 : m_b.at(0).size();
+
+    // A multiply and an add per inner step of every cell
+    const auto flops = 2.0 * static_cast<double>(rows) * static_cast<double>(inner) * static_cast<double>(cols);
+
+    double checksum = 0.0;
+    for (const auto& row : m_product)
+    {
+        for (const auto value : row)
+        {
+            checksum += value;
+        }
+    }
+
+    out << "  size: " << rows << " x " << inner << " x " << cols << ", threads " << omp_get_max_threads() << '\n';
+    out << "  best iteration, ms: " << m_best_seconds * 1000.0 << '\n';
+    out << "  best GFLOP/s: " << (m_best_seconds > 0.0 ? flops / m_best_seconds / 1e9 : 0.0) << '\n';
+    out << "  checksum: " << checksum << '\n';
+}
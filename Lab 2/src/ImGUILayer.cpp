@@ -1,11 +1,23 @@
 #include <ImGUILayer.hpp>
+#include <Matrix.hpp>
 #include <core/include/Event.hpp>
 #include <core/include/Random.hpp>
+#include <core/include/Clock.hpp>
+#include <core/include/FramePacer.hpp>
+#include <wrappers/include/future.hpp>
+#include <wrappers/include/seqlock.hpp>
+#include <wrappers/include/parallel.hpp>
+#include <wrappers/include/progress.hpp>
+#include <ui/include/PinningControls.hpp>
+#include <ui/include/ProgressBar.hpp>
+#include <ui/include/TracePanel.hpp>
+#include <ui/include/FramePacingPanel.hpp>
 
 #include <iostream>
 #include <algorithm>
 
 #include <thread>
+#include <memory>
 #include <imgui.h>
 
 #include <backends/imgui_impl_sdl2.h>
@@ -14,10 +26,20 @@
 #include <omp.h>
 
 using namespace retro;
+using namespace retro::matrix;
 
 namespace
 {
-    using MatrixType = std::vector<std::vector<double>>;
+    // Published by a test thread as its passes finish, the window shows the latest one every frame. The totals
+    // are only filled in by the row sum test, the non-parallel one growing row by row
+    struct TestReport
+    {
+        double parallel_seconds = 0.0;
+        double non_parallel_seconds = 0.0;
+
+        double total_parallel = 0.0;
+        double total_non_parallel = 0.0;
+    };
 
     void DisplayBoolColored(const char* label, bool value)
     {
@@ -28,17 +50,24 @@ namespace
         ImGui::PopStyleColor();
     }
 
-    void RandomizeMatrix(MatrixType& matrix)
+    // Randomizing runs as an interactive pool job: it jumps ahead of the chunks of a test running in another
+    // window instead of stalling the frame. The UI thread swaps the result in once it is ready
+    void RandomizeMatrixAsync(thread::future<MatrixType>& pending, int rows, int cols)
+    {
+        pending = thread::async(thread::pool::shared(), thread::job_priority::interactive,
+                [rows, cols]()
+                {
+                    core::FramePacer::JobScope job;
+                    return MakeRandomMatrix(rows, cols);
+                });
+    }
+
+    // Not while the window's test runs, it reads the matrix
+    void CollectRandomMatrix(thread::future<MatrixType>& pending, MatrixType& matrix, const thread::winthread& test_thread)
     {
-        retro::core::ScopeTimer _("Matrix randomize");
-        int i, j;
-#pragma omp parallel for private(i, j) shared(matrix)
-        for (i = 0; i < matrix.size(); i++)
+        if (pending.is_ready() && !test_thread.is_running())
         {
-            for (j = 0; j < matrix.at(i).size(); j++)
-            {
-                matrix.at(i).at(j) = core::random::generate<MatrixType::value_type::value_type>(-100, 100);
-            }
+            matrix = pending.get();
         }
     }
 
@@ -89,6 +118,213 @@ namespace
         }
     }
 
+    // Selected in the "Loop backend" / "Schedule" controls, shared by the multiplication and row sum tests
+    int backend = 0;
+    int schedule = 0;
+    int chunk = 0;
+
+    constexpr std::array<const char *, 2> backend_names = { "OpenMP", "Thread pool" };
+
+    struct LoopSettings
+    {
+        bool use_pool = false;
+        parallel::schedule kind = parallel::schedule::static_chunks;
+        size_t chunk = 0;
+
+        // Only the pool backend has priorities, an OpenMP team takes every core it was given
+        thread::job_priority level = thread::job_priority::normal;
+    };
+
+    // Read once when a test starts, the UI may change the controls while it runs
+    LoopSettings GetLoopSettings(thread::job_priority level)
+    {
+        return { backend == 1, static_cast<parallel::schedule>(schedule), static_cast<size_t>(std::max(chunk, 0)), level };
+    }
+
+    void DrawLoopControls()
+    {
+        ImGui::Combo("Loop backend", &backend, backend_names.data(), static_cast<int>(backend_names.size()));
+        ImGui::Combo("Schedule", &schedule, parallel::schedule_names.data(), static_cast<int>(parallel::schedule_names.size()));
+
+        if (backend == 0 && static_cast<parallel::schedule>(schedule) == parallel::schedule::stealing && ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("OpenMP has no work stealing schedule, dynamic is used instead");
+        }
+
+        ImGui::InputInt("Chunk size (0 - schedule default)", &chunk);
+        chunk = std::max(chunk, 0);
+
+        // Workers a background loop may occupy, the others stay free for interactive and normal jobs
+        auto& pool = thread::pool::shared();
+
+        int background_quota = static_cast<int>(pool.get_quota(thread::job_priority::background));
+        if (ImGui::SliderInt("Background workers quota", &background_quota, 1, static_cast<int>(pool.size())))
+        {
+            pool.set_quota(thread::job_priority::background, static_cast<size_t>(background_quota));
+        }
+    }
+
+    // Whichever backend runs the loop gets the pinning
+    void PinLoopBackend(const LoopSettings& settings, thread::pin_policy policy)
+    {
+        if (settings.use_pool)
+        {
+            thread::pool::shared().pin(policy);
+        }
+        else
+        {
+            ui::PinOpenMPTeam(policy);
+        }
+    }
+
+    // Same loop with the schedule given as a clause. OpenMP 2.0 has no omp_set_schedule, so every schedule
+    // needs its own loop. Busy time is measured the way parallel::for_each does it: from entering the loop to
+    // running out of iterations, hence the nowait
+    template<typename Body>
+    parallel::loop_stats ParallelForOpenMP(int count, const LoopSettings& settings, Body& body)
+    {
+        parallel::loop_stats stats;
+        stats.participants.resize(omp_get_max_threads());
+
+        const auto omp_chunk = static_cast<int>(std::max<size_t>(settings.chunk, 1));
+        const auto start_time = core::Clock::Seconds();
+
+        int team_size = 1;
+        int i;
+
+#pragma omp parallel private(i) shared(stats, team_size)
+        {
+            const auto thread_start_time = core::Clock::Seconds();
+            size_t iterations = 0;
+
+            if (omp_get_thread_num() == 0)
+            {
+                team_size = omp_get_num_threads();
+            }
+
+            switch (settings.kind)
+            {
+                case parallel::schedule::static_chunks:
+                    if (settings.chunk == 0)
+                    {
+#pragma omp for schedule(static) nowait
+                        for (i = 0; i < count; i++)
+                        {
+                            body(static_cast<size_t>(i));
+                            iterations++;
+                        }
+                    }
+                    else
+                    {
+#pragma omp for schedule(static, omp_chunk) nowait
+                        for (i = 0; i < count; i++)
+                        {
+                            body(static_cast<size_t>(i));
+                            iterations++;
+                        }
+                    }
+                    break;
+
+                case parallel::schedule::guided:
+#pragma omp for schedule(guided, omp_chunk) nowait
+                    for (i = 0; i < count; i++)
+                    {
+                        body(static_cast<size_t>(i));
+                        iterations++;
+                    }
+                    break;
+
+                default:
+#pragma omp for schedule(dynamic, omp_chunk) nowait
+                    for (i = 0; i < count; i++)
+                    {
+                        body(static_cast<size_t>(i));
+                        iterations++;
+                    }
+                    break;
+            }
+
+            auto& own = stats.participants.at(omp_get_thread_num());
+            own.busy_seconds = core::Clock::Seconds() - thread_start_time;
+            own.iterations = iterations;
+        }
+
+        stats.participants.resize(team_size);
+        stats.wall_seconds = core::Clock::Seconds() - start_time;
+
+        return stats;
+    }
+
+    // Runs body(i) for every row on the backend and schedule the test started with, the pool getting as many
+    // participants as the OpenMP team would have, at most the quota of the test's priority
+    template<typename Body>
+    parallel::loop_stats ParallelRows(int count, const LoopSettings& settings, Body&& body)
+    {
+        if (settings.use_pool)
+        {
+            return parallel::for_each(0, static_cast<size_t>(count), body, { settings.kind, settings.chunk, static_cast<size_t>(omp_get_max_threads()), settings.level });
+        }
+
+        return ParallelForOpenMP(count, settings, body);
+    }
+
+    void DrawLoopStats(const parallel::loop_stats& stats)
+    {
+        if (stats.participants.empty())
+        {
+            return;
+        }
+
+        std::vector<float> busy_ms;
+        busy_ms.reserve(stats.participants.size());
+
+        for (const auto& participant : stats.participants)
+        {
+            busy_ms.push_back(static_cast<float>(participant.busy_seconds * 1000.0));
+        }
+
+        ImGui::Text("Load imbalance (longest / mean busy time) %.2f", stats.imbalance());
+        ImGui::PlotHistogram("Busy time per thread, ms", busy_ms.data(), static_cast<int>(busy_ms.size()), 0, nullptr, 0.0F, FLT_MAX, ImVec2(0, 80));
+
+        if (ImGui::BeginTable("Loop participants", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+        {
+            ImGui::TableSetupColumn("Thread");
+            ImGui::TableSetupColumn("Busy, ms");
+            ImGui::TableSetupColumn("Iterations");
+            ImGui::TableSetupColumn("Chunks");
+            ImGui::TableHeadersRow();
+
+            for (size_t i = 0; i < stats.participants.size(); i++)
+            {
+                const auto& participant = stats.participants.at(i);
+
+                ImGui::TableNextRow();
+
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%zu", i);
+
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%.3f", participant.busy_seconds * 1000.0);
+
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%zu", participant.iterations);
+
+                // OpenMP does not tell how it chunked the loop
+                ImGui::TableSetColumnIndex(3);
+                if (participant.chunks > 0)
+                {
+                    ImGui::Text("%zu", participant.chunks);
+                }
+                else
+                {
+                    ImGui::Text("-");
+                }
+            }
+
+            ImGui::EndTable();
+        }
+    }
+
     bool DrawButtonConditionally(const std::string& label, bool disabled, const std::string& hint)
     {
         if (disabled)
@@ -115,6 +351,10 @@ void ImGUILayer::OnAttach()
 {
     omp_set_nested(1);
 
+    // A background benchmark always leaves one worker to interactive and normal jobs
+    auto& pool = thread::pool::shared();
+    pool.set_quota(thread::job_priority::background, pool.size() - 1);
+
     m_window = std::make_unique<graphics::Window>("Lab 2 by Retro52", 1280, 720);
 
     // Setup Dear ImGui context
@@ -163,10 +403,12 @@ void ImGUILayer::OnAttach()
 bool ImGUILayer::OnUpdate(ts delta)
 {
     const auto& io = ImGui::GetIO();
-    for (const auto& event : m_window->PollEvents())
-    {
-        core::EventsPoll::AddEvent(event);
-    }
+    // Sleeps until input, a finished job or the next low rate refresh, see core::FramePacer
+    auto& pacer = core::FramePacer::Get();
+    const auto events = m_window->PollEvents(pacer.GetWaitTimeout());
+    pacer.BeginFrame(events);
+
+    core::EventBus::Get().PostAll(events);
 
     ImGui_ImplDX11_NewFrame();
     ImGui_ImplSDL2_NewFrame();
@@ -199,6 +441,7 @@ bool ImGUILayer::OnUpdate(ts delta)
     }
 
     m_window->GetDirectXSwapChain()->Present(1, 0);
+    pacer.EndFrame();
 
     return true;
 }
@@ -233,19 +476,23 @@ void RenderMultiplicationWindow()
     static int cols_a = 0;
     static int cols_b = 0;
 
-    static double execution_time_parallel = 0.0;
-    static double execution_time_non_parallel = 0.0;
+    static concurrent::seqlock<TestReport> test_report;
+
+    static parallel::loop_stats loop_stats_parallel;
 
     double tick;
     double end_time;
     double start_time;
 
     static bool can_multiply = false;
-    static bool can_terminate_test = false; // we better not terminate the test till pragma omp is running, trust me, I`ve tried
 
     static retro::thread::winthread test_thread;
+    static retro::thread::progress test_progress;
 
-    start_time = omp_get_wtime();
+    static thread::future<MatrixType> pending_a;
+    static thread::future<MatrixType> pending_b;
+
+    start_time = core::Clock::Seconds();
     ImGui::Begin("Matrix multiplication");
 
     static int threads = 4;
@@ -255,27 +502,30 @@ void RenderMultiplicationWindow()
     {
         omp_set_num_threads(threads);
     }
+    ui::DrawPinningCombo();
+    DrawLoopControls();
 
     // Input for Matrix A size
     ImGui::InputInt("Matrix A Rows", &rows_a);
     ImGui::InputInt("Matrix A Columns", &cols_a);
 
-    if (DrawButtonConditionally("Randomize Matrix A", test_thread.is_running(), "Can`t randomize a matrix while thread test is running"))
+    if (DrawButtonConditionally("Randomize Matrix A", test_thread.is_running() || pending_a.is_valid(), "Can`t randomize a matrix while thread test is running"))
     {
-        matrix_a = MatrixType(rows_a, std::vector<double>(cols_a, 0.0));
-        RandomizeMatrix(matrix_a);
+        RandomizeMatrixAsync(pending_a, rows_a, cols_a);
     }
 
     // Input for Matrix B size
     ImGui::InputInt("Matrix B Rows", &rows_b);
     ImGui::InputInt("Matrix B Columns", &cols_b);
 
-    if (DrawButtonConditionally("Randomize Matrix B", test_thread.is_running(), "Can`t randomize a matrix while thread test is running"))
+    if (DrawButtonConditionally("Randomize Matrix B", test_thread.is_running() || pending_b.is_valid(), "Can`t randomize a matrix while thread test is running"))
     {
-        matrix_b = MatrixType(rows_b, std::vector<double>(cols_b, 0.0));
-        RandomizeMatrix(matrix_b);
+        RandomizeMatrixAsync(pending_b, rows_b, cols_b);
     }
 
+    CollectRandomMatrix(pending_a, matrix_a, test_thread);
+    CollectRandomMatrix(pending_b, matrix_b, test_thread);
+
     DrawMatrix(matrix_a, "Matrix A: ");
     DrawMatrix(matrix_b, "Matrix B: ");
 
@@ -287,10 +537,15 @@ void RenderMultiplicationWindow()
     if (DrawButtonConditionally("Multiplication test", test_thread.is_running() || !can_multiply,  "Test is already running or A column count != B rows count"))
     {
         test_thread.run(
-                [=]()
+                [=, settings = GetLoopSettings(thread::job_priority::background)]()
                 {
-                    execution_time_parallel = 0.0;
-                    execution_time_non_parallel = 0.0;
+                    core::FramePacer::JobScope job;
+
+                    PinLoopBackend(settings, ui::GetPinPolicy());
+
+                    // The test thread is the only writer, it keeps its own copy and publishes it whole
+                    TestReport report;
+                    test_report.publish(report);
 
                     const auto local_rows_a = matrix_a.size();
 
@@ -300,31 +555,47 @@ void RenderMultiplicationWindow()
                     matrix_mul_result_parallel = MatrixType (local_rows_a, std::vector<double>(local_cols_b, 0.0));
                     matrix_mul_result_non_parallel = MatrixType (local_rows_a, std::vector<double>(local_cols_b, 0.0));
 
+                    // Both passes report rows, the team members poll the token once per row: cancelling costs at
+                    // most one row per thread, unlike terminate() which would kill the thread mid-region. The rows
+                    // are also where a POSIX pause() takes hold, on the test thread's own rows
+                    const auto stop_token = thread::winthread::current_stop_token();
+                    test_progress.start(2 * local_rows_a);
+
                     int i, j, k;
                     MatrixType::value_type::value_type sum;
-                    const auto parallel_start_time = omp_get_wtime();
+                    const auto parallel_start_time = core::Clock::Seconds();
 
-                    can_terminate_test = false;
-#pragma omp parallel for private(j, k, sum) shared(matrix_mul_result_parallel)
-                    for(i = 0; i < local_rows_a; i++)
-                    {
-                        for(k = 0; k < local_cols_b; k++)
-                        {
-                            sum = 0;
-                            for(j = 0; j < local_cols_a; j++)
+                    loop_stats_parallel = ParallelRows(static_cast<int>(local_rows_a), settings,
+                            [&](size_t row)
                             {
-                                sum += matrix_a.at(i).at(j) * matrix_b.at(j).at(k);
-                            }
-
-                            matrix_mul_result_parallel.at(i).at(k) = sum;
-                        }
-                    }
-                    can_terminate_test = true;
-                    execution_time_parallel = omp_get_wtime() - parallel_start_time;
-
-                    const auto non_parallel_start_time = omp_get_wtime();
-                    for(i = 0; i < local_rows_a; i++)
+                                thread::winthread::safe_point();
+
+                                if (stop_token.stop_requested())
+                                {
+                                    return;
+                                }
+
+                                for (size_t col = 0; col < local_cols_b; col++)
+                                {
+                                    MatrixType::value_type::value_type cell = 0;
+                                    for (size_t inner = 0; inner < local_cols_a; inner++)
+                                    {
+                                        cell += matrix_a.at(row).at(inner) * matrix_b.at(inner).at(col);
+                                    }
+
+                                    matrix_mul_result_parallel.at(row).at(col) = cell;
+                                }
+
+                                test_progress.advance();
+                            });
+                    report.parallel_seconds = core::Clock::Seconds() - parallel_start_time;
+                    test_report.publish(report);
+
+                    const auto non_parallel_start_time = core::Clock::Seconds();
+                    for(i = 0; i < local_rows_a && !stop_token.stop_requested(); i++)
                     {
+                        thread::winthread::safe_point();
+
                         for(k = 0; k < local_cols_b; k++)
                         {
                             sum = 0;
@@ -335,27 +606,42 @@ void RenderMultiplicationWindow()
 
                             matrix_mul_result_non_parallel.at(i).at(k) = sum;
                         }
+
+                        test_progress.advance();
                     }
-                    execution_time_non_parallel = omp_get_wtime() - non_parallel_start_time;
+                    report.non_parallel_seconds = core::Clock::Seconds() - non_parallel_start_time;
+                    test_report.publish(report);
                 });
     }
 
-    tick = omp_get_wtick();
-    end_time = omp_get_wtime();
+    tick = core::Clock::Resolution();
+    end_time = core::Clock::Seconds();
 
     DisplayBoolColored("Can multiply: ", can_multiply);
     DisplayBoolColored("Is test thread running", test_thread.is_running());
 
-    if (DrawButtonConditionally("Terminate test", !test_thread.is_running() || !can_terminate_test, "Nothing to terminate or OMP computations are not over"))
+    if (test_thread.is_running())
+    {
+        ui::DrawProgress(test_progress);
+    }
+
+    if (DrawButtonConditionally("Cancel test", !test_thread.is_running(), "Nothing to cancel"))
     {
-        test_thread.terminate();
+        test_thread.request_stop();
     }
 
+    const auto report = test_report.load();
+
     ImGui::Text("Timer precision %lf\n", tick);
-    ImGui::Text("Execution time parallel, ms %lf\n", execution_time_parallel * 1000.0);
-    ImGui::Text("Execution time non-parallel, ms %lf\n", execution_time_non_parallel * 1000.0);
+    ImGui::Text("Execution time parallel, ms %lf\n", report.parallel_seconds * 1000.0);
+    ImGui::Text("Execution time non-parallel, ms %lf\n", report.non_parallel_seconds * 1000.0);
     ImGui::Text("Render time (including operations), in ms %lf\n", (end_time - start_time) * 1000.0);
 
+    if (!test_thread.is_running())
+    {
+        DrawLoopStats(loop_stats_parallel);
+    }
+
     ImGui::End();
 }
 
@@ -370,112 +656,288 @@ void RenderMatrixRowSumCalculationWindow()
     double end_time;
     double start_time;
 
-    static double execution_time_parallel = 0.0;
-    static double execution_time_non_parallel = 0.0;
+    static concurrent::seqlock<TestReport> test_report;
 
-    static bool can_terminate_test = false;
     static retro::thread::winthread test_thread;
+    static retro::thread::progress test_progress;
 
     static MatrixType sums_result_parallel;
     static MatrixType sums_result_non_parallel;
 
-    static MatrixType::value_type::value_type total_parallel = 0.0;
-    static MatrixType::value_type::value_type total_non_parallel = 0.0;
+    static parallel::loop_stats loop_stats_parallel;
+
+    static thread::future<MatrixType> pending;
 
-    start_time = omp_get_wtime();
+    start_time = core::Clock::Seconds();
     ImGui::Begin("Row sum calculation");
 
     ImGui::InputInt("Rows count", &rows);
     ImGui::InputInt("Columns count", &cols);
-    if (DrawButtonConditionally("Randomize Matrix", test_thread.is_running(), "Can`t randomize a matrix while thread test is running"))
+    if (DrawButtonConditionally("Randomize Matrix", test_thread.is_running() || pending.is_valid(), "Can`t randomize a matrix while thread test is running"))
     {
-        matrix = MatrixType(rows, std::vector<double>(cols, 0.0));
-        RandomizeMatrix(matrix);
+        RandomizeMatrixAsync(pending, rows, cols);
     }
+    CollectRandomMatrix(pending, matrix, test_thread);
     DrawMatrix(matrix, "Generated matrix: ");
 
+    // Row i only sums from column i on, the work per row shrinks linearly: a static schedule without a chunk
+    // size leaves the first thread with most of it
+    DrawLoopControls();
+
     if (DrawButtonConditionally("Rows addition test test", test_thread.is_running(),  "Test is already running"))
     {
         test_thread.run(
-                [&]()
+                [&, settings = GetLoopSettings(thread::job_priority::normal)]()
                 {
+                    core::FramePacer::JobScope job;
+
+                    PinLoopBackend(settings, ui::GetPinPolicy());
+
                     sums_result_parallel.clear();
                     sums_result_non_parallel.clear();
 
                     sums_result_parallel.resize(matrix.size(), std::vector<double>(2, 0.0));
                     sums_result_non_parallel.resize(matrix.size(), std::vector<double>(2, 0.0));
 
-                    total_parallel = 0.0;
-                    total_non_parallel = 0.0;
+                    TestReport report;
+                    test_report.publish(report);
 
-                    execution_time_parallel = 0.0;
-                    execution_time_non_parallel = 0.0;
+                    const auto stop_token = thread::winthread::current_stop_token();
+                    test_progress.start(2 * matrix.size());
 
                     int i, j;
                     MatrixType::value_type::value_type sum;
 
-                    can_terminate_test = false;
-                    const auto parallel_start_time = omp_get_wtime();
+                    const auto parallel_start_time = core::Clock::Seconds();
 
-                    auto local_total_parallel = 0.0;
-#pragma omp parallel for shared(matrix, sums_result_parallel) private(i, j, sum) reduction (+:local_total_parallel)
-                    for (i = 0; i < matrix.size(); i++)
-                    {
-                        sum = 0;
-                        for (j = i; j < matrix.at(i).size(); j++)
-                        {
-                            sum += matrix.at(i).at(j);
-                        }
+                    loop_stats_parallel = ParallelRows(static_cast<int>(matrix.size()), settings,
+                            [&](size_t row)
+                            {
+                                thread::winthread::safe_point();
 
-                        sums_result_parallel.at(i).at(0) = i;
-                        sums_result_parallel.at(i).at(1) = sum;
+                                if (stop_token.stop_requested())
+                                {
+                                    return;
+                                }
 
-                        local_total_parallel += sum;
+                                MatrixType::value_type::value_type row_sum = 0;
+                                for (size_t col = row; col < matrix.at(row).size(); col++)
+                                {
+                                    row_sum += matrix.at(row).at(col);
+                                }
+
+                                sums_result_parallel.at(row).at(0) = static_cast<double>(row);
+                                sums_result_parallel.at(row).at(1) = row_sum;
+
+                                test_progress.advance();
+                            });
+
+                    // Instead of a reduction clause, which the pool backend does not have. One add per row,
+                    // nothing next to the rows themselves
+                    auto local_total_parallel = 0.0;
+                    for (const auto& row_result : sums_result_parallel)
+                    {
+                        local_total_parallel += row_result.at(1);
                     }
 
-                    total_parallel = local_total_parallel;
-                    execution_time_parallel = omp_get_wtime() - parallel_start_time;
+                    report.parallel_seconds = core::Clock::Seconds() - parallel_start_time;
+                    report.total_parallel = local_total_parallel;
+                    test_report.publish(report);
 
-                    can_terminate_test = true;
-                    const auto non_parallel_start_time = omp_get_wtime();
+                    const auto non_parallel_start_time = core::Clock::Seconds();
 
-                    for (i = 0; i < matrix.size(); i++)
+                    for (i = 0; i < matrix.size() && !stop_token.stop_requested(); i++)
                     {
+                        thread::winthread::safe_point();
+
                         sum = 0;
                         for (j = i; j < matrix.at(i).size(); j++)
                         {
                             sum += matrix.at(i).at(j);
                         }
 
-                        total_non_parallel += sum;
+                        report.total_non_parallel += sum;
+                        test_report.publish(report);
 
                         sums_result_non_parallel.at(i).at(0) = i;
                         sums_result_non_parallel.at(i).at(1) = sum;
+                        test_progress.advance();
                     }
-                    execution_time_non_parallel = omp_get_wtime() - non_parallel_start_time;
+                    report.non_parallel_seconds = core::Clock::Seconds() - non_parallel_start_time;
+                    test_report.publish(report);
                 });
     }
 
-    tick = omp_get_wtick();
-    end_time = omp_get_wtime();
+    tick = core::Clock::Resolution();
+    end_time = core::Clock::Seconds();
 
     DisplayBoolColored("Is test thread running", test_thread.is_running());
-    if (DrawButtonConditionally("Terminate test", !test_thread.is_running() || !can_terminate_test, "Nothing to terminate or OMP computations are not over"))
+
+    if (test_thread.is_running())
+    {
+        ui::DrawProgress(test_progress);
+    }
+
+    if (DrawButtonConditionally("Cancel test", !test_thread.is_running(), "Nothing to cancel"))
     {
-        test_thread.terminate();
+        test_thread.request_stop();
     }
 
+    const auto report = test_report.load();
+
     DrawMatrix(sums_result_parallel, "Sums per row calculated in parallel");
-    ImGui::Text("Total matrix sum calculated in parallel %lf\n", total_parallel);
+    ImGui::Text("Total matrix sum calculated in parallel %lf\n", report.total_parallel);
 
     DrawMatrix(sums_result_non_parallel,  "Sums per row calculated not in parallel");
-    ImGui::Text("Total matrix sum calculated not in parallel %lf\n", total_non_parallel);
+    ImGui::Text("Total matrix sum calculated not in parallel %lf\n", report.total_non_parallel);
 
     ImGui::Text("Timer precision %lf\n", tick);
-    ImGui::Text("Execution time parallel, ms %lf\n", execution_time_parallel * 1000.0);
-    ImGui::Text("Execution time non-parallel, ms %lf\n", execution_time_non_parallel * 1000.0);
+    ImGui::Text("Execution time parallel, ms %lf\n", report.parallel_seconds * 1000.0);
+    ImGui::Text("Execution time non-parallel, ms %lf\n", report.non_parallel_seconds * 1000.0);
     ImGui::Text("Render time (including operations), in ms %lf\n", (end_time - start_time) * 1000.0);
 
+    if (!test_thread.is_running())
+    {
+        DrawLoopStats(loop_stats_parallel);
+    }
+
+    ImGui::End();
+}
+
+namespace
+{
+    struct PipelineResult
+    {
+        MatrixType a;
+        MatrixType b;
+        MatrixType product;
+
+        size_t checked_cells = 0;
+        double max_error = 0.0;
+
+        double randomize_time = 0.0;
+        double multiply_time = 0.0;
+        double verify_time = 0.0;
+    };
+
+    // Recomputes a sample of cells sequentially, a full second multiplication would double the run
+    void VerifyProduct(PipelineResult& result)
+    {
+        constexpr size_t samples = 64;
+
+        const auto rows = result.product.size();
+        const auto cols = rows == 0 ? 0 : result.product.at(0).size();
+
+        if (rows == 0 || cols == 0)
+        {
+            return;
+        }
+
+        for (size_t s = 0; s < samples; s++)
+        {
+            const auto i = static_cast<size_t>(core::random::generate<int>(0, static_cast<int>(rows) - 1));
+            const auto k = static_cast<size_t>(core::random::generate<int>(0, static_cast<int>(cols) - 1));
+
+            double expected = 0.0;
+            for (size_t j = 0; j < result.b.size(); j++)
+            {
+                expected += result.a.at(i).at(j) * result.b.at(j).at(k);
+            }
+
+            result.max_error = std::max(result.max_error, std::abs(expected - result.product.at(i).at(k)));
+            result.checked_cells++;
+        }
+    }
+}
+
+// Randomize A and B as two pool jobs, multiply once both are there, then verify. Every stage gets the
+// previous one's output moved in, the UI only ever touches the final result
+void RenderPipelineWindow()
+{
+    static int rows = 512;
+    static int inner = 512;
+    static int cols = 512;
+
+    static thread::future<PipelineResult> pipeline;
+    static PipelineResult last_result;
+    static std::string last_error;
+
+    ImGui::Begin("Pipeline");
+
+    ImGui::InputInt("A rows", &rows);
+    ImGui::InputInt("A columns / B rows", &inner);
+    ImGui::InputInt("B columns", &cols);
+
+    const bool is_running = pipeline.is_valid() && !pipeline.is_ready();
+
+    if (DrawButtonConditionally("Run pipeline", is_running || rows <= 0 || inner <= 0 || cols <= 0, "Pipeline is already running or a size is not positive"))
+    {
+        // Pool jobs, not an OpenMP team: the policy goes to the shared pool's workers
+        thread::pool::shared().pin(ui::GetPinPolicy());
+
+        const auto pipeline_start = core::Clock::Seconds();
+
+        // Shared by the stages, the last one to go lets the UI go back to sleep
+        auto job = std::make_shared<core::FramePacer::JobScope>();
+
+        pipeline = thread::when_all(thread::async(MakeRandomMatrix, rows, inner), thread::async(MakeRandomMatrix, inner, cols))
+                .then(
+                        [pipeline_start, job](std::tuple<MatrixType, MatrixType> operands)
+                        {
+                            PipelineResult result;
+
+                            result.a = std::move(std::get<0>(operands));
+                            result.b = std::move(std::get<1>(operands));
+
+                            const auto multiply_start = core::Clock::Seconds();
+                            result.randomize_time = multiply_start - pipeline_start;
+
+                            result.product = MultiplyParallel(result.a, result.b);
+                            result.multiply_time = core::Clock::Seconds() - multiply_start;
+
+                            return result;
+                        })
+                .then(
+                        [job](PipelineResult result)
+                        {
+                            const auto verify_start = core::Clock::Seconds();
+
+                            VerifyProduct(result);
+                            result.verify_time = core::Clock::Seconds() - verify_start;
+
+                            return result;
+                        });
+    }
+
+    if (pipeline.is_ready())
+    {
+        try
+        {
+            last_error.clear();
+            last_result = pipeline.get();
+        }
+        catch (const std::exception& e)
+        {
+            last_error = e.what();
+        }
+    }
+
+    DisplayBoolColored("Is pipeline running", is_running);
+
+    if (!last_error.empty())
+    {
+        ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Pipeline failed: %s", last_error.c_str());
+    }
+
+    DrawMatrix(last_result.a, "Matrix A: ");
+    DrawMatrix(last_result.b, "Matrix B: ");
+    DrawMatrix(last_result.product, "A x B: ");
+
+    ImGui::Text("Verified cells %zu, max abs error %e", last_result.checked_cells, last_result.max_error);
+    ImGui::Text("Randomize (A and B together), ms %lf", last_result.randomize_time * 1000.0);
+    ImGui::Text("Multiply, ms %lf", last_result.multiply_time * 1000.0);
+    ImGui::Text("Verify, ms %lf", last_result.verify_time * 1000.0);
+
     ImGui::End();
 }
 
@@ -483,4 +945,8 @@ void ImGUILayer::Render()
 {
     RenderMultiplicationWindow();
     RenderMatrixRowSumCalculationWindow();
+    RenderPipelineWindow();
+
+    ui::RenderFramePacingPanel();
+    ui::RenderTracePanel();
 }
@@ -0,0 +1,60 @@
+#include <Matrix.hpp>
+#include <core/include/Timer.hpp>
+#include <core/include/Random.hpp>
+#include <wrappers/include/trace.hpp>
+#include <wrappers/include/parallel.hpp>
+
+#include <omp.h>
+
+using namespace retro;
+
+matrix::MatrixType matrix::MakeRandomMatrix(int rows, int cols)
+{
+    retro::core::ScopeTimer _("Matrix randomize");
+
+    MatrixType matrix(rows, std::vector<double>(cols, 0.0));
+
+    parallel::for_each(0, matrix.size(),
+            [&](size_t row)
+            {
+                for (auto& value : matrix.at(row))
+                {
+                    value = core::random::generate<MatrixType::value_type::value_type>(-100, 100);
+                }
+            });
+
+    return matrix;
+}
+
+matrix::MatrixType matrix::MultiplyParallel(const MatrixType& a, const MatrixType& b)
+{
+    const auto rows = static_cast<int>(a.size());
+    const auto inner = b.size();
+    const auto cols = b.empty() ? 0 : b.at(0).size();
+
+    MatrixType product(rows, std::vector<double>(cols, 0.0));
+
+    // The loop ends in nowait so each thread's zone covers its own rows only, the wait for the slowest one
+    // happens at the end of the region, outside of it
+#pragma omp parallel shared(a, b, product)
+    {
+        trace::zone _("GEMM rows");
+
+#pragma omp for nowait
+        for (int i = 0; i < rows; i++)
+        {
+            for (size_t k = 0; k < cols; k++)
+            {
+                double sum = 0.0;
+                for (size_t j = 0; j < inner; j++)
+                {
+                    sum += a.at(i).at(j) * b.at(j).at(k);
+                }
+
+                product.at(i).at(k) = sum;
+            }
+        }
+    }
+
+    return product;
+}
@@ -1,16 +1,37 @@
-#include <ImGUILayer.hpp>
+#include <HeadlessMultiplicationLayer.hpp>
 #include <core/include/Application.hpp>
 
+#if !defined(RETRO_HEADLESS_ONLY)
+# include <ImGUILayer.hpp>
+#endif
+
+#include <iostream>
+
 #ifndef _OPENMP
 # error "OpenMP is not supported"
 #endif
 
 using namespace retro;
 
-int SDL_main(int argc, char** argv)
+// SDL.h renames it to SDL_main where SDL2main provides the entry point
+int main(int argc, char** argv)
 {
     core::Application app;
-    app.EmplaceLayer<ImGUILayer>("ImGUILayer");
+
+    // --headless runs the kernel alone, no window, and prints the results
+    if (const auto options = core::HeadlessOptions::Parse(argc, argv))
+    {
+        app.EmplaceLayer<HeadlessMultiplicationLayer>("HeadlessLayer", *options);
+    }
+    else
+    {
+#if defined(RETRO_HEADLESS_ONLY)
+        std::cerr << "Error: Built without a window, run with --headless\n";
+        return 1;
+#else
+        app.EmplaceLayer<ImGUILayer>("ImGUILayer");
+#endif
+    }
 
     return app.Run();
 }
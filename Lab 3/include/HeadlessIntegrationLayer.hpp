@@ -0,0 +1,37 @@
+#pragma once
+
+#include <core/include/HeadlessLayer.hpp>
+
+namespace retro
+{
+    // The integration kernel without the window, started with --headless. Takes --a, --b, --steps, --threads
+    // and --parallel=0 for the single threaded version
+    class HeadlessIntegrationLayer
+        : public core::HeadlessLayer
+    {
+    public:
+
+        explicit HeadlessIntegrationLayer(core::HeadlessOptions options);
+
+        void OnAttach() override;
+
+    protected:
+
+        bool RunIteration(uint64_t index) override;
+
+        void Report(std::ostream& out) override;
+
+    private:
+
+        double m_a { 1.0 };
+        double m_b { 4.0 };
+
+        int m_steps { 1000 };
+        bool m_is_parallel { true };
+
+        double m_result { 0.0 };
+
+        double m_best_seconds { 0.0 };
+
+    };
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <wrappers/include/progress.hpp>
+
+#include <functional>
+#include <stop_token>
+
+namespace retro::integration
+{
+    using ValueType = double;
+    using FuncType = std::function<ValueType(ValueType)>;
+
+    // The integrand of the lab, (1 + x) / sqrt(2x)
+    ValueType Func(ValueType x);
+
+    // Trapezoidal rule over [a, b] in n steps. Both the window and the headless runner call these; the stop
+    // token is polled and the progress bumped once per chunk of steps
+    ValueType IntegrateParallel(const FuncType f, ValueType a, ValueType b, int n, const std::stop_token& stop_token, thread::progress& progress);
+
+    ValueType IntegrateNonParallel(const FuncType& f, ValueType a, ValueType b, int n, const std::stop_token& stop_token, thread::progress& progress);
+}
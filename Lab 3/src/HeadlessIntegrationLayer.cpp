@@ -0,0 +1,56 @@
+#include <HeadlessIntegrationLayer.hpp>
+#include <Integration.hpp>
+#include <core/include/Clock.hpp>
+
+#include <ostream>
+#include <utility>
+#include <algorithm>
+
+#include <omp.h>
+
+using namespace retro;
+
+HeadlessIntegrationLayer::HeadlessIntegrationLayer(core::HeadlessOptions options)
+    : HeadlessLayer("Integration", std::move(options))
+{
+}
+
+void HeadlessIntegrationLayer::OnAttach()
+{
+    m_a = m_options.GetDouble("a", m_a);
+    m_b = m_options.GetDouble("b", m_b);
+    m_steps = static_cast<int>(m_options.GetInt("steps", m_steps));
+    m_is_parallel = m_options.GetInt("parallel", 1) != 0;
+
+    if (const auto threads = m_options.GetInt("threads", 0); threads > 0)
+    {
+        omp_set_num_threads(static_cast<int>(threads));
+    }
+}
+
+bool HeadlessIntegrationLayer::RunIteration(uint64_t index)
+{
+    // Nobody looks at the progress or cancels a headless run
+    thread::progress progress;
+    const std::stop_token never_stopped;
+
+    const auto start = core::Clock::Seconds();
+
+    m_result = m_is_parallel
+            ? integration::IntegrateParallel(integration::Func, m_a, m_b, m_steps, never_stopped, progress)
+            : integration::IntegrateNonParallel(integration::Func, m_a, m_b, m_steps, never_stopped, progress);
+
+    const auto seconds = core::Clock::Seconds() - start;
+
+    m_best_seconds = index == 0 ? seconds : std::min(m_best_seconds, seconds);
+
+    return true;
+}
+
+void HeadlessIntegrationLayer::Report(std::ostream& out)
+{
+    out << "  mode: " << (m_is_parallel ? "parallel" : "non-parallel") << ", threads " << (m_is_parallel ? omp_get_max_threads() : 1) << '\n';
+    out << "  steps: " << m_steps << " over [" << m_a << ", " << m_b << "]\n";
+    out << "  result: " << m_result << '\n';
+    out << "  best iteration, ms: " << m_best_seconds * 1000.0 << '\n';
+}
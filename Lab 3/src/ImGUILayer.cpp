@@ -1,5 +1,14 @@
 #include <ImGUILayer.hpp>
+#include <Integration.hpp>
 #include <core/include/Random.hpp>
+#include <core/include/Clock.hpp>
+#include <core/include/FramePacer.hpp>
+#include <wrappers/include/seqlock.hpp>
+#include <wrappers/include/progress.hpp>
+#include <ui/include/PinningControls.hpp>
+#include <ui/include/ProgressBar.hpp>
+#include <ui/include/TracePanel.hpp>
+#include <ui/include/FramePacingPanel.hpp>
 
 #include <iostream>
 #include <algorithm>
@@ -13,63 +22,10 @@
 #include <omp.h>
 
 using namespace retro;
+using namespace retro::integration;
 
 namespace
 {
-    using ValueType = double;
-    using FuncType = std::function<ValueType(ValueType)>;
-
-    ValueType Func(ValueType x)
-    {
-        return (1 + x) / (std::sqrt(2 * x));
-    }
-
-    ValueType IntegrateParallel(const FuncType f, ValueType a, ValueType b, int n)
-    {
-        ValueType result = 0.0;
-        ValueType dx = (b - a) / n;
-
-#pragma omp parallel firstprivate(a, dx, f)
-        {
-#pragma omp for reduction(+:result)
-            for(int i = 0; i <= n; i++)
-            {
-                ValueType x = a + i * dx;
-                if (i == 0 || i == n)
-                {
-                    result += f(x) / 2.0;
-                }
-                else
-                {
-                    result += f(x);
-                }
-            }
-        }
-
-        return result * dx;
-    }
-
-    double IntegrateNonParallel(const FuncType& f, ValueType a, ValueType b, int n)
-    {
-        ValueType result = 0.0;
-        ValueType dx = (b - a) / n;
-
-        for(int i = 0; i <= n; i++)
-        {
-            ValueType x = a + i * dx;
-            if (i == 0 || i == n)
-            {
-                result += f(x) / 2.0;
-            }
-            else
-            {
-                result += f(x);
-            }
-        }
-
-        return result * dx;
-    }
-
     void DisplayBoolColored(const char* label, bool value)
     {
         ImVec4 color = value ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(1.0f, 0.0f, 0.0f, 1.0f);
@@ -153,10 +109,12 @@ void ImGUILayer::OnAttach()
 bool ImGUILayer::OnUpdate(ts delta)
 {
     const auto& io = ImGui::GetIO();
-    for (const auto& event : m_window->PollEvents())
-    {
-        core::EventsPoll::AddEvent(event);
-    }
+    // Sleeps until input, a finished job or the next low rate refresh, see core::FramePacer
+    auto& pacer = core::FramePacer::Get();
+    const auto events = m_window->PollEvents(pacer.GetWaitTimeout());
+    pacer.BeginFrame(events);
+
+    core::EventBus::Get().PostAll(events);
 
     ImGui_ImplDX11_NewFrame();
     ImGui_ImplSDL2_NewFrame();
@@ -189,6 +147,7 @@ bool ImGUILayer::OnUpdate(ts delta)
     }
 
     m_window->GetDirectXSwapChain()->Present(1, 0);
+    pacer.EndFrame();
 
     return true;
 }
@@ -219,17 +178,27 @@ void ImGUILayer::Render()
     static ValueType a = 1.0;
     static ValueType b = 4.0;
 
-    static ValueType result_parallel = 0.0;
-    static ValueType result_non_parallel = 0.0;
-
     static int num_of_steps = 1000;
     static thread::winthread test_thread;
+    static thread::progress test_progress;
+
+    // Published by the test thread once both passes are done, read by the window every frame. A cancelled
+    // run would leave partial integrals: it republishes the last complete report flagged instead
+    struct IntegrationReport
+    {
+        ValueType result_parallel = 0.0;
+        ValueType result_non_parallel = 0.0;
 
-    static double execution_time_parallel = 0.0;
-    static double execution_time_non_parallel = 0.0;
+        double parallel_seconds = 0.0;
+        double non_parallel_seconds = 0.0;
+
+        bool is_cancelled = false;
+    };
+
+    static concurrent::seqlock<IntegrationReport> test_report;
 
     ImGui::Begin("Integration");
-    start_time = omp_get_wtime();
+    start_time = core::Clock::Seconds();
 
     ImGui::InputInt("Number of steps", &num_of_steps, 1);
 
@@ -243,39 +212,75 @@ void ImGUILayer::Render()
     {
         omp_set_num_threads(threads);
     }
+    ui::DrawPinningCombo();
 
     if(DrawButtonConditionally("Run calculations", test_thread.is_running(), "Calculations are already running"))
     {
         test_thread.run(
             [=]()
             {
-                execution_time_parallel = 0.0;
-                execution_time_non_parallel = 0.0;
+                core::FramePacer::JobScope job;
+
+                ui::PinOpenMPTeam(ui::GetPinPolicy());
+
+                IntegrationReport report;
 
-                const auto parallel_start = omp_get_wtime();
-                result_parallel = IntegrateParallel(Func, a, b, num_of_steps);
-                execution_time_parallel = omp_get_wtime() - parallel_start;
+                const auto stop_token = thread::winthread::current_stop_token();
+                test_progress.start(2 * (static_cast<uint64_t>(num_of_steps) + 1));
 
-                const auto non_parallel_start = omp_get_wtime();
-                result_non_parallel = IntegrateNonParallel(Func, a, b, num_of_steps);
-                execution_time_non_parallel = omp_get_wtime() - non_parallel_start;
+                const auto parallel_start = core::Clock::Seconds();
+                report.result_parallel = IntegrateParallel(Func, a, b, num_of_steps, stop_token, test_progress);
+                report.parallel_seconds = core::Clock::Seconds() - parallel_start;
+
+                const auto non_parallel_start = core::Clock::Seconds();
+                report.result_non_parallel = IntegrateNonParallel(Func, a, b, num_of_steps, stop_token, test_progress);
+                report.non_parallel_seconds = core::Clock::Seconds() - non_parallel_start;
+
+                // Both passes skip their remaining chunks once cancelled
+                if (test_progress.done() < test_progress.total())
+                {
+                    report = test_report.load();
+                    report.is_cancelled = true;
+                }
+
+                test_report.publish(report);
             });
     }
 
-    ImGui::Text("Integration result parallel: %lf", result_parallel);
-    ImGui::Text("Integration result non-parallel: %lf", result_non_parallel);
+    const auto report = test_report.load();
 
-    tick = omp_get_wtick();
-    end_time = omp_get_wtime();
+    ImGui::Text("Integration result parallel: %lf", report.result_parallel);
+    ImGui::Text("Integration result non-parallel: %lf", report.result_non_parallel);
+
+    if (report.is_cancelled)
+    {
+        ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.5f, 1.0f), "Last run was cancelled, showing the last complete one");
+    }
+
+    tick = core::Clock::Resolution();
+    end_time = core::Clock::Seconds();
 
     DisplayBoolColored("Is test thread running", test_thread.is_running());
 
+    if (test_thread.is_running())
+    {
+        ui::DrawProgress(test_progress);
+    }
+
+    if (DrawButtonConditionally("Cancel calculations", !test_thread.is_running(), "Nothing to cancel"))
+    {
+        test_thread.request_stop();
+    }
+
     ImGui::Text("Timer precision %lf\n", tick);
 
-    ImGui::Text("Execution time parallel, ms %lf\n", execution_time_parallel * 1000.0);
-    ImGui::Text("Execution time non-parallel, ms %lf\n", execution_time_non_parallel * 1000.0);
+    ImGui::Text("Execution time parallel, ms %lf\n", report.parallel_seconds * 1000.0);
+    ImGui::Text("Execution time non-parallel, ms %lf\n", report.non_parallel_seconds * 1000.0);
 
     ImGui::Text("Render time (including operations), in ms %lf\n", (end_time - start_time) * 1000.0);
 
     ImGui::End();
+
+    ui::RenderFramePacingPanel();
+    ui::RenderTracePanel();
 }
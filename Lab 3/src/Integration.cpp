@@ -0,0 +1,98 @@
+#include <Integration.hpp>
+
+#include <wrappers/include/winthread.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+#include <omp.h>
+
+using namespace retro;
+
+namespace
+{
+    using integration::ValueType;
+    using integration::FuncType;
+
+    // Steps are handed out in chunks, the stop token is polled, the progress bumped and a winthread::safe_point()
+    // passed once per chunk
+    constexpr int steps_per_chunk = 1 << 14;
+
+    ValueType IntegrateChunk(const FuncType& f, ValueType a, ValueType dx, int n, int chunk)
+    {
+        ValueType result = 0.0;
+
+        const int first = chunk * steps_per_chunk;
+        const int last = std::min(first + steps_per_chunk - 1, n);
+
+        for(int i = first; i <= last; i++)
+        {
+            ValueType x = a + i * dx;
+            if (i == 0 || i == n)
+            {
+                result += f(x) / 2.0;
+            }
+            else
+            {
+                result += f(x);
+            }
+        }
+
+        return result;
+    }
+
+    int ChunkSize(int n, int chunk)
+    {
+        return std::min(chunk * steps_per_chunk + steps_per_chunk - 1, n) - chunk * steps_per_chunk + 1;
+    }
+}
+
+ValueType integration::Func(ValueType x)
+{
+    return (1 + x) / (std::sqrt(2 * x));
+}
+
+ValueType integration::IntegrateParallel(const FuncType f, ValueType a, ValueType b, int n, const std::stop_token& stop_token, thread::progress& progress)
+{
+    ValueType result = 0.0;
+    ValueType dx = (b - a) / n;
+
+    const int chunks = n / steps_per_chunk + 1;
+
+#pragma omp parallel firstprivate(a, dx, f) shared(stop_token, progress)
+    {
+#pragma omp for reduction(+:result)
+        for(int chunk = 0; chunk < chunks; chunk++)
+        {
+            thread::winthread::safe_point();
+
+            if (stop_token.stop_requested())
+            {
+                continue;
+            }
+
+            result += IntegrateChunk(f, a, dx, n, chunk);
+            progress.advance(ChunkSize(n, chunk));
+        }
+    }
+
+    return result * dx;
+}
+
+ValueType integration::IntegrateNonParallel(const FuncType& f, ValueType a, ValueType b, int n, const std::stop_token& stop_token, thread::progress& progress)
+{
+    ValueType result = 0.0;
+    ValueType dx = (b - a) / n;
+
+    const int chunks = n / steps_per_chunk + 1;
+
+    for(int chunk = 0; chunk < chunks && !stop_token.stop_requested(); chunk++)
+    {
+        thread::winthread::safe_point();
+
+        result += IntegrateChunk(f, a, dx, n, chunk);
+        progress.advance(ChunkSize(n, chunk));
+    }
+
+    return result * dx;
+}
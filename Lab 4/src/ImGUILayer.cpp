@@ -1,5 +1,14 @@
 #include <ImGUILayer.hpp>
 #include <core/include/Random.hpp>
+#include <core/include/Clock.hpp>
+#include <core/include/FramePacer.hpp>
+#include <wrappers/include/team.hpp>
+#include <wrappers/include/seqlock.hpp>
+#include <wrappers/include/progress.hpp>
+#include <ui/include/PinningControls.hpp>
+#include <ui/include/ProgressBar.hpp>
+#include <ui/include/TracePanel.hpp>
+#include <ui/include/FramePacingPanel.hpp>
 
 #include <iostream>
 #include <algorithm>
@@ -19,9 +28,24 @@ namespace
     using ValueType = double;
     using MatrixType = std::vector<std::vector<ValueType>>;
 
-    std::vector<ValueType> Solve(MatrixType matrix)
+    void NormalizeRow(MatrixType& matrix, int row)
+    {
+        const auto tmp = matrix[row][row];
+        const auto n = static_cast<int>(matrix.size());
+
+        for (int j = n; j >= row; j--)
+        {
+            matrix[row][j] /= tmp;
+        }
+    }
+
+    // Forward elimination on one persistent team: row j belongs to member j % size for the whole solve and
+    // every pivot costs one barrier instead of a fork/join. The owner of row i + 1 normalizes it right after
+    // eliminating it, so it is ready as the next pivot once the barrier opens.
+    // Progress counts eliminated columns; the token is checked before each of them, a cancelled solve
+    // returns an empty vector
+    std::vector<ValueType> Solve(MatrixType matrix, thread::team& team, const std::stop_token& stop_token, thread::progress& progress)
     {
-        ValueType tmp;
         int n = static_cast<int>(matrix.size());
 
         if (n == 0)
@@ -30,26 +54,61 @@ namespace
         }
 
         std::vector<ValueType> xx(n, 0.0);
+        progress.start(n);
 
-        for (int i = 0; i < n; i++)
-        {
-            tmp = matrix[i][i];
-            for (int j = n; j >= i; j--)
-            {
-                matrix[i][j] /= tmp;
-            }
+        // Only member 0 checks the token. Once set, everybody skips the work but keeps walking the barriers,
+        // members never disagree on how many of them are left
+        std::atomic<bool> is_cancelled { false };
 
-            int j;
-            int k;
-#pragma omp parallel for private (j, k, tmp)
-            for (j = i + 1; j < n; j++)
-            {
-                tmp = matrix[j][i];
-                for (k = n; k >= i; k--)
+        NormalizeRow(matrix, 0);
+
+        team.run(
+                [&](uint32_t index, uint32_t size)
                 {
-                    matrix[j][k] -= tmp * matrix[i][k];
-                }
-            }
+                    const auto members = static_cast<int>(size);
+
+                    for (int i = 0; i < n; i++)
+                    {
+                        // A paused member 0 holds the others at the next barrier
+                        thread::winthread::safe_point();
+
+                        if (index == 0 && stop_token.stop_requested())
+                        {
+                            is_cancelled.store(true, std::memory_order_relaxed);
+                        }
+
+                        if (!is_cancelled.load(std::memory_order_relaxed))
+                        {
+                            const auto first = i + 1 + (static_cast<int>(index) - (i + 1) % members + members) % members;
+
+                            for (int j = first; j < n; j += members)
+                            {
+                                const auto tmp = matrix[j][i];
+
+                                for (int k = n; k >= i; k--)
+                                {
+                                    matrix[j][k] -= tmp * matrix[i][k];
+                                }
+
+                                if (j == i + 1)
+                                {
+                                    NormalizeRow(matrix, j);
+                                }
+                            }
+                        }
+
+                        team.sync(index);
+
+                        if (index == 0)
+                        {
+                            progress.advance();
+                        }
+                    }
+                });
+
+        if (is_cancelled.load(std::memory_order_relaxed))
+        {
+            return { };
         }
 
         xx[n - 1] = matrix[n - 1][n];
@@ -211,10 +270,12 @@ void ImGUILayer::OnAttach()
 
 bool ImGUILayer::OnUpdate(ts delta)
 {
-    for (const auto& event : m_window->PollEvents())
-    {
-        core::EventsPoll::AddEvent(event);
-    }
+    // Sleeps until input, a finished job or the next low rate refresh, see core::FramePacer
+    auto& pacer = core::FramePacer::Get();
+    const auto events = m_window->PollEvents(pacer.GetWaitTimeout());
+    pacer.BeginFrame(events);
+
+    core::EventBus::Get().PostAll(events);
 
     ImGui_ImplDX11_NewFrame();
     ImGui_ImplSDL2_NewFrame();
@@ -249,6 +310,7 @@ bool ImGUILayer::OnUpdate(ts delta)
     }
 
     m_window->GetDirectXSwapChain()->Present(1, 0);
+    pacer.EndFrame();
 
     return true;
 }
@@ -276,8 +338,9 @@ void ImGUILayer::Render()
     double end_time;
     double start_time;
 
-    static double execution_time = 0.0;
     static thread::winthread test_thread;
+    static thread::progress test_progress;
+    static std::unique_ptr<thread::team> solve_team;
 
     static int n = 5;
     static int threads = 4;
@@ -287,8 +350,19 @@ void ImGUILayer::Render()
     using HistoryEntry = std::pair<int, double>;
     static std::vector<HistoryEntry> execution_time_history;
 
+    // Published by the test thread once a run ends, the UI thread moves completed ones into the history
+    struct RunReport
+    {
+        int threads = 0;
+        double seconds = 0.0;
+        bool is_complete = false;
+    };
+
+    static concurrent::seqlock<RunReport> last_run;
+    static uint64_t last_run_seen = 0;
+
     ImGui::Begin("Gauss method");
-    start_time = omp_get_wtime();
+    start_time = core::Clock::Seconds();
 
     ImGui::InputInt("Matrix size", &n);
 
@@ -305,6 +379,7 @@ void ImGUILayer::Render()
     {
         omp_set_num_threads(threads);
     }
+    ui::DrawPinningCombo();
 
     if (DrawButtonConditionally("Run calculations", test_thread.is_running() || matrix.empty()
                                 , matrix.empty() ? "Matrix is empty" : "Calculations are already running"))
@@ -312,25 +387,57 @@ void ImGUILayer::Render()
         test_thread.run(
                 [=]()
                 {
-                    execution_time = 0.0;
-                    const auto execution_start = omp_get_wtime();
-                    result[0] = Solve(matrix);
-                    execution_time = omp_get_wtime() - execution_start;
+                    core::FramePacer::JobScope job;
+
+                    // Kept across runs, rebuilt only when the thread count or the pinning changes
+                    const auto members = static_cast<uint32_t>(std::max(threads, 1));
 
-                    execution_time_history.emplace_back(threads, execution_time);
+                    if (!solve_team || solve_team->size() != members || solve_team->get_pin_policy() != ui::GetPinPolicy())
+                    {
+                        solve_team = std::make_unique<thread::team>(members, ui::GetPinPolicy());
+                    }
+
+                    const auto execution_start = core::Clock::Seconds();
+                    result[0] = Solve(matrix, *solve_team, thread::winthread::current_stop_token(), test_progress);
+
+                    // A cancelled run says nothing about the thread count
+                    last_run.publish({ threads, core::Clock::Seconds() - execution_start, !result[0].empty() });
                 });
     }
 
+    uint64_t last_run_version;
+    const auto report = last_run.load(last_run_version);
+
+    if (last_run_version != last_run_seen)
+    {
+        last_run_seen = last_run_version;
+
+        if (report.is_complete)
+        {
+            execution_time_history.emplace_back(report.threads, report.seconds);
+        }
+    }
+
 
     DrawMatrix(result, "Result");
 
-    tick = omp_get_wtick();
-    end_time = omp_get_wtime();
+    tick = core::Clock::Resolution();
+    end_time = core::Clock::Seconds();
 
     DisplayBoolColored("Is test thread running", test_thread.is_running());
 
+    if (test_thread.is_running())
+    {
+        ui::DrawProgress(test_progress);
+    }
+
+    if (DrawButtonConditionally("Cancel calculations", !test_thread.is_running(), "Nothing to cancel"))
+    {
+        test_thread.request_stop();
+    }
+
     ImGui::Text("Timer precision %lf\n", tick);
-    ImGui::Text("Execution time parallel, ms %lf\n", execution_time * 1000.0);
+    ImGui::Text("Execution time parallel, ms %lf\n", report.seconds * 1000.0);
     ImGui::Text("Render time (including operations), in ms %lf\n", (end_time - start_time) * 1000.0);
 
     if (DrawButtonConditionally("Clear history", execution_time_history.empty(), "History is already as clean as my browser`s one"))
@@ -392,4 +499,7 @@ void ImGUILayer::Render()
     }
 
     ImGui::End();
+
+    ui::RenderFramePacingPanel();
+    ui::RenderTracePanel();
 }
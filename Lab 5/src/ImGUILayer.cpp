@@ -1,6 +1,18 @@
 #include <ImGUILayer.hpp>
 #include <core/include/Random.hpp>
-
+#include <core/include/Clock.hpp>
+#include <core/include/FramePacer.hpp>
+#include <wrappers/include/sharded.hpp>
+#include <wrappers/include/seqlock.hpp>
+#include <wrappers/include/progress.hpp>
+#include <wrappers/include/scheduler.hpp>
+#include <ui/include/PinningControls.hpp>
+#include <ui/include/ProgressBar.hpp>
+#include <ui/include/TracePanel.hpp>
+#include <ui/include/FramePacingPanel.hpp>
+
+#include <atomic>
+#include <vector>
 #include <numbers>
 #include <iostream>
 #include <algorithm>
@@ -81,26 +93,82 @@ namespace
         ImGui::PopStyleColor();
     }
 
-    double ApproximatePi(const int samples)
+    // Samples are drawn in chunks, the stop token is polled and the progress bumped once per chunk
+    constexpr int samples_per_chunk = 1 << 14;
+
+    // Estimate from whatever samples are done so far
+    double RunningEstimate(const concurrent::sharded_counter<uint64_t>& hits, const thread::progress& progress)
+    {
+        const auto done = progress.done();
+        return done > 0 ? 4.0 * static_cast<double>(hits.load()) / static_cast<double>(done) : 0.0;
+    }
+
+    // Hits go to a sharded counter once per chunk instead of a reduction, so the UI can read a running
+    // estimate while the team is still drawing, without the team members sharing a cache line for it
+    double ApproximatePi(const int samples, const std::stop_token& stop_token, thread::progress& progress, concurrent::sharded_counter<uint64_t>& hits)
     {
-        int s;
-        int counter = 0;
+        int chunk;
         constexpr double radius = 1.0;
 
-#pragma omp parallel for reduction(+:counter)
-        for (s = 0; s < samples; s++)
+        const int chunks = (samples + samples_per_chunk - 1) / samples_per_chunk;
+
+        hits.reset();
+        progress.start(samples);
+
+#pragma omp parallel for shared(stop_token, progress, hits)
+        for (chunk = 0; chunk < chunks; chunk++)
         {
-            auto x = retro::core::random::generate(- radius, radius);
-            auto y = retro::core::random::generate(- radius, radius);
+            thread::winthread::safe_point();
 
-            if ((x * x + y * y) < radius)
+            if (stop_token.stop_requested())
             {
-                counter++;
+                continue;
             }
+
+            const int first = chunk * samples_per_chunk;
+            const int last = std::min(first + samples_per_chunk, samples);
+
+            uint64_t chunk_hits = 0;
+
+            for (int s = first; s < last; s++)
+            {
+                auto x = retro::core::random::generate(- radius, radius);
+                auto y = retro::core::random::generate(- radius, radius);
+
+                if ((x * x + y * y) < radius)
+                {
+                    chunk_hits++;
+                }
+            }
+
+            hits.add(chunk_hits);
+            progress.advance(last - first);
         }
 
-        return 4.0 * counter / samples;
+        // Over the samples actually drawn, a cancelled run skipped the rest of its chunks
+        return RunningEstimate(hits, progress);
     }
+
+    struct HistoryEntry
+    {
+        double exec_time = 0.0;
+        double deviation = 0.0;
+        double approx_result = 0.0;
+
+        int steps_count = 1;
+        int threads_count = 1;
+    };
+
+    // Posted by the test thread when a run completes, OnEvent appends it to the history (through the main
+    // thread queue if the bus is full). Cancelled runs are not posted, they did not draw all of their
+    // samples
+    struct RunCompletedEvent
+    {
+        HistoryEntry entry;
+    };
+
+    // Only touched by the UI thread
+    std::vector<HistoryEntry> execution_time_history;
 }
 
 void ImGUILayer::OnAttach()
@@ -154,10 +222,12 @@ void ImGUILayer::OnAttach()
 
 bool ImGUILayer::OnUpdate(ts delta)
 {
-    for (const auto& event : m_window->PollEvents())
-    {
-        core::EventsPoll::AddEvent(event);
-    }
+    // Sleeps until input, a finished job or the next low rate refresh, see core::FramePacer
+    auto& pacer = core::FramePacer::Get();
+    const auto events = m_window->PollEvents(pacer.GetWaitTimeout());
+    pacer.BeginFrame(events);
+
+    core::EventBus::Get().PostAll(events);
 
     ImGui_ImplDX11_NewFrame();
     ImGui_ImplSDL2_NewFrame();
@@ -192,6 +262,7 @@ bool ImGUILayer::OnUpdate(ts delta)
     }
 
     m_window->GetDirectXSwapChain()->Present(1, 0);
+    pacer.EndFrame();
 
     return true;
 }
@@ -210,6 +281,11 @@ bool ImGUILayer::OnEvent(const core::Event &event)
         return false;
     }
 
+    if (const auto run = core::EventBus::As<RunCompletedEvent>(event))
+    {
+        execution_time_history.emplace_back(run->entry);
+    }
+
     return true;
 }
 
@@ -219,27 +295,20 @@ void ImGUILayer::Render()
     double end_time;
     double start_time;
 
-    static double execution_time = 0.0;
     static thread::winthread test_thread;
+    static thread::progress test_progress;
+    static concurrent::sharded_counter<uint64_t> test_hits;
 
     static int n = 500;
     static int threads = 4;
-    static double result = 0.0;
-
-    struct HistoryEntry
-    {
-        double exec_time = 0.0;
-        double deviation = 0.0;
-        double approx_result = 0.0;
-
-        int steps_count = 1;
-        int threads_count = 1;
-    };
 
-    static std::vector<HistoryEntry> execution_time_history;
+    // The last run, cancelled or not, published by the test thread once it ends
+    // The last complete run, a cancelled one only sets the flag
+    static concurrent::seqlock<HistoryEntry> last_run;
+    static std::atomic<bool> is_last_run_cancelled { false };
 
     ImGui::Begin("PI approximation");
-    start_time = omp_get_wtime();
+    start_time = core::Clock::Seconds();
 
     ImGui::InputInt("Samples count", &n);
     ImGui::DragInt("Threads count", &threads, 0.05F, 1, omp_get_max_threads());
@@ -248,33 +317,59 @@ void ImGUILayer::Render()
     {
         omp_set_num_threads(threads);
     }
+    ui::DrawPinningCombo();
 
     if (DrawButtonConditionally("Run calculations", test_thread.is_running(), "Calculations are already running"))
     {
         test_thread.run(
                 [=]()
                 {
+                    core::FramePacer::JobScope job;
+
+                    ui::PinOpenMPTeam(ui::GetPinPolicy());
+
                     HistoryEntry entry;
 
                     entry.steps_count = n;
                     entry.threads_count = threads;
 
-                    execution_time = 0.0;
-                    const auto execution_start = omp_get_wtime();
-                    result = ApproximatePi(n);
-                    execution_time = omp_get_wtime() - execution_start;
+                    const auto stop_token = thread::winthread::current_stop_token();
+
+                    const auto execution_start = core::Clock::Seconds();
+                    entry.approx_result = ApproximatePi(n, stop_token, test_progress, test_hits);
+                    entry.exec_time = core::Clock::Seconds() - execution_start;
+                    entry.deviation = std::abs(entry.approx_result - std::numbers::pi);
 
-                    entry.approx_result = result;
-                    entry.exec_time = execution_time;
-                    entry.deviation = std::abs(result - std::numbers::pi);
+                    const bool is_cancelled = test_progress.done() < test_progress.total();
+                    is_last_run_cancelled.store(is_cancelled, std::memory_order_relaxed);
 
-                    execution_time_history.emplace_back(entry);
+                    if (is_cancelled)
+                    {
+                        return;
+                    }
+
+                    last_run.publish(entry);
+
+                    // The bus drops events once it is full, a completed run must not go with them
+                    if (!core::EventBus::Get().Post(RunCompletedEvent { entry }))
+                    {
+                        thread::main_thread_queue::shared().post([entry]() { execution_time_history.emplace_back(entry); });
+                    }
                 });
     }
 
+    const auto report = last_run.load();
+
+    const auto result = report.approx_result;
+
     ImGui::Text("Perfect result: %lf", std::numbers::pi);
     ImGui::Text("Approximation result: %lf", result);
 
+    if (is_last_run_cancelled.load(std::memory_order_relaxed))
+    {
+        ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.5f, 1.0f), "Last run was cancelled, showing the last complete one");
+    }
+
     const auto deviation = std::abs(result - std::numbers::pi);
 
     const ImVec4 bad_color = ImVec4(1.0f, 0.0f, 0.0f, 1.0f);
@@ -295,13 +390,24 @@ void ImGUILayer::Render()
                   , "Approx. deviation: %lf"
                   , deviation);
 
-    tick = omp_get_wtick();
-    end_time = omp_get_wtime();
+    tick = core::Clock::Resolution();
+    end_time = core::Clock::Seconds();
 
     DisplayBoolColored("Is test thread running", test_thread.is_running());
 
+    if (test_thread.is_running())
+    {
+        ui::DrawProgress(test_progress);
+        ImGui::Text("Running estimate: %lf", RunningEstimate(test_hits, test_progress));
+    }
+
+    if (DrawButtonConditionally("Cancel calculations", !test_thread.is_running(), "Nothing to cancel"))
+    {
+        test_thread.request_stop();
+    }
+
     ImGui::Text("Timer precision %lf\n", tick);
-    ImGui::Text("Execution time parallel, ms %lf\n", execution_time * 1000.0);
+    ImGui::Text("Execution time parallel, ms %lf\n", report.exec_time * 1000.0);
     ImGui::Text("Render time (including operations), in ms %lf\n", (end_time - start_time) * 1000.0);
 
     if (DrawButtonConditionally("Clear history", execution_time_history.empty(), "History is already as clean as my browser`s one"))
@@ -407,4 +513,7 @@ void ImGUILayer::Render()
     }
 
     ImGui::End();
+
+    ui::RenderFramePacingPanel();
+    ui::RenderTracePanel();
 }
@@ -1,5 +1,16 @@
 #include <ImGUILayer.hpp>
 #include <core/include/Random.hpp>
+#include <core/include/Clock.hpp>
+#include <core/include/FramePacer.hpp>
+
+#include <wrappers/include/task.hpp>
+#include <wrappers/include/team.hpp>
+#include <wrappers/include/trace.hpp>
+#include <wrappers/include/seqlock.hpp>
+#include <ui/include/PinningControls.hpp>
+#include <ui/include/TracePanel.hpp>
+#include <ui/include/FramePacingPanel.hpp>
+#include <ui/include/LockProfilerPanel.hpp>
 
 #include <mutex>
 #include <iostream>
@@ -69,111 +80,248 @@ namespace
         }
     }
 
-    void Simulate(std::vector<std::vector<CellState>>& grid)
+    constexpr int dx[] = {-1, -1, -1, 0, 1, 1,  1,  0};
+    constexpr int dy[] = {-1,  0,  1, 1, 1, 0, -1, -1};
+
+    bool IsInside(const std::vector<std::vector<CellState>>& grid, int i, int j)
     {
-        std::vector<std::vector<CellState>> newGrid = grid;
+        return i >= 0 && i < grid.size() && j >= 0 && j < grid.at(i).size();
+    }
 
-        int dx[] = {-1, -1, -1, 0, 1, 1,  1,  0};
-        int dy[] = {-1,  0,  1, 1, 1, 0, -1, -1};
+    // The rabbit a wolf eats: the first one around it in the dx/dy order, -1 direction if there is none
+    int FindPrey(const std::vector<std::vector<CellState>>& grid, int i, int j)
+    {
+        for (int dir = 0; dir < 8; dir++)
+        {
+            const int ni = i + dx[dir];
+            const int nj = j + dy[dir];
+
+            if (IsInside(grid, ni, nj) && grid.at(ni).at(nj) == CellState::RABBIT)
+            {
+                return dir;
+            }
+        }
 
-#pragma omp parallel for shared(newGrid, dx, dy)
-        for (int i = 0; i < newGrid.size(); i++)
+        return -1;
+    }
+
+    // Decided from the rabbit's side, so a thread only ever writes its own cells
+    bool IsEaten(const std::vector<std::vector<CellState>>& grid, int i, int j)
+    {
+        for (int dir = 0; dir < 8; dir++)
         {
-            for (int j = 0; j < newGrid.at(i).size(); j++)
+            const int ni = i + dx[dir];
+            const int nj = j + dy[dir];
+
+            if (IsInside(grid, ni, nj) && grid.at(ni).at(nj) == CellState::WOLF)
             {
-                int rabbitsAround = 0;
-                int wolvesAround = 0;
+                const int prey = FindPrey(grid, ni, nj);
 
-                for (int dir = 0; dir < 8; dir++)
+                if (ni + dx[prey] == i && nj + dy[prey] == j)
                 {
-                    int ni = i + dx[dir];
-                    int nj = j + dy[dir];
-
-                    if (ni >= 0 && ni < newGrid.size() && nj >= 0 && nj < newGrid.at(ni).size())
-                    {
-                        if (newGrid.at(ni).at(nj) == CellState::RABBIT)
-                        {
-                            rabbitsAround++;
-                        }
-                        else if (newGrid.at(ni).at(nj) == CellState::WOLF)
-                        {
-                            wolvesAround++;
-                        }
-                    }
+                    return true;
                 }
+            }
+        }
 
-                // Apply the rules
-                if (newGrid.at(i).at(j) == CellState::WOLF)
+        return false;
+    }
+
+    // Every cell is decided from the previous generation only and written to the next one, so the result does
+    // not depend on how rows are split between threads or in which order they run
+    void Simulate(std::vector<std::vector<CellState>>& grid, thread::team& team)
+    {
+        std::vector<std::vector<CellState>> newGrid = grid;
+
+        // A contiguous block of rows per team member, one dispatch per generation
+        team.run(
+                [&](uint32_t index, uint32_t size)
                 {
-                    if (rabbitsAround > 0)
+                    const auto rows = grid.size();
+
+                    const auto first = static_cast<int>(rows * index / size);
+                    const auto last = static_cast<int>(rows * (index + 1) / size);
+
+                    for (int i = first; i < last; i++)
                     {
-                        for (int dir = 0; dir < 8; dir++)
+                        for (int j = 0; j < grid.at(i).size(); j++)
                         {
-                            int ni = i + dx[dir];
-                            int nj = j + dy[dir];
+                            int rabbitsAround = 0;
+                            int wolvesAround = 0;
+
+                            for (int dir = 0; dir < 8; dir++)
+                            {
+                                int ni = i + dx[dir];
+                                int nj = j + dy[dir];
+
+                                if (IsInside(grid, ni, nj))
+                                {
+                                    if (grid.at(ni).at(nj) == CellState::RABBIT)
+                                    {
+                                        rabbitsAround++;
+                                    }
+                                    else if (grid.at(ni).at(nj) == CellState::WOLF)
+                                    {
+                                        wolvesAround++;
+                                    }
+                                }
+                            }
 
-                            if (ni >= 0 && ni < newGrid.size() && nj >= 0 && nj < newGrid.at(ni).size())
+                            // Apply the rules
+                            if (grid.at(i).at(j) == CellState::WOLF)
                             {
-                                if (newGrid.at(ni).at(nj) == CellState::RABBIT)
+                                // A wolf with a rabbit around eats it and lives on
+                                if (rabbitsAround == 0 && (wolvesAround < 2 || wolvesAround > 3))
+                                {
+                                    // Wolf dies due to loneliness or overcrowding
+                                    newGrid.at(i).at(j) = CellState::NONE;
+                                }
+                            }
+                            else if (grid.at(i).at(j) == CellState::RABBIT)
+                            {
+                                if (IsEaten(grid, i, j))
                                 {
                                     // Wolf eats a rabbit
-                                    newGrid.at(ni).at(nj) = CellState::NONE;
-                                    break;
+                                    newGrid.at(i).at(j) = CellState::NONE;
+                                }
+                                else if (rabbitsAround < 2 || rabbitsAround > 4)
+                                {
+                                    // Rabbit dies due to loneliness or overcrowding
+                                    newGrid.at(i).at(j) = CellState::NONE;
+                                }
+                            }
+                            else
+                            {
+                                // Empty cell
+                                if (rabbitsAround == 3)
+                                {
+                                    // Cell becomes a rabbit
+                                    newGrid.at(i).at(j) = CellState::RABBIT;
+                                }
+                                else if (wolvesAround == 3)
+                                {
+                                    // Cell becomes a wolf
+                                    newGrid.at(i).at(j) = CellState::WOLF;
                                 }
                             }
                         }
                     }
-                    else if (wolvesAround < 2 || wolvesAround > 3)
-                    {
-                        // Wolf dies due to loneliness or overcrowding
-                        newGrid.at(i).at(j) = CellState::NONE;
-                    }
-                }
-                else if (newGrid.at(i).at(j) == CellState::RABBIT)
-                {
-                    if (rabbitsAround < 2 || rabbitsAround > 4)
-                    {
-                        // Rabbit dies due to loneliness or overcrowding
-                        newGrid.at(i).at(j) = CellState::NONE;
-                    }
-                }
-                else
-                {
-                    // Empty cell
-                    if (rabbitsAround == 3)
-                    {
-                        // Cell becomes a rabbit
-                        newGrid.at(i).at(j) = CellState::RABBIT;
-                    }
-                    else if (wolvesAround == 3)
-                    {
-                        // Cell becomes a wolf
-                        newGrid.at(i).at(j) = CellState::WOLF;
-                    }
-                }
+                });
+
+        grid = std::move(newGrid);
+    }
+
+    // Only ever touched on the main thread, the simulation hops over to it to exchange grids
+    std::vector<std::vector<CellState>> grid;
+    bool isTestGridDirty = false;
+
+    // Published by the UI when the delay changes, the simulation reads it once per step
+    struct SimulationParameters
+    {
+        int delay_ms = 5;
+    };
+
+    // Published by the simulation after every step, the UI shows the latest one each frame
+    struct SimulationReport
+    {
+        double step_seconds = 0.0;
+        uint64_t steps = 0;
+
+        int wolves = 0;
+        int rabbits = 0;
+    };
+
+    concurrent::seqlock<SimulationParameters> simulation_parameters;
+    concurrent::seqlock<SimulationReport> simulation_report;
+
+    SimulationReport CountPopulation(const std::vector<std::vector<CellState>>& cells)
+    {
+        SimulationReport report;
+
+        for (const auto& row : cells)
+        {
+            for (const auto cell : row)
+            {
+                report.wolves += cell == CellState::WOLF ? 1 : 0;
+                report.rabbits += cell == CellState::RABBIT ? 1 : 0;
             }
         }
 
-        grid = newGrid;
+        return report;
     }
 
-    mutex::winmutex grid_sync;
-    thread::winthread test_thread;
-
-    std::vector<std::vector<CellState>> grid;
-    std::vector<std::vector<CellState>> test_thread_grid;
+    std::stop_source simulation_stop;
+    thread::future<void> simulation;
 
-    std::atomic<int> simulationDelayAtomic { 5 };
-    std::atomic<double> simulationExecutionTime { 0.0 };
+    // Rebuilt by "Update threads count" (which also applies the pinning), disabled while the simulation runs
+    std::unique_ptr<thread::team> simulation_team;
 
-    std::atomic<bool> isTestGridDirty { false };
-    std::atomic<bool> isSimulationActiveAtomic { false };
+    bool IsSimulationRunning()
+    {
+        return simulation.is_valid() && !simulation.is_ready();
+    }
 
-    void UpdateMainThreadGrid(const std::vector<std::vector<CellState>>& updated)
+    // Steps run as pool jobs, the grid is published from the main thread between frames and the delay is a
+    // timer, so no thread is parked for the lifetime of the simulation
+    thread::task<void> SimulationLoop(std::stop_token stop_token)
     {
-        grid_sync.lock();
-        grid = updated;
-        grid_sync.unlock();
+        // Lives in the coroutine frame: the UI keeps its low refresh rate until the simulation is stopped
+        core::FramePacer::JobScope job;
+
+        auto local_grid = grid;
+        uint64_t steps = 0;
+
+        while (!stop_token.stop_requested())
+        {
+            co_await thread::resume_on(thread::pool::shared());
+
+            // Zones cannot span a co_await, the coroutine may come back on another thread. A flow arrow links
+            // the step to the main thread frame that publishes it instead
+            const auto publish_flow = trace::new_flow_id();
+
+            {
+                trace::zone _("Simulation step");
+
+                const auto start_time = core::Clock::Seconds();
+                if (!simulation_team)
+                {
+                    simulation_team = std::make_unique<thread::team>(omp_get_max_threads(), ui::GetPinPolicy());
+                }
+
+                Simulate(local_grid, *simulation_team);
+                const auto step_seconds = core::Clock::Seconds() - start_time;
+
+                auto report = CountPopulation(local_grid);
+                report.step_seconds = step_seconds;
+                report.steps = ++steps;
+
+                simulation_report.publish(report);
+
+                trace::counter("Wolves", static_cast<double>(report.wolves));
+                trace::counter("Rabbits", static_cast<double>(report.rabbits));
+                trace::flow_begin("Publish grid", publish_flow);
+            }
+
+            co_await thread::resume_on_main();
+
+            {
+                trace::zone _("Publish grid");
+                trace::flow_end("Publish grid", publish_flow);
+
+                // Edits made while the step ran win over it
+                if (isTestGridDirty)
+                {
+                    local_grid = grid;
+                    isTestGridDirty = false;
+                }
+                else
+                {
+                    grid = local_grid;
+                }
+            }
+
+            co_await thread::delay(std::chrono::milliseconds(simulation_parameters.load().delay_ms));
+        }
     }
 }
 
@@ -228,10 +376,12 @@ void ImGUILayer::OnAttach()
 
 bool ImGUILayer::OnUpdate(ts delta)
 {
-    for (const auto& event : m_window->PollEvents())
-    {
-        core::EventsPoll::AddEvent(event);
-    }
+    // Sleeps until input, a finished job or the next low rate refresh, see core::FramePacer
+    auto& pacer = core::FramePacer::Get();
+    const auto events = m_window->PollEvents(pacer.GetWaitTimeout());
+    pacer.BeginFrame(events);
+
+    core::EventBus::Get().PostAll(events);
 
     ImGui_ImplDX11_NewFrame();
     ImGui_ImplSDL2_NewFrame();
@@ -266,6 +416,7 @@ bool ImGUILayer::OnUpdate(ts delta)
     }
 
     m_window->GetDirectXSwapChain()->Present(0, 0);
+    pacer.EndFrame();
 
     return true;
 }
@@ -281,9 +432,17 @@ bool ImGUILayer::OnEvent(const core::Event &event)
 
     if (event.type == SDL_QUIT)
     {
-        if (test_thread.is_running())
+        // One simulation step plus the delay at most. The loop finishes by hopping to the main thread, so keep
+        // draining the queue while waiting for it
+        if (IsSimulationRunning())
         {
-            test_thread.terminate();
+            simulation_stop.request_stop();
+
+            while (!simulation.is_ready())
+            {
+                thread::main_thread_queue::shared().drain();
+                std::this_thread::yield();
+            }
         }
 
         return false;
@@ -311,14 +470,16 @@ void ImGUILayer::Render()
     static CellState currentBrush = CellState::WOLF;
 
     ImGui::Begin("Wolf v Rabbit");
-    start_time = omp_get_wtime();
+    start_time = core::Clock::Seconds();
 
     ImGui::DragInt("Threads count", &threads, 0.05F, 1, omp_get_max_threads());
-    if (DrawButtonConditionally("Update threads count", test_thread.is_running() && threads > 0
+    if (DrawButtonConditionally("Update threads count", IsSimulationRunning() && threads > 0
             , threads > 0 ? "Better not to change this while test is running" : "Incorrect amount of threads"))
     {
         omp_set_num_threads(threads);
+        simulation_team = std::make_unique<thread::team>(threads, ui::GetPinPolicy());
     }
+    ui::DrawPinningCombo();
 
     ImGui::SliderInt("Brush Size", &brushSize, 1, 20);
 
@@ -373,6 +534,8 @@ void ImGUILayer::Render()
 
     if (ImGui::Button("Clear"))
     {
+        isTestGridDirty = true;
+
         for (auto& row : grid)
         {
             for (auto& cell : row)
@@ -391,7 +554,7 @@ void ImGUILayer::Render()
 
     float total_cell_size = cell_size + cell_spacing;
 
-    int simulationDelay = simulationDelayAtomic.load();
+    auto parameters = simulation_parameters.load();
     ImGui::DragInt("Grid size: ", &gridSize, 0.05F, 1);
     if (DrawButtonConditionally("100x100", gridSize == 100, "Already the selected size"))
     {
@@ -416,9 +579,11 @@ void ImGUILayer::Render()
         gridSize = 800;
     }
 
-    ImGui::DragInt("Simulation delay: ", &simulationDelay, 0.05F, 1);
-
-    simulationDelayAtomic = std::max(simulationDelay, 0);
+    if (ImGui::DragInt("Simulation delay: ", &parameters.delay_ms, 0.05F, 1))
+    {
+        parameters.delay_ms = std::max(parameters.delay_ms, 0);
+        simulation_parameters.publish(parameters);
+    }
 
     ImVec2 mousePos = ImGui::GetMousePos();
     bool isMouseDown = ImGui::IsMouseDown(0);
@@ -428,47 +593,16 @@ void ImGUILayer::Render()
     grid_window_size.x = ImGui::GetContentRegionMax().x;
     grid_window_size.y = total_cell_size * static_cast<float>(gridSize);
 
-    if (ImGui::Button("Simulate"))
+    if (DrawButtonConditionally("Simulate", IsSimulationRunning(), "Simulation is already running"))
     {
-        isSimulationActiveAtomic = true;
-        test_thread.run(
-            [=]()
-            {
-                while(isSimulationActiveAtomic.load())
-                {
-                    static auto local_grid = grid;
-
-                    if (isTestGridDirty.load())
-                    {
-                        grid_sync.lock();
-
-                        local_grid = grid;
-                        isTestGridDirty = false;
-
-                        grid_sync.unlock();
-                    }
-
-                    const auto start_time = omp_get_wtime();
-                    Simulate(local_grid);
-                    simulationExecutionTime = omp_get_wtime() - start_time;
-
-                    if (simulationDelayAtomic.load() > 0)
-                    {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(simulationDelayAtomic.load()));
-                    }
-
-                     if (!isTestGridDirty.load())
-                     {
-                         UpdateMainThreadGrid(local_grid);
-                     }
-                }
-            });
+        simulation_stop = std::stop_source();
+        simulation = thread::spawn(SimulationLoop(simulation_stop.get_token()));
     }
 
     ImGui::SameLine();
-    if (DrawButtonConditionally("Stop", !test_thread.is_running(), "Simulation was not started"))
+    if (DrawButtonConditionally("Stop", !IsSimulationRunning(), "Simulation was not started"))
     {
-        isSimulationActiveAtomic = false;
+        simulation_stop.request_stop();
     }
 
     float totalGridWidth = total_cell_size * static_cast<float>(gridSize);
@@ -534,14 +668,21 @@ void ImGUILayer::Render()
 
     ImGui::EndChild();
 
-    tick = omp_get_wtick();
-    end_time = omp_get_wtime();
+    tick = core::Clock::Resolution();
+    end_time = core::Clock::Seconds();
 
-    DisplayBoolColored("Is simulation thread running", test_thread.is_running());
+    DisplayBoolColored("Is simulation running", IsSimulationRunning());
 
     ImGui::Text("Timer precision %lf\n", tick);
-    ImGui::Text("Per-Cycle simulation time, in ms %lf\n", simulationExecutionTime.load() * 1000.0);
+    const auto report = simulation_report.load();
+
+    ImGui::Text("Per-Cycle simulation time, in ms %lf\n", report.step_seconds * 1000.0);
+    ImGui::Text("Steps simulated: %llu, wolves: %d, rabbits: %d", static_cast<unsigned long long>(report.steps), report.wolves, report.rabbits);
     ImGui::Text("Render time (including operations), in ms %lf\n", (end_time - start_time) * 1000.0);
 
     ImGui::End();
+
+    ui::RenderLockProfilerPanel();
+    ui::RenderFramePacingPanel();
+    ui::RenderTracePanel();
 }
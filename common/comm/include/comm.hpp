@@ -0,0 +1,186 @@
+#pragma once
+
+#include <process.hpp>
+#include <transport.hpp>
+
+#include <span>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace retro::comm
+{
+    struct launch_options
+    {
+        // Ranks in the run, the launching process included
+        int processes = 4;
+
+        transport_kind kind = transport_kind::shared_memory;
+
+        // Per ordered pair of ranks, shared memory only. A power of two
+        size_t ring_capacity = 256 * 1024;
+
+        // Empty for the running executable, the usual SPMD setup
+        std::string executable;
+
+        // Passed to every worker ahead of the ones attach() looks for
+        std::vector<std::string> arguments;
+    };
+
+    // Applies the reduction to count elements: inout[i] = op(inout[i], in[i]). pOp is the caller's operator
+    using combine_invoker = void (*)(const void * pOp, void * pInOut, const void * pIn, size_t count);
+
+    // One rank's end of a run: point to point transfers and the collectives built on them. Every rank calls the
+    // same collective with the same root and element count, like MPI.
+    //
+    // The collectives are the textbook ones: broadcast and reduce go down / up a binomial tree rooted at the
+    // root (log2(size) rounds), allreduce is a reduce followed by a broadcast, scatter and gather are linear
+    // through the root, barrier is a dissemination barrier
+    class communicator
+    {
+    public:
+
+        explicit communicator(std::unique_ptr<transport> link, std::vector<process> workers = { });
+
+        // On rank 0 this waits for the workers to exit
+        ~communicator();
+
+        communicator(const communicator&) = delete;
+
+        communicator& operator=(const communicator&) = delete;
+
+        [[nodiscard]] int rank() const;
+
+        [[nodiscard]] int size() const;
+
+        [[nodiscard]] transport_kind kind() const;
+
+        template<typename T>
+        void send(int peer, std::span<const T> data)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be sent");
+            send_bytes(peer, data.data(), data.size_bytes());
+        }
+
+        template<typename T>
+        void recv(int peer, std::span<T> data)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be received");
+            recv_bytes(peer, data.data(), data.size_bytes());
+        }
+
+        void barrier();
+
+        // data is the input on the root and the output everywhere else
+        template<typename T>
+        void broadcast(std::span<T> data, int root = 0)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be broadcast");
+            broadcast_bytes(data.data(), data.size_bytes(), root);
+        }
+
+        // output only matters on the root, op has to be associative and commutative: the tree combines in
+        // whatever order the ranks arrive in
+        template<typename T, typename Op>
+        void reduce(std::span<const T> input, std::span<T> output, Op&& op, int root = 0)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be reduced");
+
+            if (rank() == root && output.size() != input.size())
+            {
+                throw std::runtime_error("Error: Reduce output has to be as long as the input");
+            }
+
+            reduce_bytes(input.data(), output.data(), input.size(), sizeof(T), &combine<T, std::remove_reference_t<Op>>, &op, root);
+        }
+
+        template<typename T, typename Op>
+        void allreduce(std::span<const T> input, std::span<T> output, Op&& op)
+        {
+            if (output.size() != input.size())
+            {
+                throw std::runtime_error("Error: Allreduce output has to be as long as the input");
+            }
+
+            reduce(input, output, op, 0);
+            broadcast(output, 0);
+        }
+
+        // The root hands output.size() elements to every rank, itself included; input is size() times that
+        template<typename T>
+        void scatter(std::span<const T> input, std::span<T> output, int root = 0)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be scattered");
+
+            if (rank() == root && input.size() != output.size() * static_cast<size_t>(size()))
+            {
+                throw std::runtime_error("Error: Scatter input has to hold a block per rank");
+            }
+
+            scatter_bytes(input.data(), output.data(), output.size_bytes(), root);
+        }
+
+        // The reverse: output on the root is size() blocks of input.size() elements, in rank order
+        template<typename T>
+        void gather(std::span<const T> input, std::span<T> output, int root = 0)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be gathered");
+
+            if (rank() == root && output.size() != input.size() * static_cast<size_t>(size()))
+            {
+                throw std::runtime_error("Error: Gather output has to hold a block per rank");
+            }
+
+            gather_bytes(input.data(), output.data(), input.size_bytes(), root);
+        }
+
+        void send_bytes(int peer, const void * pData, size_t size);
+
+        void recv_bytes(int peer, void * pData, size_t size);
+
+        void broadcast_bytes(void * pData, size_t size, int root);
+
+        void reduce_bytes(const void * pInput, void * pOutput, size_t count, size_t element_size, combine_invoker invoke, const void * pOp, int root);
+
+        void scatter_bytes(const void * pInput, void * pOutput, size_t block_size, int root);
+
+        void gather_bytes(const void * pInput, void * pOutput, size_t block_size, int root);
+
+    private:
+
+        template<typename T, typename Op>
+        static void combine(const void * pOp, void * pInOut, const void * pIn, size_t count)
+        {
+            const auto& op = *static_cast<const Op *>(pOp);
+
+            auto * pTarget = static_cast<T *>(pInOut);
+            const auto * pSource = static_cast<const T *>(pIn);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                pTarget[i] = op(pTarget[i], pSource[i]);
+            }
+        }
+
+        // Turns a rank into its position in a tree rooted at root, and back
+        [[nodiscard]] int to_relative(int peer, int root) const;
+
+        [[nodiscard]] int to_absolute(int relative, int root) const;
+
+        std::unique_ptr<transport> m_link;
+
+        std::vector<process> m_workers;
+
+    };
+
+    // Makes the calling process rank 0 of a new run and starts ranks 1 .. processes - 1 as child processes.
+    // The workers find their place in the run through attach()
+    std::unique_ptr<communicator> launch(const launch_options& options);
+
+    // Worker side of launch(), call it first thing in main(). Returns null when the process was not started
+    // as a worker, so the same executable can run both roles
+    std::unique_ptr<communicator> attach(int argc, char ** argv);
+}
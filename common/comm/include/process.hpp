@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace retro::comm
+{
+    // Child process started from an executable path. Destroying a process that is still running waits for it,
+    // so a worker is never left behind
+    class process
+    {
+    public:
+
+        process() = default;
+
+        process(const std::string& executable, const std::vector<std::string>& arguments);
+
+        process(process&& other) noexcept;
+
+        process& operator=(process&& other) noexcept;
+
+        ~process();
+
+        process(const process&) = delete;
+
+        process& operator=(const process&) = delete;
+
+        // Blocks until the process exits, returns its exit code. A process that was already waited for returns
+        // the same code again
+        int wait();
+
+        [[nodiscard]] bool is_started() const;
+
+        // Path of the running executable, what the launcher starts its workers from
+        static std::string current_executable();
+
+        static uint32_t current_id();
+
+    private:
+
+        void release();
+
+        int m_exit_code { 0 };
+        bool m_is_waited { false };
+
+#if defined(_WIN32) || defined(WIN32)
+        // Process HANDLE
+        void * m_hProcess { nullptr };
+#else
+        int m_pid { 0 };
+#endif
+
+    };
+}
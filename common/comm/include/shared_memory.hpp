@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace retro::comm
+{
+    // Named memory segment mapped into every process that opens it. The creator owns the name: the segment
+    // goes away once the creator and everybody who opened it have unmapped it. Freshly created segments are
+    // zero filled
+    class shared_memory
+    {
+    public:
+
+        shared_memory(const std::string& name, size_t size, bool create);
+
+        ~shared_memory();
+
+        shared_memory(const shared_memory&) = delete;
+
+        shared_memory& operator=(const shared_memory&) = delete;
+
+        [[nodiscard]] void * data() const
+        {
+            return m_pData;
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            return m_size;
+        }
+
+    private:
+
+        std::string m_name;
+
+        void * m_pData { nullptr };
+        size_t m_size { 0 };
+
+        bool m_is_owner { false };
+
+#if defined(_WIN32) || defined(WIN32)
+        // File mapping HANDLE, kept opaque to keep windows.h out of the header
+        void * m_hMapping { nullptr };
+#endif
+
+    };
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cpu.hpp>
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace retro::comm
+{
+    // Single producer single consumer byte ring placed in shared memory, one per ordered pair of ranks. It is
+    // a stream: a message bigger than the ring simply flows through in pieces while the reader drains it.
+    //
+    // Neither futex(2) private waits nor WaitOnAddress work across processes, so a blocked side spins and
+    // then yields (sync::backoff). That is the right trade for one worker process per core, wrong for many
+    class shm_ring
+    {
+        // Both counters only ever grow, their difference is the fill level. Each lives on its own line, the
+        // producer writes one and the consumer the other
+        struct header
+        {
+            alignas(sync::cache_line_size) std::atomic<uint64_t> head;
+            alignas(sync::cache_line_size) std::atomic<uint64_t> tail;
+        };
+
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "The ring counters have to be lock-free to work across processes");
+
+    public:
+
+        // Bytes of shared memory a ring of the given capacity takes, a multiple of the cache line size
+        static size_t footprint(size_t capacity)
+        {
+            return sizeof(header) + capacity;
+        }
+
+        // pMemory points at footprint(capacity) bytes of zero filled shared memory, capacity is a power of two
+        shm_ring(void * pMemory, size_t capacity)
+            : m_header(static_cast<header *>(pMemory))
+            , m_data(static_cast<unsigned char *>(pMemory) + sizeof(header))
+            , m_capacity(capacity)
+        {
+            if (!std::has_single_bit(capacity))
+            {
+                throw std::runtime_error("Error: Ring capacity has to be a power of two");
+            }
+        }
+
+        void write(const void * pData, size_t size)
+        {
+            auto * pBytes = static_cast<const unsigned char *>(pData);
+            auto tail = m_header->tail.load(std::memory_order_relaxed);
+
+            while (size > 0)
+            {
+                const auto used = tail - wait_for(m_header->head, [&](uint64_t head) { return tail - head < m_capacity; });
+
+                const auto offset = static_cast<size_t>(tail & (m_capacity - 1));
+                const auto chunk = std::min({ size, m_capacity - static_cast<size_t>(used), m_capacity - offset });
+
+                std::memcpy(m_data + offset, pBytes, chunk);
+
+                tail += chunk;
+                pBytes += chunk;
+                size -= chunk;
+
+                m_header->tail.store(tail, std::memory_order_release);
+            }
+        }
+
+        void read(void * pData, size_t size)
+        {
+            auto * pBytes = static_cast<unsigned char *>(pData);
+            auto head = m_header->head.load(std::memory_order_relaxed);
+
+            while (size > 0)
+            {
+                const auto available = wait_for(m_header->tail, [&](uint64_t tail) { return tail != head; }) - head;
+
+                const auto offset = static_cast<size_t>(head & (m_capacity - 1));
+                const auto chunk = std::min({ size, static_cast<size_t>(available), m_capacity - offset });
+
+                std::memcpy(pBytes, m_data + offset, chunk);
+
+                head += chunk;
+                pBytes += chunk;
+                size -= chunk;
+
+                m_header->head.store(head, std::memory_order_release);
+            }
+        }
+
+    private:
+
+        // Spins on the other side's counter until ready(value) holds, returns that value
+        template<typename Ready>
+        static uint64_t wait_for(const std::atomic<uint64_t>& counter, Ready&& ready)
+        {
+            sync::backoff wait;
+
+            auto value = counter.load(std::memory_order_acquire);
+
+            while (!ready(value))
+            {
+                wait.pause();
+                value = counter.load(std::memory_order_acquire);
+            }
+
+            return value;
+        }
+
+        header * m_header;
+        unsigned char * m_data;
+
+        size_t m_capacity;
+
+    };
+}
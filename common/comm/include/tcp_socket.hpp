@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace retro::comm
+{
+    // Blocking TCP socket bound to the loopback interface. Only what the TCP transport needs: listen on a
+    // free port, accept, connect, and send/receive exact byte counts
+    class tcp_socket
+    {
+    public:
+
+        tcp_socket() = default;
+
+        tcp_socket(tcp_socket&& other) noexcept;
+
+        tcp_socket& operator=(tcp_socket&& other) noexcept;
+
+        ~tcp_socket();
+
+        tcp_socket(const tcp_socket&) = delete;
+
+        tcp_socket& operator=(const tcp_socket&) = delete;
+
+        // Listens on 127.0.0.1 at a port picked by the system, see port()
+        static tcp_socket listen(int backlog);
+
+        static tcp_socket connect(uint16_t port);
+
+        [[nodiscard]] tcp_socket accept() const;
+
+        // Blocks until all of it went out / came in. Throws if the peer is gone
+        void send_all(const void * pData, size_t size) const;
+
+        void recv_all(void * pData, size_t size) const;
+
+        [[nodiscard]] uint16_t port() const;
+
+        [[nodiscard]] bool is_open() const;
+
+    private:
+
+        void close();
+
+#if defined(_WIN32) || defined(WIN32)
+        // SOCKET, an UINT_PTR; kept as an integer to keep winsock2.h out of the header
+        uintptr_t m_socket { ~static_cast<uintptr_t>(0) };
+#else
+        int m_socket { -1 };
+#endif
+
+    };
+}
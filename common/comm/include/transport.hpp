@@ -0,0 +1,135 @@
+#pragma once
+
+#include <shm_ring.hpp>
+#include <tcp_socket.hpp>
+#include <shared_memory.hpp>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace retro::comm
+{
+    enum class transport_kind
+    {
+        shared_memory,
+        tcp
+    };
+
+    constexpr std::array<const char *, 2> transport_names = { "Shared memory", "Loopback TCP" };
+
+    // Moves bytes between the ranks of one run. Every ordered pair of ranks is an independent stream: bytes
+    // sent from a to b arrive at b in order, and recv() takes exactly as many as asked for, so message
+    // boundaries are whatever sender and receiver agree on.
+    //
+    // send() only returns once the bytes are buffered (the ring, or the socket buffer), so two ranks sending
+    // each other more than that at the same time deadlock. The collectives never do it
+    class transport
+    {
+    public:
+
+        virtual ~transport() = default;
+
+        virtual void send(int peer, const void * pData, size_t size) = 0;
+
+        virtual void recv(int peer, void * pData, size_t size) = 0;
+
+        [[nodiscard]] virtual int rank() const = 0;
+
+        [[nodiscard]] virtual int size() const = 0;
+
+        [[nodiscard]] virtual transport_kind kind() const = 0;
+    };
+
+    // One shm_ring per ordered pair of ranks in a single segment. Rank 0 creates the segment before starting
+    // the workers, they open it by name
+    class shm_transport final : public transport
+    {
+    public:
+
+        shm_transport(const std::string& session, int rank, int size, size_t ring_capacity);
+
+        void send(int peer, const void * pData, size_t size) override;
+
+        void recv(int peer, void * pData, size_t size) override;
+
+        [[nodiscard]] int rank() const override
+        {
+            return m_rank;
+        }
+
+        [[nodiscard]] int size() const override
+        {
+            return m_size;
+        }
+
+        [[nodiscard]] transport_kind kind() const override
+        {
+            return transport_kind::shared_memory;
+        }
+
+    private:
+
+        shm_ring& ring(int from, int to);
+
+        int m_rank;
+        int m_size;
+
+        shared_memory m_segment;
+
+        // size * size rings, from-major; the diagonal is never used
+        std::vector<shm_ring> m_rings;
+
+    };
+
+    // A socket per pair of ranks over loopback, the stand-in for ranks on different machines. Rank 0 listens
+    // first and hands its port to the workers, everybody then connects to the ranks below it
+    class tcp_transport final : public transport
+    {
+    public:
+
+        // Rank 0 side, in two steps: the listener has to exist before the workers start, connect() needs them
+        // running
+        explicit tcp_transport(int size);
+
+        [[nodiscard]] uint16_t port() const;
+
+        void connect();
+
+        // Worker side, connects right away
+        tcp_transport(int rank, int size, uint16_t root_port);
+
+        void send(int peer, const void * pData, size_t size) override;
+
+        void recv(int peer, void * pData, size_t size) override;
+
+        [[nodiscard]] int rank() const override
+        {
+            return m_rank;
+        }
+
+        [[nodiscard]] int size() const override
+        {
+            return m_size;
+        }
+
+        [[nodiscard]] transport_kind kind() const override
+        {
+            return transport_kind::tcp;
+        }
+
+    private:
+
+        int m_rank;
+        int m_size;
+
+        tcp_socket m_listener;
+
+        // Indexed by peer rank, the own slot stays closed
+        std::vector<tcp_socket> m_peers;
+
+    };
+}
@@ -0,0 +1,340 @@
+#include <comm.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <utility>
+#include <optional>
+#include <string_view>
+
+using namespace retro::comm;
+
+namespace
+{
+    // What launch() passes to a worker on top of the caller's arguments
+    constexpr std::string_view rank_argument = "--retro-comm-rank=";
+    constexpr std::string_view size_argument = "--retro-comm-size=";
+    constexpr std::string_view transport_argument = "--retro-comm-transport=";
+    constexpr std::string_view session_argument = "--retro-comm-session=";
+    constexpr std::string_view capacity_argument = "--retro-comm-capacity=";
+    constexpr std::string_view port_argument = "--retro-comm-port=";
+
+    std::optional<std::string> find_argument(int argc, char ** argv, std::string_view key)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string_view argument(argv[i]);
+
+            if (argument.starts_with(key))
+            {
+                return std::string(argument.substr(key.size()));
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::string require_argument(int argc, char ** argv, std::string_view key)
+    {
+        auto value = find_argument(argc, argv, key);
+
+        if (!value)
+        {
+            throw std::runtime_error("Error: Worker started without " + std::string(key));
+        }
+
+        return *value;
+    }
+
+    // Unique per launch() on this machine, shared memory names are global
+    std::string make_session_name()
+    {
+        static std::atomic<uint32_t> counter { 0 };
+
+        return "retro-comm-" + std::to_string(process::current_id()) + "-" + std::to_string(counter.fetch_add(1));
+    }
+
+    const char * to_argument(transport_kind kind)
+    {
+        return kind == transport_kind::tcp ? "tcp" : "shm";
+    }
+}
+
+communicator::communicator(std::unique_ptr<transport> link, std::vector<process> workers)
+    : m_link(std::move(link))
+    , m_workers(std::move(workers))
+{
+    if (!m_link)
+    {
+        throw std::runtime_error("Error: Communicator needs a transport");
+    }
+}
+
+communicator::~communicator()
+{
+    // Closing the transport first: a worker stuck on a dead peer socket gets an error instead of hanging the wait
+    m_link.reset();
+
+    for (auto& worker : m_workers)
+    {
+        worker.wait();
+    }
+}
+
+int communicator::rank() const
+{
+    return m_link->rank();
+}
+
+int communicator::size() const
+{
+    return m_link->size();
+}
+
+transport_kind communicator::kind() const
+{
+    return m_link->kind();
+}
+
+void communicator::send_bytes(int peer, const void * pData, size_t size)
+{
+    if (peer < 0 || peer >= this->size() || peer == rank())
+    {
+        throw std::runtime_error("Error: Invalid peer rank");
+    }
+
+    m_link->send(peer, pData, size);
+}
+
+void communicator::recv_bytes(int peer, void * pData, size_t size)
+{
+    if (peer < 0 || peer >= this->size() || peer == rank())
+    {
+        throw std::runtime_error("Error: Invalid peer rank");
+    }
+
+    m_link->recv(peer, pData, size);
+}
+
+int communicator::to_relative(int peer, int root) const
+{
+    return (peer - root + size()) % size();
+}
+
+int communicator::to_absolute(int relative, int root) const
+{
+    return (relative + root) % size();
+}
+
+void communicator::barrier()
+{
+    // Round k: tell the rank 2^k ahead we got here, wait for the one 2^k behind. After ceil(log2(size))
+    // rounds every rank has heard from every other one, directly or not
+    const char token = 0;
+
+    for (int distance = 1; distance < size(); distance <<= 1)
+    {
+        char received;
+
+        send_bytes((rank() + distance) % size(), &token, sizeof(token));
+        recv_bytes((rank() - distance + size()) % size(), &received, sizeof(received));
+    }
+}
+
+void communicator::broadcast_bytes(void * pData, size_t size, int root)
+{
+    const auto relative = to_relative(rank(), root);
+
+    // Wait for the parent: the rank that differs in the lowest set bit
+    int mask = 1;
+
+    while (mask < this->size())
+    {
+        if ((relative & mask) != 0)
+        {
+            recv_bytes(to_absolute(relative - mask, root), pData, size);
+            break;
+        }
+
+        mask <<= 1;
+    }
+
+    // Pass it on to the children below that bit, the farthest subtree first
+    for (mask >>= 1; mask > 0; mask >>= 1)
+    {
+        if (relative + mask < this->size())
+        {
+            send_bytes(to_absolute(relative + mask, root), pData, size);
+        }
+    }
+}
+
+void communicator::reduce_bytes(const void * pInput, void * pOutput, size_t count, size_t element_size, combine_invoker invoke, const void * pOp, int root)
+{
+    const auto relative = to_relative(rank(), root);
+    const auto bytes = count * element_size;
+
+    // Accumulates in place on the root, in a scratch copy elsewhere
+    std::vector<unsigned char> partial;
+    std::vector<unsigned char> incoming(bytes);
+
+    auto * pAccumulator = static_cast<unsigned char *>(pOutput);
+
+    if (rank() != root)
+    {
+        partial.resize(bytes);
+        pAccumulator = partial.data();
+    }
+
+    if (bytes > 0)
+    {
+        std::memcpy(pAccumulator, pInput, bytes);
+    }
+
+    // The mirror image of broadcast: collect from the children in the order they finish, then send the
+    // subtree's result to the parent
+    for (int mask = 1; mask < size(); mask <<= 1)
+    {
+        if ((relative & mask) != 0)
+        {
+            send_bytes(to_absolute(relative - mask, root), pAccumulator, bytes);
+            break;
+        }
+
+        if (relative + mask < size())
+        {
+            recv_bytes(to_absolute(relative + mask, root), incoming.data(), bytes);
+            invoke(pOp, pAccumulator, incoming.data(), count);
+        }
+    }
+}
+
+void communicator::scatter_bytes(const void * pInput, void * pOutput, size_t block_size, int root)
+{
+    if (rank() != root)
+    {
+        recv_bytes(root, pOutput, block_size);
+        return;
+    }
+
+    const auto * pBlocks = static_cast<const unsigned char *>(pInput);
+
+    for (int peer = 0; peer < size(); peer++)
+    {
+        const auto * pBlock = pBlocks + static_cast<size_t>(peer) * block_size;
+
+        if (peer == root)
+        {
+            std::memcpy(pOutput, pBlock, block_size);
+        }
+        else
+        {
+            send_bytes(peer, pBlock, block_size);
+        }
+    }
+}
+
+void communicator::gather_bytes(const void * pInput, void * pOutput, size_t block_size, int root)
+{
+    if (rank() != root)
+    {
+        send_bytes(root, pInput, block_size);
+        return;
+    }
+
+    auto * pBlocks = static_cast<unsigned char *>(pOutput);
+
+    for (int peer = 0; peer < size(); peer++)
+    {
+        auto * pBlock = pBlocks + static_cast<size_t>(peer) * block_size;
+
+        if (peer == root)
+        {
+            std::memcpy(pBlock, pInput, block_size);
+        }
+        else
+        {
+            recv_bytes(peer, pBlock, block_size);
+        }
+    }
+}
+
+std::unique_ptr<communicator> retro::comm::launch(const launch_options& options)
+{
+    if (options.processes < 1)
+    {
+        throw std::runtime_error("Error: A run needs at least one process");
+    }
+
+    const auto session = make_session_name();
+
+    // Declared first so it goes last if the handshake throws: the closed transport is what lets the workers
+    // give up before they are waited for
+    std::vector<process> workers;
+    workers.reserve(options.processes - 1);
+
+    std::unique_ptr<transport> link;
+    tcp_transport * pTcp = nullptr;
+
+    // The transport has to be ready for the workers before they start: the segment exists, the port listens
+    if (options.kind == transport_kind::shared_memory)
+    {
+        link = std::make_unique<shm_transport>(session, 0, options.processes, options.ring_capacity);
+    }
+    else
+    {
+        auto tcp = std::make_unique<tcp_transport>(options.processes);
+        pTcp = tcp.get();
+        link = std::move(tcp);
+    }
+
+    const auto executable = options.executable.empty() ? process::current_executable() : options.executable;
+
+    for (int rank = 1; rank < options.processes; rank++)
+    {
+        auto arguments = options.arguments;
+
+        arguments.push_back(std::string(rank_argument) + std::to_string(rank));
+        arguments.push_back(std::string(size_argument) + std::to_string(options.processes));
+        arguments.push_back(std::string(transport_argument) + to_argument(options.kind));
+        arguments.push_back(std::string(session_argument) + session);
+        arguments.push_back(std::string(capacity_argument) + std::to_string(options.ring_capacity));
+        arguments.push_back(std::string(port_argument) + std::to_string(pTcp != nullptr ? pTcp->port() : 0));
+
+        workers.emplace_back(executable, arguments);
+    }
+
+    if (pTcp != nullptr)
+    {
+        pTcp->connect();
+    }
+
+    return std::make_unique<communicator>(std::move(link), std::move(workers));
+}
+
+std::unique_ptr<communicator> retro::comm::attach(int argc, char ** argv)
+{
+    const auto rank_value = find_argument(argc, argv, rank_argument);
+
+    if (!rank_value)
+    {
+        return nullptr;
+    }
+
+    const auto rank = std::stoi(*rank_value);
+    const auto size = std::stoi(require_argument(argc, argv, size_argument));
+
+    std::unique_ptr<transport> link;
+
+    if (require_argument(argc, argv, transport_argument) == to_argument(transport_kind::tcp))
+    {
+        const auto port = static_cast<uint16_t>(std::stoul(require_argument(argc, argv, port_argument)));
+        link = std::make_unique<tcp_transport>(rank, size, port);
+    }
+    else
+    {
+        const auto capacity = static_cast<size_t>(std::stoull(require_argument(argc, argv, capacity_argument)));
+        link = std::make_unique<shm_transport>(require_argument(argc, argv, session_argument), rank, size, capacity);
+    }
+
+    return std::make_unique<communicator>(std::move(link));
+}
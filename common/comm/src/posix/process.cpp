@@ -0,0 +1,135 @@
+#include <process.hpp>
+
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <cerrno>
+#include <climits>
+#include <utility>
+#include <stdexcept>
+
+extern char ** environ;
+
+using namespace retro::comm;
+
+process::process(const std::string& executable, const std::vector<std::string>& arguments)
+{
+    std::vector<char *> argv;
+    argv.reserve(arguments.size() + 2);
+
+    argv.push_back(const_cast<char *>(executable.c_str()));
+
+    for (const auto& argument : arguments)
+    {
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    }
+
+    argv.push_back(nullptr);
+
+    pid_t pid = 0;
+
+    if (posix_spawn(&pid, executable.c_str(), nullptr, nullptr, argv.data(), environ) != 0)
+    {
+        throw std::runtime_error("Error: Failed to start " + executable);
+    }
+
+    m_pid = pid;
+}
+
+process::process(process&& other) noexcept
+    : m_exit_code(other.m_exit_code)
+    , m_is_waited(other.m_is_waited)
+    , m_pid(std::exchange(other.m_pid, 0))
+{
+}
+
+process& process::operator=(process&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+
+        m_exit_code = other.m_exit_code;
+        m_is_waited = other.m_is_waited;
+        m_pid = std::exchange(other.m_pid, 0);
+    }
+
+    return *this;
+}
+
+process::~process()
+{
+    release();
+}
+
+int process::wait()
+{
+    if (m_pid == 0)
+    {
+        throw std::runtime_error("Error: No process to wait for");
+    }
+
+    if (!m_is_waited)
+    {
+        int status = 0;
+
+        while (waitpid(m_pid, &status, 0) == -1)
+        {
+            if (errno != EINTR)
+            {
+                throw std::runtime_error("Error: Failed to wait for the process");
+            }
+        }
+
+        m_exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        m_is_waited = true;
+    }
+
+    return m_exit_code;
+}
+
+bool process::is_started() const
+{
+    return m_pid != 0;
+}
+
+std::string process::current_executable()
+{
+#if defined(__linux__)
+    char path[PATH_MAX];
+
+    const auto length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+
+    if (length <= 0)
+    {
+        throw std::runtime_error("Error: Failed to locate the running executable");
+    }
+
+    return std::string(path, static_cast<size_t>(length));
+#else
+    throw std::runtime_error("Error: Locating the running executable is not supported here, pass launch_options::executable");
+#endif
+}
+
+uint32_t process::current_id()
+{
+    return static_cast<uint32_t>(getpid());
+}
+
+void process::release()
+{
+    // Reaps the child as well, so it does not linger as a zombie
+    if (m_pid != 0 && !m_is_waited)
+    {
+        try
+        {
+            wait();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    m_pid = 0;
+}
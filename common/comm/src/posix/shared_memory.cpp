@@ -0,0 +1,61 @@
+#include <shared_memory.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <stdexcept>
+
+using namespace retro::comm;
+
+shared_memory::shared_memory(const std::string& name, size_t size, bool create)
+    : m_name("/" + name)
+    , m_size(size)
+    , m_is_owner(create)
+{
+    const auto descriptor = create
+            ? shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600)
+            : shm_open(m_name.c_str(), O_RDWR, 0);
+
+    if (descriptor == -1)
+    {
+        throw std::runtime_error("Error: Failed to open shared memory " + m_name);
+    }
+
+    // ftruncate zero fills
+    if (create && ftruncate(descriptor, static_cast<off_t>(size)) != 0)
+    {
+        ::close(descriptor);
+        shm_unlink(m_name.c_str());
+
+        throw std::runtime_error("Error: Failed to size shared memory " + m_name);
+    }
+
+    auto * pData = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+
+    // The mapping keeps the object alive, the descriptor is not needed anymore
+    ::close(descriptor);
+
+    if (pData == MAP_FAILED)
+    {
+        if (create)
+        {
+            shm_unlink(m_name.c_str());
+        }
+
+        throw std::runtime_error("Error: Failed to map shared memory " + m_name);
+    }
+
+    m_pData = pData;
+}
+
+shared_memory::~shared_memory()
+{
+    munmap(m_pData, m_size);
+
+    // Only the name goes away, processes that still have it mapped keep using it
+    if (m_is_owner)
+    {
+        shm_unlink(m_name.c_str());
+    }
+}
@@ -0,0 +1,197 @@
+#include <tcp_socket.hpp>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include <cerrno>
+#include <string>
+#include <utility>
+#include <stdexcept>
+
+using namespace retro::comm;
+
+namespace
+{
+#if defined(MSG_NOSIGNAL)
+    // A peer that went away must be an exception, not a SIGPIPE taking the whole process down
+    constexpr int send_flags = MSG_NOSIGNAL;
+#else
+    constexpr int send_flags = 0;
+#endif
+
+    sockaddr_in loopback(uint16_t port)
+    {
+        sockaddr_in address { };
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        return address;
+    }
+
+    // Messages are small and latency is what the benchmarks measure, Nagle would hold them back
+    void disable_nagle(int socket)
+    {
+        const int enable = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    }
+}
+
+tcp_socket::tcp_socket(tcp_socket&& other) noexcept
+    : m_socket(std::exchange(other.m_socket, -1))
+{
+}
+
+tcp_socket& tcp_socket::operator=(tcp_socket&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        m_socket = std::exchange(other.m_socket, -1);
+    }
+
+    return *this;
+}
+
+tcp_socket::~tcp_socket()
+{
+    close();
+}
+
+tcp_socket tcp_socket::listen(int backlog)
+{
+    tcp_socket result;
+    result.m_socket = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (result.m_socket == -1)
+    {
+        throw std::runtime_error("Error: Failed to create a socket");
+    }
+
+    const auto address = loopback(0);
+
+    if (bind(result.m_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || ::listen(result.m_socket, backlog) != 0)
+    {
+        throw std::runtime_error("Error: Failed to listen on the loopback interface");
+    }
+
+    return result;
+}
+
+tcp_socket tcp_socket::connect(uint16_t port)
+{
+    tcp_socket result;
+    result.m_socket = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (result.m_socket == -1)
+    {
+        throw std::runtime_error("Error: Failed to create a socket");
+    }
+
+    const auto address = loopback(port);
+
+    if (::connect(result.m_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        throw std::runtime_error("Error: Failed to connect to port " + std::to_string(port));
+    }
+
+    disable_nagle(result.m_socket);
+
+    return result;
+}
+
+tcp_socket tcp_socket::accept() const
+{
+    tcp_socket result;
+
+    do
+    {
+        result.m_socket = ::accept(m_socket, nullptr, nullptr);
+    }
+    while (result.m_socket == -1 && errno == EINTR);
+
+    if (result.m_socket == -1)
+    {
+        throw std::runtime_error("Error: Failed to accept a connection");
+    }
+
+    disable_nagle(result.m_socket);
+
+    return result;
+}
+
+void tcp_socket::send_all(const void * pData, size_t size) const
+{
+    const auto * pBytes = static_cast<const char *>(pData);
+
+    while (size > 0)
+    {
+        const auto sent = ::send(m_socket, pBytes, size, send_flags);
+
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (sent <= 0)
+        {
+            throw std::runtime_error("Error: Failed to send, the peer is gone");
+        }
+
+        pBytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+}
+
+void tcp_socket::recv_all(void * pData, size_t size) const
+{
+    auto * pBytes = static_cast<char *>(pData);
+
+    while (size > 0)
+    {
+        const auto received = ::recv(m_socket, pBytes, size, 0);
+
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (received <= 0)
+        {
+            throw std::runtime_error("Error: Failed to receive, the peer is gone");
+        }
+
+        pBytes += received;
+        size -= static_cast<size_t>(received);
+    }
+}
+
+uint16_t tcp_socket::port() const
+{
+    sockaddr_in address { };
+    socklen_t length = sizeof(address);
+
+    if (getsockname(m_socket, reinterpret_cast<sockaddr *>(&address), &length) != 0)
+    {
+        throw std::runtime_error("Error: Failed to query the socket port");
+    }
+
+    return ntohs(address.sin_port);
+}
+
+bool tcp_socket::is_open() const
+{
+    return m_socket != -1;
+}
+
+void tcp_socket::close()
+{
+    if (m_socket != -1)
+    {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+}
@@ -0,0 +1,41 @@
+#include <transport.hpp>
+
+#include <stdexcept>
+
+using namespace retro::comm;
+
+shm_transport::shm_transport(const std::string& session, int rank, int size, size_t ring_capacity)
+    : m_rank(rank)
+    , m_size(size)
+    , m_segment(session, static_cast<size_t>(size) * static_cast<size_t>(size) * shm_ring::footprint(ring_capacity), rank == 0)
+{
+    if (rank < 0 || rank >= size)
+    {
+        throw std::runtime_error("Error: Rank out of range");
+    }
+
+    auto * pBase = static_cast<unsigned char *>(m_segment.data());
+
+    // Every process builds the same views onto the same memory, only rank 0's segment was zero filled
+    m_rings.reserve(static_cast<size_t>(size) * static_cast<size_t>(size));
+
+    for (size_t i = 0; i < static_cast<size_t>(size) * static_cast<size_t>(size); i++)
+    {
+        m_rings.emplace_back(pBase + i * shm_ring::footprint(ring_capacity), ring_capacity);
+    }
+}
+
+void shm_transport::send(int peer, const void * pData, size_t size)
+{
+    ring(m_rank, peer).write(pData, size);
+}
+
+void shm_transport::recv(int peer, void * pData, size_t size)
+{
+    ring(peer, m_rank).read(pData, size);
+}
+
+shm_ring& shm_transport::ring(int from, int to)
+{
+    return m_rings.at(static_cast<size_t>(from) * static_cast<size_t>(m_size) + static_cast<size_t>(to));
+}
@@ -0,0 +1,111 @@
+#include <transport.hpp>
+
+#include <stdexcept>
+
+using namespace retro::comm;
+
+namespace
+{
+    // What a worker tells rank 0 when it checks in
+    struct hello
+    {
+        uint32_t rank;
+        uint32_t port;
+    };
+}
+
+tcp_transport::tcp_transport(int size)
+    : m_rank(0)
+    , m_size(size)
+    , m_listener(tcp_socket::listen(size))
+    , m_peers(size)
+{
+}
+
+uint16_t tcp_transport::port() const
+{
+    return m_listener.port();
+}
+
+void tcp_transport::connect()
+{
+    std::vector<uint32_t> ports(m_size, 0);
+
+    // Workers check in in whatever order they start
+    for (int i = 1; i < m_size; i++)
+    {
+        auto peer = m_listener.accept();
+
+        hello message { };
+        peer.recv_all(&message, sizeof(message));
+
+        if (message.rank == 0 || message.rank >= static_cast<uint32_t>(m_size) || m_peers.at(message.rank).is_open())
+        {
+            throw std::runtime_error("Error: Unexpected rank checked in");
+        }
+
+        ports.at(message.rank) = message.port;
+        m_peers.at(message.rank) = std::move(peer);
+    }
+
+    // Everybody gets the full table, then connects among themselves
+    for (int i = 1; i < m_size; i++)
+    {
+        m_peers.at(i).send_all(ports.data(), ports.size() * sizeof(uint32_t));
+    }
+}
+
+tcp_transport::tcp_transport(int rank, int size, uint16_t root_port)
+    : m_rank(rank)
+    , m_size(size)
+    , m_listener(tcp_socket::listen(size))
+    , m_peers(size)
+{
+    if (rank <= 0 || rank >= size)
+    {
+        throw std::runtime_error("Error: Rank out of range");
+    }
+
+    m_peers.at(0) = tcp_socket::connect(root_port);
+
+    const hello message { static_cast<uint32_t>(rank), m_listener.port() };
+    m_peers.at(0).send_all(&message, sizeof(message));
+
+    std::vector<uint32_t> ports(size, 0);
+    m_peers.at(0).recv_all(ports.data(), ports.size() * sizeof(uint32_t));
+
+    const auto self = static_cast<uint32_t>(rank);
+
+    // Connect down to the workers below, each of them accepts from the ones above. Their listeners all exist
+    // before rank 0 hands out the table, so the connects land in the backlog even if nobody accepts yet
+    for (int peer = 1; peer < rank; peer++)
+    {
+        m_peers.at(peer) = tcp_socket::connect(static_cast<uint16_t>(ports.at(peer)));
+        m_peers.at(peer).send_all(&self, sizeof(self));
+    }
+
+    for (int i = rank + 1; i < size; i++)
+    {
+        auto peer = m_listener.accept();
+
+        uint32_t peer_rank = 0;
+        peer.recv_all(&peer_rank, sizeof(peer_rank));
+
+        if (peer_rank <= self || peer_rank >= static_cast<uint32_t>(size) || m_peers.at(peer_rank).is_open())
+        {
+            throw std::runtime_error("Error: Unexpected rank connected");
+        }
+
+        m_peers.at(peer_rank) = std::move(peer);
+    }
+}
+
+void tcp_transport::send(int peer, const void * pData, size_t size)
+{
+    m_peers.at(peer).send_all(pData, size);
+}
+
+void tcp_transport::recv(int peer, void * pData, size_t size)
+{
+    m_peers.at(peer).recv_all(pData, size);
+}
@@ -0,0 +1,162 @@
+#include <process.hpp>
+
+#include <windows.h>
+
+#include <utility>
+#include <stdexcept>
+
+using namespace retro::comm;
+
+namespace
+{
+    // Quoting as CommandLineToArgvW undoes it: backslashes only escape when they precede a quote
+    void append_quoted(std::string& command_line, const std::string& argument)
+    {
+        if (!argument.empty() && argument.find_first_of(" \t\"") == std::string::npos)
+        {
+            command_line += argument;
+            return;
+        }
+
+        command_line += '"';
+
+        size_t backslashes = 0;
+
+        for (const auto symbol : argument)
+        {
+            if (symbol == '\\')
+            {
+                backslashes++;
+                continue;
+            }
+
+            command_line.append(symbol == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+            command_line += symbol;
+
+            backslashes = 0;
+        }
+
+        command_line.append(backslashes * 2, '\\');
+        command_line += '"';
+    }
+}
+
+process::process(const std::string& executable, const std::vector<std::string>& arguments)
+{
+    std::string command_line;
+    append_quoted(command_line, executable);
+
+    for (const auto& argument : arguments)
+    {
+        command_line += ' ';
+        append_quoted(command_line, argument);
+    }
+
+    STARTUPINFOA startup_info { };
+    startup_info.cb = sizeof(startup_info);
+
+    PROCESS_INFORMATION process_info { };
+
+    if (!CreateProcessA(executable.c_str(), command_line.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup_info, &process_info))
+    {
+        throw std::runtime_error("Error: Failed to start " + executable);
+    }
+
+    CloseHandle(process_info.hThread);
+    m_hProcess = process_info.hProcess;
+}
+
+process::process(process&& other) noexcept
+    : m_exit_code(other.m_exit_code)
+    , m_is_waited(other.m_is_waited)
+    , m_hProcess(std::exchange(other.m_hProcess, nullptr))
+{
+}
+
+process& process::operator=(process&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+
+        m_exit_code = other.m_exit_code;
+        m_is_waited = other.m_is_waited;
+        m_hProcess = std::exchange(other.m_hProcess, nullptr);
+    }
+
+    return *this;
+}
+
+process::~process()
+{
+    release();
+}
+
+int process::wait()
+{
+    if (m_hProcess == nullptr)
+    {
+        throw std::runtime_error("Error: No process to wait for");
+    }
+
+    if (!m_is_waited)
+    {
+        WaitForSingleObject(m_hProcess, INFINITE);
+
+        DWORD exit_code = 0;
+        GetExitCodeProcess(m_hProcess, &exit_code);
+
+        m_exit_code = static_cast<int>(exit_code);
+        m_is_waited = true;
+    }
+
+    return m_exit_code;
+}
+
+bool process::is_started() const
+{
+    return m_hProcess != nullptr;
+}
+
+std::string process::current_executable()
+{
+    std::string path(MAX_PATH, '\0');
+
+    while (true)
+    {
+        const auto length = GetModuleFileNameA(nullptr, path.data(), static_cast<DWORD>(path.size()));
+
+        if (length == 0)
+        {
+            throw std::runtime_error("Error: Failed to locate the running executable");
+        }
+
+        // Truncated paths fill the buffer completely, retry with a bigger one
+        if (length < path.size())
+        {
+            path.resize(length);
+            return path;
+        }
+
+        path.resize(path.size() * 2);
+    }
+}
+
+uint32_t process::current_id()
+{
+    return static_cast<uint32_t>(GetCurrentProcessId());
+}
+
+void process::release()
+{
+    if (m_hProcess != nullptr)
+    {
+        if (!m_is_waited)
+        {
+            WaitForSingleObject(m_hProcess, INFINITE);
+        }
+
+        CloseHandle(m_hProcess);
+        m_hProcess = nullptr;
+    }
+}
@@ -0,0 +1,45 @@
+#include <shared_memory.hpp>
+
+#include <windows.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+using namespace retro::comm;
+
+shared_memory::shared_memory(const std::string& name, size_t size, bool create)
+    : m_name("Local\\" + name)
+    , m_size(size)
+    , m_is_owner(create)
+{
+    const auto size64 = static_cast<uint64_t>(size);
+
+    // Backed by the paging file and zero filled. The mapping lives as long as any process has a handle or a view
+    m_hMapping = create
+            ? CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), m_name.c_str())
+            : OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, m_name.c_str());
+
+    if (m_hMapping == nullptr || (create && GetLastError() == ERROR_ALREADY_EXISTS))
+    {
+        if (m_hMapping != nullptr)
+        {
+            CloseHandle(m_hMapping);
+        }
+
+        throw std::runtime_error("Error: Failed to open shared memory " + m_name);
+    }
+
+    m_pData = MapViewOfFile(m_hMapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+
+    if (m_pData == nullptr)
+    {
+        CloseHandle(m_hMapping);
+        throw std::runtime_error("Error: Failed to map shared memory " + m_name);
+    }
+}
+
+shared_memory::~shared_memory()
+{
+    UnmapViewOfFile(m_pData);
+    CloseHandle(m_hMapping);
+}
@@ -0,0 +1,197 @@
+#include <tcp_socket.hpp>
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include <string>
+#include <climits>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace retro::comm;
+
+namespace
+{
+    constexpr auto closed = ~static_cast<uintptr_t>(0);
+
+    // Winsock wants WSAStartup before the first socket, once per process is enough
+    void ensure_winsock()
+    {
+        static const bool is_started = []()
+        {
+            WSADATA data;
+
+            if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+            {
+                throw std::runtime_error("Error: Failed to start Winsock");
+            }
+
+            return true;
+        }();
+
+        (void)is_started;
+    }
+
+    sockaddr_in loopback(uint16_t port)
+    {
+        sockaddr_in address { };
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        return address;
+    }
+
+    // Messages are small and latency is what the benchmarks measure, Nagle would hold them back
+    void disable_nagle(SOCKET socket)
+    {
+        const BOOL enable = TRUE;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&enable), sizeof(enable));
+    }
+
+    SOCKET create_socket()
+    {
+        ensure_winsock();
+
+        const auto result = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+        if (result == INVALID_SOCKET)
+        {
+            throw std::runtime_error("Error: Failed to create a socket");
+        }
+
+        return result;
+    }
+}
+
+tcp_socket::tcp_socket(tcp_socket&& other) noexcept
+    : m_socket(std::exchange(other.m_socket, closed))
+{
+}
+
+tcp_socket& tcp_socket::operator=(tcp_socket&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        m_socket = std::exchange(other.m_socket, closed);
+    }
+
+    return *this;
+}
+
+tcp_socket::~tcp_socket()
+{
+    close();
+}
+
+tcp_socket tcp_socket::listen(int backlog)
+{
+    tcp_socket result;
+    result.m_socket = create_socket();
+
+    const auto address = loopback(0);
+
+    if (bind(result.m_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || ::listen(result.m_socket, backlog) != 0)
+    {
+        throw std::runtime_error("Error: Failed to listen on the loopback interface");
+    }
+
+    return result;
+}
+
+tcp_socket tcp_socket::connect(uint16_t port)
+{
+    tcp_socket result;
+    result.m_socket = create_socket();
+
+    const auto address = loopback(port);
+
+    if (::connect(result.m_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        throw std::runtime_error("Error: Failed to connect to port " + std::to_string(port));
+    }
+
+    disable_nagle(result.m_socket);
+
+    return result;
+}
+
+tcp_socket tcp_socket::accept() const
+{
+    tcp_socket result;
+    result.m_socket = ::accept(m_socket, nullptr, nullptr);
+
+    if (result.m_socket == INVALID_SOCKET)
+    {
+        throw std::runtime_error("Error: Failed to accept a connection");
+    }
+
+    disable_nagle(result.m_socket);
+
+    return result;
+}
+
+void tcp_socket::send_all(const void * pData, size_t size) const
+{
+    const auto * pBytes = static_cast<const char *>(pData);
+
+    while (size > 0)
+    {
+        const auto sent = ::send(m_socket, pBytes, static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+
+        if (sent <= 0)
+        {
+            throw std::runtime_error("Error: Failed to send, the peer is gone");
+        }
+
+        pBytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+}
+
+void tcp_socket::recv_all(void * pData, size_t size) const
+{
+    auto * pBytes = static_cast<char *>(pData);
+
+    while (size > 0)
+    {
+        const auto received = ::recv(m_socket, pBytes, static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+
+        if (received <= 0)
+        {
+            throw std::runtime_error("Error: Failed to receive, the peer is gone");
+        }
+
+        pBytes += received;
+        size -= static_cast<size_t>(received);
+    }
+}
+
+uint16_t tcp_socket::port() const
+{
+    sockaddr_in address { };
+    int length = sizeof(address);
+
+    if (getsockname(m_socket, reinterpret_cast<sockaddr *>(&address), &length) != 0)
+    {
+        throw std::runtime_error("Error: Failed to query the socket port");
+    }
+
+    return ntohs(address.sin_port);
+}
+
+bool tcp_socket::is_open() const
+{
+    return m_socket != closed;
+}
+
+void tcp_socket::close()
+{
+    if (m_socket != closed)
+    {
+        closesocket(m_socket);
+        m_socket = closed;
+    }
+}
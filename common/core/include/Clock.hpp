@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace retro::core
+{
+    // std::chrono clock on the CPU's time stamp counter. On x86 with an invariant TSC (constant rate through
+    // frequency and sleep state changes) a reading is one fenced rdtscp/rdtsc and a multiply instead of a
+    // call into the OS, and the resolution is a single tick. The rate is calibrated against steady_clock once
+    // at startup, and time points share steady_clock's epoch.
+    //
+    // Anywhere else (no invariant TSC, which includes some virtual machines, or not x86) it is steady_clock
+    class Clock
+    {
+    public:
+
+        using rep = int64_t;
+        using period = std::nano;
+        using duration = std::chrono::nanoseconds;
+        using time_point = std::chrono::time_point<Clock>;
+
+        static constexpr bool is_steady = true;
+
+        static time_point now() noexcept;
+
+        // Since steady_clock's epoch, the drop-in for omp_get_wtime()
+        static double Seconds() noexcept;
+
+        // Seconds per tick, the drop-in for omp_get_wtick()
+        static double Resolution() noexcept;
+
+        [[nodiscard]] static bool IsTscBased() noexcept;
+
+    };
+}
@@ -1,25 +1,109 @@
 #pragma once
 
 #include <SDL.h>
+
+#include <mpmc_queue.hpp>
+
+#include <span>
+#include <atomic>
 #include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
 
 namespace retro::core
 {
     using Event = SDL_Event;
 
-    class EventsPoll
+    // Application events share the SDL_Event layout so layers get them through OnEvent like window events.
+    // The type is one SDL never hands out (user types are registered upwards from SDL_USEREVENT), user.code
+    // tells payload types apart and the payload is copied into the bytes after it
+    constexpr uint32_t custom_event_type = SDL_LASTEVENT - 1;
+
+    constexpr size_t custom_payload_offset = offsetof(SDL_UserEvent, data1);
+
+    template<typename T>
+    concept CustomEventPayload = std::is_trivially_copyable_v<T>
+            && sizeof(T) <= sizeof(Event) - custom_payload_offset
+            && alignof(T) <= alignof(Event);
+
+    // Events of the current frame, from the window and from any other thread. Posting copies the event into a
+    // preallocated ring (concurrent::mpmc_queue) and never allocates or blocks; Application::Run drains the
+    // ring once per frame in a single batch and hands the events to every layer.
+    //
+    // Post is best-effort: a full ring drops the event, counts it and returns false. Fine for input and
+    // progress, anything that must arrive (a finished run) checks the result and falls back to
+    // thread::main_thread_queue. A frame takes at most capacity events and leaves the rest for the next one
+    class EventBus
     {
     public:
 
-        static void ClearEvents();
+        static constexpr size_t capacity = 1024;
+
+        static EventBus& Get();
+
+        // Any thread. Does not wake a UI thread sleeping between frames, window events are posted by the UI
+        // thread itself
+        bool Post(const Event& event);
+
+        size_t PostAll(std::span<const Event> events);
+
+        // Any thread. Wakes the UI for a frame, e.g. a worker reporting a finished run
+        template<CustomEventPayload T>
+        bool Post(const T& payload)
+        {
+            Event event { };
+
+            event.user.type = custom_event_type;
+            event.user.code = GetPayloadType<T>();
+            std::memcpy(reinterpret_cast<unsigned char *>(&event) + custom_payload_offset, &payload, sizeof(T));
+
+            return PostAndWake(event);
+        }
+
+        // The payload if event carries a T
+        template<CustomEventPayload T>
+        static std::optional<T> As(const Event& event)
+        {
+            if (event.type != custom_event_type || event.user.code != GetPayloadType<T>())
+            {
+                return std::nullopt;
+            }
+
+            T payload;
+            std::memcpy(&payload, reinterpret_cast<const unsigned char *>(&event) + custom_payload_offset, sizeof(T));
+
+            return payload;
+        }
+
+        // UI thread only. Takes the events queued so far, valid until the next call
+        std::span<const Event> Drain();
+
+        [[nodiscard]] uint64_t GetDropped() const;
+
+    private:
+
+        EventBus();
+
+        bool PostAndWake(const Event& event);
+
+        // Numbered on first use, so the codes only mean something within one process
+        template<typename T>
+        static int32_t GetPayloadType()
+        {
+            static const int32_t type = m_next_payload_type.fetch_add(1, std::memory_order_relaxed);
+            return type;
+        }
 
-        static void AddEvent(const Event& event);
+        inline static std::atomic<int32_t> m_next_payload_type { 0 };
 
-        static const std::vector<Event>& GetEvents();
+        concurrent::mpmc_queue<Event> m_queue;
 
-    protected:
+        std::vector<Event> m_batch;
 
-        inline static std::vector<Event> m_events;
+        std::atomic<uint64_t> m_dropped { 0 };
 
     };
-}
\ No newline at end of file
+}
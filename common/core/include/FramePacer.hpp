@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Event.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+
+namespace retro::core
+{
+    // Decides how long the UI thread may sleep in Window::PollEvents before it builds the next frame. A render
+    // loop that never sleeps keeps a core busy and its caches full of UI data while the benchmarks are timed.
+    //
+    // While the user interacts every frame is drawn (vsync bound). While a job runs the UI refreshes at a low
+    // rate, enough for progress bars. Otherwise it sleeps until input arrives, a job finishes or work is
+    // posted to the main thread queue
+    class FramePacer
+    {
+    public:
+
+        using clock = std::chrono::steady_clock;
+
+        struct Settings
+        {
+            // Off draws every frame like before, for comparing benchmark noise with and without pacing
+            bool is_adaptive = true;
+
+            // Refresh rate while at least one job is running
+            int busy_fps = 10;
+
+            // Full rate this long after the last input: hover effects and ImGui itself need a few frames to settle
+            std::chrono::milliseconds input_grace { 250 };
+
+            // Longest sleep with nothing going on, the frame time counters still move now and then
+            std::chrono::milliseconds idle_timeout { 1000 };
+        };
+
+        enum class State
+        {
+            interactive,
+            busy,
+            idle
+        };
+
+        // Since the last ResetStatistics(), UI thread time split into blocked in PollEvents and everything else
+        // (building, rendering and presenting frames, Present's vsync wait included)
+        struct Statistics
+        {
+            uint64_t frames = 0;
+
+            double waiting_seconds = 0.0;
+            double working_seconds = 0.0;
+        };
+
+        // Marks a job as running for its lifetime, from any thread. Finishing wakes the UI for a frame right away
+        class JobScope
+        {
+        public:
+
+            JobScope();
+
+            ~JobScope();
+
+            JobScope(const JobScope&) = delete;
+
+            JobScope& operator=(const JobScope&) = delete;
+        };
+
+        static FramePacer& Get();
+
+        // Any thread. Wakes the UI for one frame
+        void RequestFrame();
+
+        [[nodiscard]] int GetRunningJobs() const;
+
+        // UI thread only from here on
+
+        // How long the coming PollEvents may block, zero not to block at all. Call once per frame, right
+        // before PollEvents: it consumes pending frame requests
+        [[nodiscard]] std::chrono::milliseconds GetWaitTimeout();
+
+        // Right after PollEvents returned with the frame's events
+        void BeginFrame(const std::vector<Event>& events);
+
+        // After the frame was presented
+        void EndFrame();
+
+        [[nodiscard]] State GetState() const;
+
+        [[nodiscard]] Settings& GetSettings();
+
+        [[nodiscard]] const Statistics& GetStatistics() const;
+
+        void ResetStatistics();
+
+    private:
+
+        FramePacer() = default;
+
+        [[nodiscard]] bool IsWakeEvent(const Event& event) const;
+
+        Settings m_settings;
+        Statistics m_statistics;
+
+        std::atomic<int> m_running_jobs { 0 };
+        std::atomic<bool> m_is_frame_requested { false };
+
+        clock::time_point m_last_input { };
+        clock::time_point m_frame_start { clock::now() };
+        clock::time_point m_frame_end { clock::now() };
+
+    };
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Clock.hpp"
+#include "Layer.hpp"
+
+#include <chrono>
+#include <string>
+#include <iosfwd>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+namespace retro::core
+{
+    // Command line of a headless run: --headless, then --iterations=N and/or --deadline=S (seconds). Any other
+    // --key=value is kept for the kernel, e.g. --size=1024 or --threads=8
+    class HeadlessOptions
+    {
+    public:
+
+        // Empty unless --headless was passed, so a lab's main() can pick its layer with one call
+        static std::optional<HeadlessOptions> Parse(int argc, char ** argv);
+
+        [[nodiscard]] int64_t GetInt(const std::string& key, int64_t fallback) const;
+
+        [[nodiscard]] double GetDouble(const std::string& key, double fallback) const;
+
+    public:
+
+        // Zero for no limit. With neither limit set a kernel runs exactly once
+        uint64_t iterations { 0 };
+
+        std::chrono::duration<double> deadline { 0.0 };
+
+    protected:
+
+        std::unordered_map<std::string, std::string> m_parameters;
+
+    };
+
+    // Runs a lab kernel without a window: no SDL video, no Direct3D, no ImGui frame or vsync between the
+    // iterations. Application::Run keeps calling OnUpdate, each call runs one iteration until the budget is
+    // spent or the kernel has nothing more to do; then the results go to stdout and the application stops
+    class HeadlessLayer
+        : public Layer
+    {
+    public:
+
+        HeadlessLayer(std::string name, HeadlessOptions options);
+
+        void OnAttach() override;
+
+        void OnDetach() override;
+
+        bool OnUpdate(ts delta) final;
+
+        // Nothing produces events without a window
+        bool OnEvent(const Event& event) final;
+
+    protected:
+
+        // One pass of the kernel. Returning false ends the run early
+        virtual bool RunIteration(uint64_t index) = 0;
+
+        // Kernel specific results, printed after the common iterations and time line
+        virtual void Report(std::ostream& out) = 0;
+
+    protected:
+
+        std::string m_name;
+
+        HeadlessOptions m_options;
+
+    private:
+
+        [[nodiscard]] bool IsBudgetSpent() const;
+
+        uint64_t m_iterations { 0 };
+
+        Clock::time_point m_start;
+
+    };
+}
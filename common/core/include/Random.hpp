@@ -1,6 +1,8 @@
 #pragma once
 
+#include <limits>
 #include <random>
+#include <type_traits>
 
 namespace retro::core
 {
@@ -23,7 +25,7 @@ namespace retro::core
             }
             else
             {
-                static_assert(false, "Type not supported for random generation");
+                static_assert(sizeof(T) == 0, "Type not supported for random generation");
             }
         }
 
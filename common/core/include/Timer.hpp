@@ -1,7 +1,13 @@
 #pragma once
 
+#include "Clock.hpp"
+
+#include <trace.hpp>
+
+#include <atomic>
 #include <chrono>
 #include <string>
+#include <cstdint>
 
 namespace retro::core
 {
@@ -22,7 +28,7 @@ namespace retro::core
             }
             else if (!m_is_finished)
             {
-                auto elapsed = std::chrono::high_resolution_clock::now() - start;
+                auto elapsed = Clock::now() - start;
                 return std::chrono::duration_cast<T>(elapsed);
             }
 
@@ -35,12 +41,14 @@ namespace retro::core
 
         bool m_is_finished { false };
 
-        std::chrono::time_point<std::chrono::high_resolution_clock> end;
+        Clock::time_point end;
 
-        std::chrono::time_point<std::chrono::high_resolution_clock> start;
+        Clock::time_point start;
     };
 
 
+    // Prints how long the scope took and shows up on the trace timeline, as a zone of the same name for a named
+    // timer and as "ScopeTimer" for an unnamed one
     class ScopeTimer
         : public Timer
     {
@@ -62,7 +70,10 @@ namespace retro::core
 
     private:
 
-        inline static int64_t m_active_timers;
+        trace::zone m_zone;
+
+        // Numbers unnamed timers, they may be created on any thread
+        inline static std::atomic<int64_t> m_next_id { 0 };
 
     };
 }
\ No newline at end of file
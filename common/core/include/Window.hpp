@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -18,7 +19,8 @@ namespace retro::graphics
 
         ~Window();
 
-        [[nodiscard]] std::vector<SDL_Event> PollEvents();
+        // Blocks up to timeout for the first event when none is pending, then takes whatever else queued up
+        [[nodiscard]] std::vector<SDL_Event> PollEvents(std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
 
         void Close();
 
@@ -34,6 +36,8 @@ namespace retro::graphics
 
     protected:
 
+        void HandleEvent(const SDL_Event& event);
+
         void CleanupDeviceD3D();
 
         void CreateRenderTarget();
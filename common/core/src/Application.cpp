@@ -1,7 +1,11 @@
+#include <Clock.hpp>
 #include <Timer.hpp>
 #include <Layer.hpp>
+#include <FramePacer.hpp>
 #include <Application.hpp>
 
+#include <scheduler.hpp>
+
 #include <chrono>
 
 using namespace retro::core;
@@ -21,16 +25,26 @@ int Application::Run()
 
     Layer::ts duration = 0.0F;
 
+    // Coroutines and jobs that hop to the main thread are resumed here, between frames
+    auto& main_queue = thread::main_thread_queue::shared();
+    main_queue.bind_to_current_thread();
+
+    // Work posted to the queue has to wake a UI thread that is sleeping between frames
+    main_queue.set_notifier([]() { FramePacer::Get().RequestFrame(); });
+
     while (m_is_running)
     {
-        auto start = std::chrono::high_resolution_clock::now();
+        auto start = Clock::now();
+
+        main_queue.drain();
 
         for (const auto& [key, layer] : m_layers)
         {
             m_is_running &= layer->OnUpdate(duration);
         }
 
-        const auto& events = core::EventsPoll::GetEvents();
+        // One batch per frame: window events posted by the layers above and whatever other threads posted
+        const auto events = EventBus::Get().Drain();
 
         for (const auto& [key, layer] : m_layers)
         {
@@ -40,8 +54,7 @@ int Application::Run()
             }
         }
 
-        core::EventsPoll::ClearEvents();
-        auto end = std::chrono::high_resolution_clock::now();
+        auto end = Clock::now();
         duration = static_cast<decltype(duration)>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()) / 1000.0F;
     }
 
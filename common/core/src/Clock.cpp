@@ -0,0 +1,202 @@
+#include <Clock.hpp>
+
+#include <array>
+#include <thread>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+# define RETRO_CLOCK_HAS_TSC
+# if defined(_MSC_VER)
+#  include <intrin.h>
+# else
+#  include <cpuid.h>
+#  include <x86intrin.h>
+# endif
+#endif
+
+using namespace retro::core;
+
+namespace
+{
+    struct Calibration
+    {
+        bool is_tsc = false;
+        bool has_rdtscp = false;
+
+        // One simultaneous reading of both clocks, the TSC is converted relative to it
+        uint64_t tsc_origin = 0;
+        int64_t steady_origin_ns = 0;
+
+        double ns_per_tick = 1.0;
+    };
+
+    int64_t SteadyNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+#if defined(RETRO_CLOCK_HAS_TSC)
+    std::array<uint32_t, 4> Cpuid(uint32_t leaf)
+    {
+        std::array<uint32_t, 4> registers { };
+
+#if defined(_MSC_VER)
+        std::array<int, 4> values { };
+        __cpuid(values.data(), static_cast<int>(leaf));
+
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            registers.at(i) = static_cast<uint32_t>(values.at(i));
+        }
+#else
+        __cpuid(leaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+
+        return registers;
+    }
+
+    bool HasExtendedLeaf(uint32_t leaf)
+    {
+        return Cpuid(0x80000000).at(0) >= leaf;
+    }
+
+    // CPUID 0x80000007 EDX bit 8. Without it the TSC may stop in deep sleep states or follow the core clock
+    bool IsTscInvariant()
+    {
+        return HasExtendedLeaf(0x80000007) && (Cpuid(0x80000007).at(3) & (1U << 8)) != 0;
+    }
+
+    // CPUID 0x80000001 EDX bit 27
+    bool HasRdtscp()
+    {
+        return HasExtendedLeaf(0x80000001) && (Cpuid(0x80000001).at(3) & (1U << 27)) != 0;
+    }
+
+    // rdtsc may execute before earlier instructions are done and let later ones start before it: the fence in
+    // front (rdtscp waits on its own) and the one behind keep the reading where it is in the program
+    uint64_t ReadTsc(bool has_rdtscp)
+    {
+        uint64_t ticks;
+
+        if (has_rdtscp)
+        {
+            unsigned int processor;
+            ticks = __rdtscp(&processor);
+        }
+        else
+        {
+            _mm_lfence();
+            ticks = __rdtsc();
+        }
+
+        _mm_lfence();
+        return ticks;
+    }
+
+    // The pair whose steady_clock reading took the fewest ticks has the least uncertainty about when it was taken
+    void ReadBoth(bool has_rdtscp, uint64_t& tsc, int64_t& steady_ns)
+    {
+        auto narrowest = std::numeric_limits<uint64_t>::max();
+
+        for (int attempt = 0; attempt < 8; attempt++)
+        {
+            const auto before = ReadTsc(has_rdtscp);
+            const auto ns = SteadyNs();
+            const auto after = ReadTsc(has_rdtscp);
+
+            if (after - before < narrowest)
+            {
+                narrowest = after - before;
+
+                tsc = before + (after - before) / 2;
+                steady_ns = ns;
+            }
+        }
+    }
+#endif
+
+    Calibration Calibrate()
+    {
+        Calibration result;
+        result.steady_origin_ns = SteadyNs();
+
+#if defined(RETRO_CLOCK_HAS_TSC)
+        if (!IsTscInvariant())
+        {
+            return result;
+        }
+
+        result.has_rdtscp = HasRdtscp();
+
+        uint64_t tsc_begin = 0;
+        uint64_t tsc_end = 0;
+
+        int64_t ns_begin = 0;
+        int64_t ns_end = 0;
+
+        // The read error is tens of nanoseconds at both ends, over 20 ms that is a rate error of a few ppm
+        ReadBoth(result.has_rdtscp, tsc_begin, ns_begin);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ReadBoth(result.has_rdtscp, tsc_end, ns_end);
+
+        if (tsc_end <= tsc_begin || ns_end <= ns_begin)
+        {
+            return result;
+        }
+
+        result.is_tsc = true;
+        result.tsc_origin = tsc_begin;
+        result.steady_origin_ns = ns_begin;
+        result.ns_per_tick = static_cast<double>(ns_end - ns_begin) / static_cast<double>(tsc_end - tsc_begin);
+#endif
+
+        return result;
+    }
+
+    const Calibration& GetCalibration()
+    {
+        static const Calibration calibration = Calibrate();
+        return calibration;
+    }
+
+    // At startup rather than inside the first measurement
+    [[maybe_unused]] const auto& startup_calibration = GetCalibration();
+}
+
+Clock::time_point Clock::now() noexcept
+{
+#if defined(RETRO_CLOCK_HAS_TSC)
+    const auto& calibration = GetCalibration();
+
+    if (calibration.is_tsc)
+    {
+        // Signed: a core whose counter is a few ticks behind the calibrating one reads just before the origin
+        const auto ticks = static_cast<int64_t>(ReadTsc(calibration.has_rdtscp) - calibration.tsc_origin);
+        const auto ns = static_cast<int64_t>(static_cast<double>(ticks) * calibration.ns_per_tick);
+
+        return time_point(duration(calibration.steady_origin_ns + ns));
+    }
+#endif
+
+    return time_point(duration(SteadyNs()));
+}
+
+double Clock::Seconds() noexcept
+{
+    return std::chrono::duration<double>(now().time_since_epoch()).count();
+}
+
+double Clock::Resolution() noexcept
+{
+    if (IsTscBased())
+    {
+        return GetCalibration().ns_per_tick * 1e-9;
+    }
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::duration(1)).count();
+}
+
+bool Clock::IsTscBased() noexcept
+{
+    return GetCalibration().is_tsc;
+}
@@ -1,18 +1,70 @@
 #include <Event.hpp>
+#include <FramePacer.hpp>
 
 using namespace retro::core;
 
-void EventsPoll::ClearEvents()
+EventBus::EventBus()
+    : m_queue(capacity)
+    , m_batch(capacity)
 {
-    m_events.clear();
 }
 
-void EventsPoll::AddEvent(const Event &event)
+EventBus& EventBus::Get()
 {
-    m_events.push_back(event);
+    static EventBus instance;
+    return instance;
 }
 
-const std::vector<Event> &EventsPoll::GetEvents()
+bool EventBus::Post(const Event& event)
 {
-    return m_events;
+    if (!m_queue.try_push(event))
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+size_t EventBus::PostAll(std::span<const Event> events)
+{
+    size_t posted = 0;
+
+    // try_push_bulk takes a prefix of what fits, one CAS per call
+    while (posted < events.size())
+    {
+        const auto pushed = m_queue.try_push_bulk(events.begin() + static_cast<ptrdiff_t>(posted), events.end());
+
+        if (pushed == 0)
+        {
+            m_dropped.fetch_add(events.size() - posted, std::memory_order_relaxed);
+            break;
+        }
+
+        posted += pushed;
+    }
+
+    return posted;
+}
+
+std::span<const Event> EventBus::Drain()
+{
+    const auto count = m_queue.try_pop_bulk(m_batch.begin(), m_batch.size());
+    return std::span<const Event>(m_batch.data(), count);
+}
+
+uint64_t EventBus::GetDropped() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+bool EventBus::PostAndWake(const Event& event)
+{
+    if (!Post(event))
+    {
+        return false;
+    }
+
+    FramePacer::Get().RequestFrame();
+    return true;
 }
@@ -0,0 +1,143 @@
+#include <FramePacer.hpp>
+
+#include <algorithm>
+
+using namespace retro::core;
+
+namespace
+{
+    // SDL event type reserved for waking the UI thread, registered on first use
+    uint32_t GetWakeEventType()
+    {
+        static const uint32_t type = SDL_RegisterEvents(1);
+        return type;
+    }
+}
+
+FramePacer::JobScope::JobScope()
+{
+    FramePacer::Get().m_running_jobs.fetch_add(1, std::memory_order_relaxed);
+}
+
+FramePacer::JobScope::~JobScope()
+{
+    auto& pacer = FramePacer::Get();
+
+    pacer.m_running_jobs.fetch_sub(1, std::memory_order_relaxed);
+    pacer.RequestFrame();
+}
+
+FramePacer& FramePacer::Get()
+{
+    static FramePacer instance;
+    return instance;
+}
+
+void FramePacer::RequestFrame()
+{
+    // One wake event in flight is enough. The flag is cleared right before the UI may block, so a request
+    // that finds it set is covered: either its event is still queued or the UI does not block at all
+    if (m_is_frame_requested.exchange(true, std::memory_order_acq_rel))
+    {
+        return;
+    }
+
+    // Without a window (headless runs) there is nobody to wake. SDL_PushEvent is safe from any thread
+    if (SDL_WasInit(SDL_INIT_EVENTS) == 0 || GetWakeEventType() == static_cast<uint32_t>(-1))
+    {
+        return;
+    }
+
+    SDL_Event event { };
+    event.type = GetWakeEventType();
+
+    SDL_PushEvent(&event);
+}
+
+int FramePacer::GetRunningJobs() const
+{
+    return m_running_jobs.load(std::memory_order_relaxed);
+}
+
+std::chrono::milliseconds FramePacer::GetWaitTimeout()
+{
+    // Cleared here rather than once the frame started: a request made while the UI was polling would see
+    // the flag still set, skip its wake event and leave the UI asleep with work pending
+    const bool is_frame_requested = m_is_frame_requested.exchange(false, std::memory_order_acq_rel);
+
+    if (!m_settings.is_adaptive || is_frame_requested)
+    {
+        return std::chrono::milliseconds(0);
+    }
+
+    switch (GetState())
+    {
+        case State::interactive:
+            return std::chrono::milliseconds(0);
+
+        case State::busy:
+        {
+            // The period counts from the last frame's start, the frame itself already took part of it
+            const auto period = std::chrono::milliseconds(1000 / std::max(m_settings.busy_fps, 1));
+            const auto spent = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - m_frame_start);
+
+            return std::max(period - spent, std::chrono::milliseconds(0));
+        }
+
+        default:
+            return m_settings.idle_timeout;
+    }
+}
+
+void FramePacer::BeginFrame(const std::vector<Event>& events)
+{
+    const auto now = clock::now();
+
+    m_statistics.waiting_seconds += std::chrono::duration<double>(now - m_frame_end).count();
+    m_frame_start = now;
+
+    const bool has_input = std::any_of(events.begin(), events.end(), [this](const Event& event) { return !IsWakeEvent(event); });
+
+    if (has_input)
+    {
+        m_last_input = now;
+    }
+}
+
+void FramePacer::EndFrame()
+{
+    m_frame_end = clock::now();
+
+    m_statistics.frames++;
+    m_statistics.working_seconds += std::chrono::duration<double>(m_frame_end - m_frame_start).count();
+}
+
+FramePacer::State FramePacer::GetState() const
+{
+    if (clock::now() - m_last_input < m_settings.input_grace)
+    {
+        return State::interactive;
+    }
+
+    return GetRunningJobs() > 0 ? State::busy : State::idle;
+}
+
+FramePacer::Settings& FramePacer::GetSettings()
+{
+    return m_settings;
+}
+
+const FramePacer::Statistics& FramePacer::GetStatistics() const
+{
+    return m_statistics;
+}
+
+void FramePacer::ResetStatistics()
+{
+    m_statistics = { };
+}
+
+bool FramePacer::IsWakeEvent(const Event& event) const
+{
+    return event.type == GetWakeEventType();
+}
@@ -0,0 +1,151 @@
+#include <HeadlessLayer.hpp>
+
+#include <utility>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+
+using namespace retro::core;
+
+std::optional<HeadlessOptions> HeadlessOptions::Parse(int argc, char ** argv)
+{
+    bool is_headless = false;
+    HeadlessOptions options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view argument(argv[i]);
+
+        if (argument == "--headless")
+        {
+            is_headless = true;
+            continue;
+        }
+
+        if (!argument.starts_with("--"))
+        {
+            continue;
+        }
+
+        const auto separator = argument.find('=');
+
+        if (separator == std::string_view::npos)
+        {
+            continue;
+        }
+
+        options.m_parameters[std::string(argument.substr(2, separator - 2))] = std::string(argument.substr(separator + 1));
+    }
+
+    if (!is_headless)
+    {
+        return std::nullopt;
+    }
+
+    options.iterations = static_cast<uint64_t>(std::max<int64_t>(options.GetInt("iterations", 0), 0));
+    options.deadline = std::chrono::duration<double>(std::max(options.GetDouble("deadline", 0.0), 0.0));
+
+    return options;
+}
+
+int64_t HeadlessOptions::GetInt(const std::string& key, int64_t fallback) const
+{
+    const auto parameter = m_parameters.find(key);
+
+    if (parameter == m_parameters.end())
+    {
+        return fallback;
+    }
+
+    try
+    {
+        return std::stoll(parameter->second);
+    }
+    catch (const std::exception&)
+    {
+        throw std::runtime_error("Error: --" + key + " expects an integer, got '" + parameter->second + "'");
+    }
+}
+
+double HeadlessOptions::GetDouble(const std::string& key, double fallback) const
+{
+    const auto parameter = m_parameters.find(key);
+
+    if (parameter == m_parameters.end())
+    {
+        return fallback;
+    }
+
+    try
+    {
+        return std::stod(parameter->second);
+    }
+    catch (const std::exception&)
+    {
+        throw std::runtime_error("Error: --" + key + " expects a number, got '" + parameter->second + "'");
+    }
+}
+
+HeadlessLayer::HeadlessLayer(std::string name, HeadlessOptions options)
+    : m_name(std::move(name))
+    , m_options(std::move(options))
+{
+}
+
+void HeadlessLayer::OnAttach()
+{
+}
+
+void HeadlessLayer::OnDetach()
+{
+}
+
+bool HeadlessLayer::OnUpdate(ts)
+{
+    if (m_iterations == 0)
+    {
+        m_start = Clock::now();
+    }
+
+    const bool has_more = RunIteration(m_iterations);
+    m_iterations++;
+
+    if (has_more && !IsBudgetSpent())
+    {
+        return true;
+    }
+
+    const auto seconds = std::chrono::duration<double>(Clock::now() - m_start).count();
+
+    // Plain lines on stdout, easy to grep from a nightly log
+    std::cout << m_name << ": " << m_iterations << " iterations in " << seconds << " s, "
+              << seconds * 1000.0 / static_cast<double>(m_iterations) << " ms per iteration\n";
+
+    Report(std::cout);
+    std::cout.flush();
+
+    return false;
+}
+
+bool HeadlessLayer::OnEvent(const Event&)
+{
+    return true;
+}
+
+bool HeadlessLayer::IsBudgetSpent() const
+{
+    const bool has_limit = m_options.iterations > 0 || m_options.deadline.count() > 0.0;
+
+    if (!has_limit)
+    {
+        return true;
+    }
+
+    if (m_options.iterations > 0 && m_iterations >= m_options.iterations)
+    {
+        return true;
+    }
+
+    return m_options.deadline.count() > 0.0 && Clock::now() - m_start >= m_options.deadline;
+}
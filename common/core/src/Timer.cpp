@@ -10,26 +10,34 @@ void Timer::Run()
 {
     m_is_started = true;
     m_is_finished = false;
-    start = std::chrono::high_resolution_clock::now();
+    start = Clock::now();
 }
 
 void Timer::Stop()
 {
     m_is_started = false;
     m_is_finished = true;
-    end = std::chrono::high_resolution_clock::now();
+    end = Clock::now();
+}
+
+namespace
+{
+    // Zone of unnamed timers, and of named ones created while not recording: their names are never interned
+    constexpr const char * shared_zone_name = "ScopeTimer";
 }
 
 ScopeTimer::ScopeTimer()
-    : ScopeTimer(GetNextUniqueID())
+    : m_id(GetNextUniqueID())
+    , m_zone(shared_zone_name)
 {
+    Run();
 }
 
 ScopeTimer::ScopeTimer(std::string name)
     : m_id(std::move(name))
+    , m_zone(trace::is_recording() ? trace::intern(m_id) : shared_zone_name)
 {
     Run();
-    ++m_active_timers;
 }
 
 ScopeTimer::~ScopeTimer()
@@ -37,9 +45,12 @@ ScopeTimer::~ScopeTimer()
     Stop();
     auto elapsed = Tick<std::chrono::microseconds>();
 
-    std::cout << "Timer '" << m_id << "' Elapsed in: '" << elapsed.count() << "' microseconds" << std::endl;
+    // One write without a flush: timers on different threads do not interleave mid-line and the scope does
+    // not pay for a console round trip
+    std::ostringstream line;
+    line << "Timer '" << m_id << "' Elapsed in: '" << elapsed.count() << "' microseconds\n";
 
-    --m_active_timers;
+    std::cout << line.str();
 }
 
 std::string ScopeTimer::GetNextUniqueID()
@@ -47,7 +58,7 @@ std::string ScopeTimer::GetNextUniqueID()
     std::stringstream id;
 
     id << "Timer #";
-    id << m_active_timers;
+    id << m_next_id.fetch_add(1, std::memory_order_relaxed);
 
     return id.str();
 }
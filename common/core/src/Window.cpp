@@ -41,28 +41,38 @@ Window::~Window()
     Close();
 }
 
-std::vector<SDL_Event> Window::PollEvents()
+std::vector<SDL_Event> Window::PollEvents(std::chrono::milliseconds timeout)
 {
     SDL_Event event;
     std::vector<SDL_Event> events;
 
-    while (SDL_PollEvent(&event))
+    if (timeout.count() > 0 && SDL_WaitEventTimeout(&event, static_cast<int>(timeout.count())))
     {
         events.emplace_back(event);
+        HandleEvent(event);
+    }
 
-        if (event.type == SDL_WINDOWEVENT
-            && event.window.event == SDL_WINDOWEVENT_RESIZED
-            && event.window.windowID == SDL_GetWindowID(m_window))
-        {
-            CleanupRenderTarget();
-            m_pSwapChain->ResizeBuffers(0, 0, 0, DXGI_FORMAT_UNKNOWN, 0);
-            CreateRenderTarget();
-        }
+    while (SDL_PollEvent(&event))
+    {
+        events.emplace_back(event);
+        HandleEvent(event);
     }
 
     return events;
 }
 
+void Window::HandleEvent(const SDL_Event& event)
+{
+    if (event.type == SDL_WINDOWEVENT
+        && event.window.event == SDL_WINDOWEVENT_RESIZED
+        && event.window.windowID == SDL_GetWindowID(m_window))
+    {
+        CleanupRenderTarget();
+        m_pSwapChain->ResizeBuffers(0, 0, 0, DXGI_FORMAT_UNKNOWN, 0);
+        CreateRenderTarget();
+    }
+}
+
 void Window::Close()
 {
     CleanupDeviceD3D();
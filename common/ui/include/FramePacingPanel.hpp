@@ -0,0 +1,65 @@
+#pragma once
+
+#include <imgui.h>
+
+#include <core/include/FramePacer.hpp>
+
+#include <array>
+
+// Header-only like the lock profiler panel, so core stays free of ImGui
+namespace retro::ui
+{
+    // Frame pacing controls and how much of the UI thread the frames take. Comparing a benchmark's spread
+    // with pacing on and off shows how much noise the render loop adds
+    inline void RenderFramePacingPanel()
+    {
+        constexpr std::array<const char *, 3> state_names = { "Interactive", "Busy", "Idle" };
+
+        auto& pacer = core::FramePacer::Get();
+        auto& settings = pacer.GetSettings();
+
+        ImGui::Begin("Frame pacing");
+
+        if (ImGui::Checkbox("Adaptive", &settings.is_adaptive))
+        {
+            pacer.ResetStatistics();
+        }
+
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("Off renders every frame, like a plain render loop");
+        }
+
+        ImGui::SliderInt("Refresh while a job runs, fps", &settings.busy_fps, 1, 60);
+
+        int input_grace_ms = static_cast<int>(settings.input_grace.count());
+        if (ImGui::SliderInt("Full rate after input, ms", &input_grace_ms, 0, 2000))
+        {
+            settings.input_grace = std::chrono::milliseconds(input_grace_ms);
+        }
+
+        int idle_timeout_ms = static_cast<int>(settings.idle_timeout.count());
+        if (ImGui::SliderInt("Idle wake-up, ms", &idle_timeout_ms, 100, 5000))
+        {
+            settings.idle_timeout = std::chrono::milliseconds(idle_timeout_ms);
+        }
+
+        const auto& statistics = pacer.GetStatistics();
+        const auto total_seconds = statistics.waiting_seconds + statistics.working_seconds;
+
+        ImGui::Text("State: %s, %d job(s) running", state_names.at(static_cast<size_t>(pacer.GetState())), pacer.GetRunningJobs());
+
+        if (total_seconds > 0.0)
+        {
+            ImGui::Text("Frames per second: %.1f", static_cast<double>(statistics.frames) / total_seconds);
+            ImGui::Text("UI thread busy: %.1f%% (vsync wait included)", statistics.working_seconds / total_seconds * 100.0);
+        }
+
+        if (ImGui::Button("Reset statistics"))
+        {
+            pacer.ResetStatistics();
+        }
+
+        ImGui::End();
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <imgui.h>
+
+#include <wrappers/include/lock_profiler.hpp>
+
+#include <string>
+
+// Header-only so the wrappers stay free of ImGui: any lab that links the wrappers and renders ImGui can show it
+namespace retro::ui
+{
+    namespace detail
+    {
+        inline void DrawLockStatsRow(const mutex::profiling::stats& row)
+        {
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%llu", static_cast<unsigned long long>(row.acquisitions));
+
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.2f%%", row.contention_ratio() * 100.0);
+
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.3f", static_cast<double>(row.wait_ns_total) / 1e6);
+
+            ImGui::TableSetColumnIndex(4);
+            ImGui::Text("%.2f", static_cast<double>(row.wait_ns_max) / 1e3);
+
+            ImGui::TableSetColumnIndex(5);
+            ImGui::Text("%.3f", static_cast<double>(row.hold_ns_total) / 1e6);
+
+            ImGui::TableSetColumnIndex(6);
+            ImGui::Text("%.2f", static_cast<double>(row.hold_ns_max) / 1e3);
+        }
+    }
+
+    // Lock contention window. Drains the profiler's per-thread buffers every frame it is drawn
+    inline void RenderLockProfilerPanel()
+    {
+        static char dump_path[256] = "lock_profile.txt";
+        static std::string dump_status;
+
+        ImGui::Begin("Lock profiler");
+
+        if constexpr (!mutex::profiling::is_enabled)
+        {
+            ImGui::TextWrapped("Built without lock profiling, reconfigure with -DRLIB_LOCK_PROFILING=ON to record winmutex and adaptive_mutex contention");
+            ImGui::End();
+            return;
+        }
+
+        const auto report = mutex::profiling::collect();
+
+        if (ImGui::Button("Reset"))
+        {
+            mutex::profiling::reset();
+        }
+
+        ImGui::SameLine();
+        if (ImGui::Button("Dump"))
+        {
+            dump_status = mutex::profiling::dump(dump_path) ? std::string("Written to ") + dump_path : std::string("Could not write ") + dump_path;
+        }
+
+        ImGui::SameLine();
+        ImGui::InputText("File", dump_path, sizeof(dump_path));
+
+        if (!dump_status.empty())
+        {
+            ImGui::Text("%s", dump_status.c_str());
+        }
+
+        ImGui::Text("Dropped events: %llu", static_cast<unsigned long long>(report.dropped));
+
+        if (report.locks.empty())
+        {
+            ImGui::Text("No lock was taken yet");
+        }
+        else if (ImGui::BeginTable("Lock profile", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg))
+        {
+            ImGui::TableSetupColumn("Lock / call site");
+            ImGui::TableSetupColumn("Acquired");
+            ImGui::TableSetupColumn("Contended");
+            ImGui::TableSetupColumn("Wait total, ms");
+            ImGui::TableSetupColumn("Wait max, us");
+            ImGui::TableSetupColumn("Hold total, ms");
+            ImGui::TableSetupColumn("Hold max, us");
+            ImGui::TableHeadersRow();
+
+            for (const auto& lock : report.locks)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+
+                const bool is_open = ImGui::TreeNodeEx(lock.address, ImGuiTreeNodeFlags_SpanFullWidth, "%s", lock.name.c_str());
+                detail::DrawLockStatsRow(lock);
+
+                if (is_open)
+                {
+                    for (const auto& site : lock.sites)
+                    {
+                        ImGui::TableNextRow();
+                        ImGui::TableSetColumnIndex(0);
+
+                        ImGui::Text("%s:%u", site.file, site.line);
+
+                        if (ImGui::IsItemHovered())
+                        {
+                            ImGui::SetTooltip("%s", site.function);
+                        }
+
+                        detail::DrawLockStatsRow(site);
+                    }
+
+                    ImGui::TreePop();
+                }
+            }
+
+            ImGui::EndTable();
+        }
+
+        ImGui::End();
+    }
+}
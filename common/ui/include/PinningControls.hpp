@@ -0,0 +1,45 @@
+#pragma once
+
+#include <imgui.h>
+
+#include <wrappers/include/topology.hpp>
+
+#if defined(_OPENMP)
+# include <omp.h>
+#endif
+
+// Header-only like the other panels, shared by every lab with a "Pinning" combo
+namespace retro::ui
+{
+    namespace detail
+    {
+        // Selected in the "Pinning" combo, index into thread::pin_policy_names
+        inline int pinning = 0;
+    }
+
+    inline thread::pin_policy GetPinPolicy()
+    {
+        return static_cast<thread::pin_policy>(detail::pinning);
+    }
+
+    // The tooltip shows the machine's topology, what the policies map onto
+    inline void DrawPinningCombo()
+    {
+        ImGui::Combo("Pinning", &detail::pinning, thread::pin_policy_names.data(), static_cast<int>(thread::pin_policy_names.size()));
+
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("%s", thread::topology::current().describe().c_str());
+        }
+    }
+
+#if defined(_OPENMP)
+    // The OpenMP team of a thread is reused by all of its parallel regions, so pinning it in a region of its
+    // own holds for the kernel that follows. Has to run on the thread that runs the kernel
+    inline void PinOpenMPTeam(thread::pin_policy policy)
+    {
+#pragma omp parallel
+        thread::pin_current_thread(policy, static_cast<uint32_t>(omp_get_thread_num()));
+    }
+#endif
+}
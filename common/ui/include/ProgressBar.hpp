@@ -0,0 +1,20 @@
+#pragma once
+
+#include <imgui.h>
+
+#include <wrappers/include/progress.hpp>
+
+#include <chrono>
+#include <string>
+
+namespace retro::ui
+{
+    // Fraction done and the estimated time left of a long-running lab job
+    inline void DrawProgress(const thread::progress& progress)
+    {
+        const auto eta = std::chrono::duration<double>(progress.eta()).count();
+        const auto overlay = std::to_string(static_cast<int>(progress.fraction() * 100.0F)) + "%, ETA " + std::to_string(eta) + " s";
+
+        ImGui::ProgressBar(progress.fraction(), ImVec2(-FLT_MIN, 0), overlay.c_str());
+    }
+}
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <imgui.h>
+
+#include <wrappers/include/trace.hpp>
+
+#include <map>
+#include <array>
+#include <string>
+#include <algorithm>
+
+// Header-only like the lock profiler panel, so the wrappers stay free of ImGui
+namespace retro::ui
+{
+    namespace detail
+    {
+        struct ZoneTotals
+        {
+            uint64_t count = 0;
+            uint64_t total_ns = 0;
+            uint64_t max_ns = 0;
+        };
+
+        inline ImU32 ZoneColor(const char * name)
+        {
+            // Same name, same color across threads and frames
+            constexpr std::array<ImU32, 6> palette =
+            {
+                IM_COL32(86, 156, 214, 255),
+                IM_COL32(78, 201, 176, 255),
+                IM_COL32(220, 160, 90, 255),
+                IM_COL32(197, 134, 192, 255),
+                IM_COL32(214, 106, 106, 255),
+                IM_COL32(160, 190, 90, 255)
+            };
+
+            size_t hash = 0;
+
+            for (const auto * pSymbol = name; *pSymbol != '\0'; pSymbol++)
+            {
+                hash = hash * 31 + static_cast<unsigned char>(*pSymbol);
+            }
+
+            return palette.at(hash % palette.size());
+        }
+
+        // One lane per thread, nested zones stacked under their parents
+        inline void DrawTimeline(const trace::snapshot& snapshot)
+        {
+            constexpr float row_height = 16.0F;
+            constexpr float label_width = 130.0F;
+
+            const auto span_ns = static_cast<double>(std::max<uint64_t>(snapshot.end_ns - snapshot.begin_ns, 1));
+
+            auto * pDrawList = ImGui::GetWindowDrawList();
+            const auto width = std::max(ImGui::GetContentRegionAvail().x - label_width, 1.0F);
+
+            for (const auto& thread : snapshot.threads)
+            {
+                uint16_t max_depth = 0;
+
+                for (const auto& recorded : thread.events)
+                {
+                    if (recorded.kind == trace::event_kind::zone)
+                    {
+                        max_depth = std::max(max_depth, recorded.depth);
+                    }
+                }
+
+                const auto origin = ImGui::GetCursorScreenPos();
+                const auto lane_height = row_height * static_cast<float>(max_depth + 1);
+
+                pDrawList->AddText(origin, IM_COL32(200, 200, 200, 255), thread.name.c_str());
+
+                for (const auto& recorded : thread.events)
+                {
+                    if (recorded.kind != trace::event_kind::zone)
+                    {
+                        continue;
+                    }
+
+                    const auto start = static_cast<double>(std::max(recorded.start_ns, snapshot.begin_ns) - snapshot.begin_ns);
+                    const auto end = static_cast<double>(std::min(recorded.start_ns + recorded.duration_ns, snapshot.end_ns) - snapshot.begin_ns);
+
+                    const ImVec2 min(origin.x + label_width + static_cast<float>(start / span_ns) * width, origin.y + row_height * recorded.depth);
+                    const ImVec2 max(std::max(origin.x + label_width + static_cast<float>(end / span_ns) * width, min.x + 1.0F), min.y + row_height - 1.0F);
+
+                    pDrawList->AddRectFilled(min, max, ZoneColor(recorded.name));
+
+                    if (max.x - min.x > 40.0F)
+                    {
+                        pDrawList->PushClipRect(min, max, true);
+                        pDrawList->AddText(ImVec2(min.x + 2.0F, min.y), IM_COL32(0, 0, 0, 255), recorded.name);
+                        pDrawList->PopClipRect();
+                    }
+
+                    if (ImGui::IsMouseHoveringRect(min, max))
+                    {
+                        ImGui::SetTooltip("%s\n%s\n%.3f ms", thread.name.c_str(), recorded.name, static_cast<double>(recorded.duration_ns) / 1e6);
+                    }
+                }
+
+                ImGui::Dummy(ImVec2(label_width + width, lane_height + 4.0F));
+            }
+        }
+
+        // Per thread: where the time of the window went. Busy is the outermost zones only, nested ones would
+        // count twice
+        inline void DrawZoneTotals(const trace::snapshot& snapshot)
+        {
+            const auto span_ns = static_cast<double>(std::max<uint64_t>(snapshot.end_ns - snapshot.begin_ns, 1));
+
+            if (!ImGui::BeginTable("Zone totals", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_RowBg))
+            {
+                return;
+            }
+
+            ImGui::TableSetupColumn("Thread / zone");
+            ImGui::TableSetupColumn("Count");
+            ImGui::TableSetupColumn("Total ms");
+            ImGui::TableSetupColumn("Max ms");
+            ImGui::TableSetupColumn("Busy");
+            ImGui::TableHeadersRow();
+
+            for (const auto& thread : snapshot.threads)
+            {
+                std::map<std::string, ZoneTotals> zones;
+                uint64_t busy_ns = 0;
+
+                for (const auto& recorded : thread.events)
+                {
+                    if (recorded.kind != trace::event_kind::zone)
+                    {
+                        continue;
+                    }
+
+                    auto& totals = zones[recorded.name];
+
+                    totals.count++;
+                    totals.total_ns += recorded.duration_ns;
+                    totals.max_ns = std::max(totals.max_ns, recorded.duration_ns);
+
+                    busy_ns += recorded.depth == 0 ? recorded.duration_ns : 0;
+                }
+
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", thread.name.c_str());
+
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%.1f%%", std::min(static_cast<double>(busy_ns) / span_ns, 1.0) * 100.0);
+
+                for (const auto& [name, totals] : zones)
+                {
+                    ImGui::TableNextRow();
+
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::Text("  %s", name.c_str());
+
+                    ImGui::TableSetColumnIndex(1);
+                    ImGui::Text("%llu", static_cast<unsigned long long>(totals.count));
+
+                    ImGui::TableSetColumnIndex(2);
+                    ImGui::Text("%.3f", static_cast<double>(totals.total_ns) / 1e6);
+
+                    ImGui::TableSetColumnIndex(3);
+                    ImGui::Text("%.3f", static_cast<double>(totals.max_ns) / 1e6);
+                }
+            }
+
+            ImGui::EndTable();
+        }
+
+        inline void DrawCounters(const trace::snapshot& snapshot)
+        {
+            // Latest value of every counter over all threads
+            std::map<std::string, trace::event> latest;
+
+            for (const auto& thread : snapshot.threads)
+            {
+                for (const auto& recorded : thread.events)
+                {
+                    if (recorded.kind != trace::event_kind::counter)
+                    {
+                        continue;
+                    }
+
+                    auto& slot = latest[recorded.name];
+
+                    if (recorded.start_ns >= slot.start_ns)
+                    {
+                        slot = recorded;
+                    }
+                }
+            }
+
+            for (const auto& [name, recorded] : latest)
+            {
+                ImGui::Text("%s: %g", name.c_str(), recorded.value);
+            }
+        }
+    }
+
+    // Timeline of the last few seconds per thread, and the Chrome trace export of the whole history. Drains the
+    // trace rings every frame it is drawn, unless frozen
+    inline void RenderTracePanel()
+    {
+        static char export_path[256] = "trace.json";
+        static std::string export_status;
+
+        static float window_seconds = 1.0F;
+        static bool is_frozen = false;
+
+        static trace::snapshot snapshot;
+
+        ImGui::Begin("Trace");
+
+        bool is_recording = trace::is_recording();
+
+        if (ImGui::Checkbox("Record", &is_recording))
+        {
+            is_recording ? trace::start() : trace::stop();
+        }
+
+        ImGui::SameLine();
+        ImGui::Checkbox("Freeze", &is_frozen);
+
+        ImGui::SameLine();
+        if (ImGui::Button("Reset"))
+        {
+            trace::reset();
+        }
+
+        ImGui::SameLine();
+        if (ImGui::Button("Export"))
+        {
+            export_status = trace::export_chrome(export_path) ? std::string("Written to ") + export_path : std::string("Could not write ") + export_path;
+        }
+
+        ImGui::SameLine();
+        ImGui::InputText("File", export_path, sizeof(export_path));
+
+        if (!export_status.empty())
+        {
+            ImGui::Text("%s", export_status.c_str());
+        }
+
+        const auto history_seconds = static_cast<float>(trace::history().count()) / 1000.0F;
+        ImGui::SliderFloat("Window, s", &window_seconds, 0.01F, history_seconds, "%.2f", ImGuiSliderFlags_Logarithmic);
+
+        if (!is_frozen)
+        {
+            snapshot = trace::collect(std::chrono::milliseconds(static_cast<int64_t>(window_seconds * 1000.0F)));
+        }
+
+        ImGui::Text("Dropped events: %llu", static_cast<unsigned long long>(snapshot.dropped));
+
+        if (snapshot.threads.empty())
+        {
+            ImGui::Text("%s", is_recording ? "Nothing recorded in the window yet" : "Not recording");
+        }
+        else
+        {
+            detail::DrawCounters(snapshot);
+
+            if (ImGui::CollapsingHeader("Timeline", ImGuiTreeNodeFlags_DefaultOpen))
+            {
+                detail::DrawTimeline(snapshot);
+            }
+
+            if (ImGui::CollapsingHeader("Zone totals"))
+            {
+                detail::DrawZoneTotals(snapshot);
+            }
+        }
+
+        ImGui::End();
+    }
+}
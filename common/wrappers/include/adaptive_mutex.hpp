@@ -0,0 +1,67 @@
+#pragma once
+
+#include <lock_profiler.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+namespace retro::mutex
+{
+    // Process-local replacement for winmutex: an uncontended lock()/unlock() pair is a single atomic each,
+    // a contended lock() spins for a bounded number of rounds and only then parks on the lock word through
+    // a futex (WaitOnAddress on Windows). Satisfies Lockable, so it works with std::lock_guard and friends
+    class adaptive_mutex
+    {
+    public:
+
+        explicit adaptive_mutex(uint32_t spin_limit = 128);
+
+        adaptive_mutex(const adaptive_mutex&) = delete;
+
+        adaptive_mutex& operator=(const adaptive_mutex&) = delete;
+
+#if defined(RETRO_LOCK_PROFILING)
+        void lock(std::source_location site = std::source_location::current());
+
+        bool try_lock(std::source_location site = std::source_location::current());
+#else
+        void lock();
+
+        bool try_lock();
+#endif
+
+        void unlock();
+
+        // Label for the lock profiler, has to outlive the lock. Does nothing without RETRO_LOCK_PROFILING
+        void set_name(const char * name)
+        {
+#if defined(RETRO_LOCK_PROFILING)
+            m_probe.set_name(name);
+#else
+            (void)name;
+#endif
+        }
+
+    protected:
+
+        void lock_contended();
+
+    protected:
+
+        enum state : uint32_t
+        {
+            unlocked = 0,
+            locked = 1,
+            locked_with_waiters = 2
+        };
+
+        uint32_t m_spin_limit;
+
+        std::atomic<uint32_t> m_state { unlocked };
+
+#if defined(RETRO_LOCK_PROFILING)
+        profiling::lock_probe m_probe;
+#endif
+
+    };
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cpu.hpp>
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+// Synchronization points for iterative kernels that keep the same threads across all iterations. Every
+// wait spins for a bounded number of rounds first (the other participants are usually a few hundred
+// nanoseconds behind) and only then parks on a futex, so an idle team does not burn cores
+namespace retro::sync
+{
+    // Single use countdown: wait() returns once count_down() brought the counter to zero
+    class latch
+    {
+    public:
+
+        explicit latch(uint32_t count, uint32_t spin_limit = 4096);
+
+        latch(const latch&) = delete;
+
+        latch& operator=(const latch&) = delete;
+
+        void count_down(uint32_t amount = 1);
+
+        [[nodiscard]] bool try_wait() const;
+
+        void wait() const;
+
+        void arrive_and_wait(uint32_t amount = 1);
+
+    private:
+
+        uint32_t m_spin_limit;
+
+        mutable std::atomic<uint32_t> m_remaining;
+
+    };
+
+    // Central sense-reversing barrier. The sense is the whole phase counter rather than a single bit: the
+    // last thread to arrive refills the counter and bumps the phase, everybody else waits for the phase
+    // they saw on arrival to change. A full counter also gives the futex a value that never repeats
+    // between two consecutive waits
+    class barrier
+    {
+    public:
+
+        explicit barrier(uint32_t count, uint32_t spin_limit = 4096);
+
+        barrier(const barrier&) = delete;
+
+        barrier& operator=(const barrier&) = delete;
+
+        // Returns true on exactly one thread per phase, the one that completed it
+        bool arrive_and_wait();
+
+        [[nodiscard]] uint32_t count() const;
+
+    private:
+
+        uint32_t m_count;
+        uint32_t m_spin_limit;
+
+        alignas(cache_line_size) std::atomic<uint32_t> m_remaining;
+        alignas(cache_line_size) std::atomic<uint32_t> m_phase { 0 };
+        std::atomic<uint32_t> m_sleepers { 0 };
+
+    };
+
+    // Combining tree barrier for many cores: participants arrive in groups of fan_in on separate cache
+    // lines and only the last of each group climbs to the parent, so no counter sees more than fan_in
+    // writers per phase. Release is still a single phase word. With count <= fan_in it degenerates into
+    // the central barrier above
+    class tree_barrier
+    {
+    public:
+
+        static constexpr uint32_t fan_in = 4;
+
+        explicit tree_barrier(uint32_t count, uint32_t spin_limit = 4096);
+
+        tree_barrier(const tree_barrier&) = delete;
+
+        tree_barrier& operator=(const tree_barrier&) = delete;
+
+        // index is the caller's slot in [0, count), every participant has to use its own for the lifetime
+        // of the barrier. Returns true on exactly one thread per phase, the one that completed it
+        bool arrive_and_wait(uint32_t index);
+
+        [[nodiscard]] uint32_t count() const;
+
+    private:
+
+        struct alignas(cache_line_size) node
+        {
+            std::atomic<uint32_t> remaining { 0 };
+            uint32_t count = 0;
+            uint32_t parent = 0;
+        };
+
+        static constexpr uint32_t no_parent = UINT32_MAX;
+
+        uint32_t m_count;
+        uint32_t m_spin_limit;
+
+        std::unique_ptr<node[]> m_nodes;
+
+        alignas(cache_line_size) std::atomic<uint32_t> m_phase { 0 };
+        std::atomic<uint32_t> m_sleepers { 0 };
+
+    };
+
+    // Barrier with dynamic membership, in the spirit of java.util.concurrent.Phaser: parties may register
+    // and deregister between phases, and may arrive without waiting. At most 65535 parties
+    class phaser
+    {
+    public:
+
+        explicit phaser(uint32_t parties = 0, uint32_t spin_limit = 4096);
+
+        phaser(const phaser&) = delete;
+
+        phaser& operator=(const phaser&) = delete;
+
+        // Adds a party to the current phase, returns that phase
+        uint32_t register_party();
+
+        // Arrives without waiting, returns the phase arrived at
+        uint32_t arrive();
+
+        // Arrives and leaves for good, returns the phase arrived at
+        uint32_t arrive_and_deregister();
+
+        // Arrives and waits for everybody else, returns the new phase
+        uint32_t arrive_and_wait();
+
+        // Waits until the given phase is over, returns the new phase
+        uint32_t await_advance(uint32_t phase) const;
+
+        [[nodiscard]] uint32_t get_phase() const;
+
+        [[nodiscard]] uint32_t get_registered_parties() const;
+
+    private:
+
+        // phase:32 | parties:16 | unarrived:16 in a single word, so an arrival and the phase it belongs to
+        // can never be observed out of sync
+        static constexpr uint64_t party_mask = 0xFFFF;
+        static constexpr uint32_t parties_shift = 16;
+        static constexpr uint32_t phase_shift = 32;
+
+        static uint64_t pack(uint32_t phase, uint32_t parties, uint32_t unarrived);
+
+        uint32_t arrive(uint32_t parties_delta);
+
+    private:
+
+        uint32_t m_spin_limit;
+
+        alignas(cache_line_size) std::atomic<uint64_t> m_state;
+
+        // Mirror of the phase bits for waiting, futexes only come in 32 bits. Only ever moves forward
+        alignas(cache_line_size) mutable std::atomic<uint32_t> m_phase;
+        mutable std::atomic<uint32_t> m_sleepers { 0 };
+
+    };
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+namespace retro::concurrent
+{
+    // Chase-Lev work-stealing deque (Le, Pop, Cohen, Nardelli, "Correct and Efficient Work-Stealing for Weak
+    // Memory Models"). The owning thread pushes and pops at the bottom, any other thread steals from the top.
+    // Items are stored by value in atomics, so T is meant to be a pointer or another small trivially copyable type
+    template<typename T>
+    class chase_lev_deque
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "chase_lev_deque items must be trivially copyable");
+
+    public:
+
+        explicit chase_lev_deque(int64_t capacity = 256)
+        {
+            int64_t rounded = 1;
+            while (rounded < capacity)
+            {
+                rounded <<= 1;
+            }
+
+            m_retired.emplace_back(std::make_unique<ring>(rounded));
+            m_ring.store(m_retired.back().get(), std::memory_order_relaxed);
+        }
+
+        chase_lev_deque(const chase_lev_deque&) = delete;
+
+        chase_lev_deque& operator=(const chase_lev_deque&) = delete;
+
+        // Owner only
+        void push(T item)
+        {
+            const auto bottom = m_bottom.load(std::memory_order_relaxed);
+            const auto top = m_top.load(std::memory_order_acquire);
+            auto * pRing = m_ring.load(std::memory_order_relaxed);
+
+            if (bottom - top > pRing->capacity - 1)
+            {
+                pRing = grow(pRing, bottom, top);
+            }
+
+            pRing->put(bottom, item);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        // Owner only
+        std::optional<T> pop()
+        {
+            const auto bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            auto * pRing = m_ring.load(std::memory_order_relaxed);
+
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto top = m_top.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+
+            std::optional<T> item = pRing->get(bottom);
+
+            if (top == bottom)
+            {
+                // Last item, race the thieves for it
+                if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    item = std::nullopt;
+                }
+
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+
+            return item;
+        }
+
+        // Any thread. Returns nothing either when the deque is empty or when another thief won the race
+        std::optional<T> steal()
+        {
+            auto top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const auto bottom = m_bottom.load(std::memory_order_acquire);
+
+            if (top >= bottom)
+            {
+                return std::nullopt;
+            }
+
+            auto * pRing = m_ring.load(std::memory_order_acquire);
+            T item = pRing->get(top);
+
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return std::nullopt;
+            }
+
+            return item;
+        }
+
+        [[nodiscard]] int64_t size() const
+        {
+            const auto bottom = m_bottom.load(std::memory_order_relaxed);
+            const auto top = m_top.load(std::memory_order_relaxed);
+
+            return bottom > top ? bottom - top : 0;
+        }
+
+        [[nodiscard]] bool empty() const
+        {
+            return size() == 0;
+        }
+
+    private:
+
+        struct ring
+        {
+            explicit ring(int64_t size)
+                : capacity(size)
+                , mask(size - 1)
+                , items(std::make_unique<std::atomic<T>[]>(static_cast<size_t>(size)))
+            {
+            }
+
+            void put(int64_t index, T item)
+            {
+                items[static_cast<size_t>(index & mask)].store(item, std::memory_order_relaxed);
+            }
+
+            T get(int64_t index) const
+            {
+                return items[static_cast<size_t>(index & mask)].load(std::memory_order_relaxed);
+            }
+
+            int64_t capacity;
+            int64_t mask;
+            std::unique_ptr<std::atomic<T>[]> items;
+        };
+
+        ring * grow(ring * pOld, int64_t bottom, int64_t top)
+        {
+            auto next = std::make_unique<ring>(pOld->capacity * 2);
+
+            for (auto i = top; i < bottom; i++)
+            {
+                next->put(i, pOld->get(i));
+            }
+
+            // Thieves may still be reading the old ring, so it is only freed together with the deque
+            auto * pNext = next.get();
+            m_retired.emplace_back(std::move(next));
+            m_ring.store(pNext, std::memory_order_release);
+
+            return pNext;
+        }
+
+    private:
+
+        alignas(64) std::atomic<int64_t> m_top { 0 };
+        alignas(64) std::atomic<int64_t> m_bottom { 0 };
+        alignas(64) std::atomic<ring *> m_ring { nullptr };
+
+        std::vector<std::unique_ptr<ring>> m_retired;
+
+    };
+}
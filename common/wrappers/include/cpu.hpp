@@ -0,0 +1,68 @@
+#pragma once
+
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+# include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
+# include <immintrin.h>
+#endif
+
+namespace retro::sync
+{
+    // Hardcoded instead of std::hardware_destructive_interference_size, which is not stable across compilers
+    constexpr size_t cache_line_size = 64;
+
+    // Spin-wait hint: lets the sibling hyper-thread run and avoids the memory order violation penalty
+    // when the spun-on line finally changes
+    inline void cpu_relax()
+    {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+        _mm_pause();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+        __yield();
+#elif defined(__i386__) || defined(__x86_64__)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield" ::: "memory");
+#endif
+    }
+
+    // Busy-wait helper for spin loops: pauses with a growing number of hints first, then starts giving the
+    // time slice away, so a lock holder that got preempted (more threads than cores) can still finish
+    class backoff
+    {
+    public:
+
+        void pause()
+        {
+            if (m_rounds < yield_threshold)
+            {
+                for (uint32_t i = 0; i < (1U << m_rounds); i++)
+                {
+                    cpu_relax();
+                }
+
+                m_rounds++;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        void reset()
+        {
+            m_rounds = 0;
+        }
+
+    private:
+
+        static constexpr uint32_t yield_threshold = 10;
+
+        uint32_t m_rounds { 0 };
+
+    };
+}
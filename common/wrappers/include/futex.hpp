@@ -0,0 +1,21 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace retro::sync
+{
+    // Thin layer over futex(2) on Linux and WaitOnAddress on Windows, other platforms fall back to
+    // std::atomic::wait. All waits may return spuriously, callers always re-check the word
+
+    // Blocks while word == expected
+    void futex_wait(std::atomic<uint32_t>& word, uint32_t expected);
+
+    // Same, but gives up after timeout. Returns false on timeout
+    bool futex_wait_for(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout);
+
+    void futex_wake_one(std::atomic<uint32_t>& word);
+
+    void futex_wake_all(std::atomic<uint32_t>& word);
+}
@@ -0,0 +1,597 @@
+#pragma once
+
+#include <pool.hpp>
+#include <spin_locks.hpp>
+#include <unique_function.hpp>
+
+#include <mutex>
+#include <tuple>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <variant>
+#include <optional>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+
+// Futures for pool jobs. A future is single-consumer: get() and then() both take the value out of it and
+// leave the future invalid, so values travel down a pipeline by moves only. Continuations added by then()
+// run as pool jobs; when_all/when_any only count arrivals inline on whatever thread completes an input
+namespace retro::thread
+{
+    template<typename T>
+    class future;
+
+    template<typename T>
+    class promise;
+
+    template<typename T>
+    struct when_any_result
+    {
+        size_t index = 0;
+        T value;
+    };
+
+    template<>
+    struct when_any_result<void>
+    {
+        size_t index = 0;
+    };
+
+    namespace detail
+    {
+        template<typename T>
+        struct future_state
+        {
+            using value_type = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+            std::optional<value_type> value;
+            std::exception_ptr exception { nullptr };
+
+            std::atomic<bool> is_ready { false };
+
+            mutex::ttas_lock lock;
+            std::vector<unique_function<void()>> continuations;
+
+            // Where then() continuations are submitted, the shared pool when not set
+            pool * executor { nullptr };
+
+            // Runs the continuation right away if the state is already complete, otherwise on the completing thread
+            void on_ready(unique_function<void()> continuation)
+            {
+                {
+                    std::lock_guard guard(lock);
+
+                    if (!is_ready.load(std::memory_order_relaxed))
+                    {
+                        continuations.push_back(std::move(continuation));
+                        return;
+                    }
+                }
+
+                continuation();
+            }
+
+            void complete()
+            {
+                std::vector<unique_function<void()>> pending;
+                {
+                    std::lock_guard guard(lock);
+
+                    is_ready.store(true, std::memory_order_release);
+                    pending.swap(continuations);
+                }
+
+                is_ready.notify_all();
+
+                for (auto& continuation : pending)
+                {
+                    continuation();
+                }
+            }
+
+            // Same as pool::handle::wait(): a pool worker keeps running other jobs instead of blocking
+            void wait() const
+            {
+                if (auto * pPool = pool::current())
+                {
+                    while (!is_ready.load(std::memory_order_acquire))
+                    {
+                        if (!pPool->try_run_pending())
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+                else
+                {
+                    is_ready.wait(false, std::memory_order_acquire);
+                }
+            }
+        };
+
+        struct future_access
+        {
+            template<typename T>
+            static std::shared_ptr<future_state<T>> release(future<T>& source)
+            {
+                if (!source.m_state)
+                {
+                    throw std::runtime_error("Error: Future has no state");
+                }
+
+                return std::move(source.m_state);
+            }
+        };
+
+        template<typename Func, typename T>
+        struct continuation_result
+        {
+            using type = std::invoke_result_t<Func, T&&>;
+        };
+
+        template<typename Func>
+        struct continuation_result<Func, void>
+        {
+            using type = std::invoke_result_t<Func>;
+        };
+
+        template<typename Func, typename T>
+        using continuation_result_t = typename continuation_result<std::decay_t<Func>&, T>::type;
+
+        // Invokes func and hands its result, or whatever it threw, over to target
+        template<typename R, typename Func, typename... Args>
+        void fulfil(promise<R>& target, Func& func, Args&&... args)
+        {
+            try
+            {
+                if constexpr (std::is_void_v<R>)
+                {
+                    std::invoke(func, std::forward<Args>(args)...);
+                    target.set_value();
+                }
+                else
+                {
+                    target.set_value(std::invoke(func, std::forward<Args>(args)...));
+                }
+            }
+            catch (...)
+            {
+                target.set_exception(std::current_exception());
+            }
+        }
+    }
+
+    template<typename T>
+    class promise
+    {
+    public:
+
+        explicit promise(pool * pExecutor = nullptr)
+            : m_state(std::make_shared<detail::future_state<T>>())
+        {
+            m_state->executor = pExecutor;
+        }
+
+        promise(promise&& other) noexcept = default;
+
+        promise& operator=(promise&& other) noexcept
+        {
+            if (this != &other)
+            {
+                abandon();
+
+                m_state = std::move(other.m_state);
+                m_is_retrieved = other.m_is_retrieved;
+            }
+
+            return *this;
+        }
+
+        promise(const promise&) = delete;
+
+        promise& operator=(const promise&) = delete;
+
+        ~promise()
+        {
+            abandon();
+        }
+
+        future<T> get_future()
+        {
+            if (!m_state || m_is_retrieved)
+            {
+                throw std::runtime_error("Error: Future already retrieved");
+            }
+
+            m_is_retrieved = true;
+            return future<T>(m_state);
+        }
+
+        template<typename... Values>
+        void set_value(Values&&... values)
+        {
+            check_unsatisfied();
+
+            m_state->value.emplace(std::forward<Values>(values)...);
+            m_state->complete();
+        }
+
+        void set_exception(std::exception_ptr exception)
+        {
+            check_unsatisfied();
+
+            m_state->exception = std::move(exception);
+            m_state->complete();
+        }
+
+    private:
+
+        // Only the promise writes the state, so its own view of is_ready tells whether it was satisfied
+        void check_unsatisfied() const
+        {
+            if (!m_state || m_state->is_ready.load(std::memory_order_relaxed))
+            {
+                throw std::runtime_error("Error: Promise already satisfied");
+            }
+        }
+
+        // A promise dropped without a result fails its future instead of leaving the waiters hanging
+        void abandon()
+        {
+            if (m_state && !m_state->is_ready.load(std::memory_order_relaxed))
+            {
+                m_state->exception = std::make_exception_ptr(std::runtime_error("Error: Broken promise"));
+                m_state->complete();
+            }
+        }
+
+    private:
+
+        std::shared_ptr<detail::future_state<T>> m_state;
+
+        bool m_is_retrieved { false };
+
+    };
+
+    template<typename T>
+    class future
+    {
+    public:
+
+        using value_type = T;
+
+        future() = default;
+
+        future(future&& other) noexcept = default;
+
+        future& operator=(future&& other) noexcept = default;
+
+        future(const future&) = delete;
+
+        future& operator=(const future&) = delete;
+
+        [[nodiscard]] bool is_valid() const
+        {
+            return m_state != nullptr;
+        }
+
+        [[nodiscard]] bool is_ready() const
+        {
+            return m_state && m_state->is_ready.load(std::memory_order_acquire);
+        }
+
+        void wait() const
+        {
+            if (!m_state)
+            {
+                throw std::runtime_error("Error: No future to wait for");
+            }
+
+            m_state->wait();
+        }
+
+        // Blocks until the value is there and moves it out, rethrows if the producer failed
+        T get()
+        {
+            wait();
+
+            auto state = std::move(m_state);
+
+            if (state->exception)
+            {
+                std::rethrow_exception(state->exception);
+            }
+
+            if constexpr (!std::is_void_v<T>)
+            {
+                return std::move(*state->value);
+            }
+        }
+
+        // Runs func with the value as a pool job once it is there. An exception skips func and travels on to
+        // the returned future, so a pipeline only has to check at its end
+        template<typename Func>
+        future<detail::continuation_result_t<Func, T>> then(Func&& func)
+        {
+            using result_type = detail::continuation_result_t<Func, T>;
+
+            auto state = detail::future_access::release(*this);
+            auto * pExecutor = state->executor != nullptr ? state->executor : &pool::shared();
+
+            promise<result_type> next(pExecutor);
+            auto result = next.get_future();
+
+            auto * pState = state.get();
+            pState->on_ready(
+                    [state = std::move(state), pExecutor, next = std::move(next), func = std::forward<Func>(func)]() mutable
+                    {
+                        pExecutor->submit(
+                                [state = std::move(state), next = std::move(next), func = std::move(func)]() mutable
+                                {
+                                    if (state->exception)
+                                    {
+                                        next.set_exception(state->exception);
+                                    }
+                                    else if constexpr (std::is_void_v<T>)
+                                    {
+                                        detail::fulfil(next, func);
+                                    }
+                                    else
+                                    {
+                                        detail::fulfil(next, func, std::move(*state->value));
+                                    }
+                                });
+                    });
+
+            return result;
+        }
+
+    private:
+
+        friend class promise<T>;
+        friend struct detail::future_access;
+
+        explicit future(std::shared_ptr<detail::future_state<T>> state)
+            : m_state(std::move(state))
+        {
+        }
+
+        std::shared_ptr<detail::future_state<T>> m_state;
+
+    };
+
+    template<
+            typename Func,
+            typename... Args,
+            typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Func>&, std::decay_t<Args>...>>
+    >
+    auto async(pool& executor, job_priority level, Func&& runnable, Args&&... args)
+    {
+        using result_type = std::invoke_result_t<std::decay_t<Func>&, std::decay_t<Args>...>;
+
+        promise<result_type> target(&executor);
+        auto result = target.get_future();
+
+        executor.submit(
+                level,
+                [target = std::move(target), runnable = std::forward<Func>(runnable), args_tuple = std::make_tuple(std::forward<Args>(args)...)]() mutable
+                {
+                    std::apply(
+                            [&](auto&... unpacked)
+                            {
+                                detail::fulfil(target, runnable, std::move(unpacked)...);
+                            },
+                            args_tuple);
+                });
+
+        return result;
+    }
+
+    // Same with the priority of the calling job, normal outside the pool
+    template<
+            typename Func,
+            typename... Args,
+            typename = std::enable_if_t<std::is_invocable_v<std::decay_t<Func>&, std::decay_t<Args>...>>
+    >
+    auto async(pool& executor, Func&& runnable, Args&&... args)
+    {
+        return async(executor, pool::current_priority(), std::forward<Func>(runnable), std::forward<Args>(args)...);
+    }
+
+    // Same on the shared pool
+    template<
+            typename Func,
+            typename... Args,
+            typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, pool> && std::is_invocable_v<std::decay_t<Func>&, std::decay_t<Args>...>>
+    >
+    auto async(Func&& runnable, Args&&... args)
+    {
+        return async(pool::shared(), std::forward<Func>(runnable), std::forward<Args>(args)...);
+    }
+
+    // Ready once every input is; fails with the first input's exception (in argument order) if any failed
+    template<typename... Ts>
+    future<std::tuple<Ts...>> when_all(future<Ts>... inputs)
+    {
+        static_assert((!std::is_void_v<Ts> && ...), "Use the vector overload of when_all for void futures");
+
+        struct aggregate
+        {
+            std::tuple<std::shared_ptr<detail::future_state<Ts>>...> states;
+            std::atomic<size_t> remaining { sizeof...(Ts) };
+
+            promise<std::tuple<Ts...>> target;
+
+            void arrive()
+            {
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                {
+                    return;
+                }
+
+                std::exception_ptr exception { nullptr };
+                std::apply([&](auto&... state) { ((exception = exception ? exception : state->exception), ...); }, states);
+
+                if (exception)
+                {
+                    target.set_exception(exception);
+                }
+                else
+                {
+                    target.set_value(std::apply([](auto&... state) { return std::tuple<Ts...>(std::move(*state->value)...); }, states));
+                }
+
+                states = { };
+            }
+        };
+
+        auto all = std::make_shared<aggregate>();
+        all->states = std::make_tuple(detail::future_access::release(inputs)...);
+
+        auto result = all->target.get_future();
+
+        if constexpr (sizeof...(Ts) == 0)
+        {
+            all->target.set_value();
+        }
+        else
+        {
+            // Copy the pointers first, the last on_ready may finish the aggregate and clear its states
+            auto states = all->states;
+            std::apply([&](auto&... state) { (state->on_ready([all]() { all->arrive(); }), ...); }, states);
+        }
+
+        return result;
+    }
+
+    template<typename T>
+    future<std::conditional_t<std::is_void_v<T>, void, std::vector<T>>> when_all(std::vector<future<T>> inputs)
+    {
+        using result_type = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+
+        struct aggregate
+        {
+            std::vector<std::shared_ptr<detail::future_state<T>>> states;
+            std::atomic<size_t> remaining { 0 };
+
+            promise<result_type> target;
+
+            void finish()
+            {
+                for (const auto& state : states)
+                {
+                    if (state->exception)
+                    {
+                        target.set_exception(state->exception);
+                        states.clear();
+                        return;
+                    }
+                }
+
+                if constexpr (std::is_void_v<T>)
+                {
+                    target.set_value();
+                }
+                else
+                {
+                    std::vector<T> values;
+                    values.reserve(states.size());
+
+                    for (auto& state : states)
+                    {
+                        values.push_back(std::move(*state->value));
+                    }
+
+                    target.set_value(std::move(values));
+                }
+
+                states.clear();
+            }
+        };
+
+        auto all = std::make_shared<aggregate>();
+        all->states.reserve(inputs.size());
+
+        for (auto& input : inputs)
+        {
+            all->states.push_back(detail::future_access::release(input));
+        }
+
+        auto result = all->target.get_future();
+
+        if (all->states.empty())
+        {
+            all->finish();
+            return result;
+        }
+
+        all->remaining.store(all->states.size(), std::memory_order_relaxed);
+
+        auto states = all->states;
+        for (auto& state : states)
+        {
+            state->on_ready(
+                    [all]()
+                    {
+                        if (all->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        {
+                            all->finish();
+                        }
+                    });
+        }
+
+        return result;
+    }
+
+    // Ready with the index and value of whichever input completes first, the other results are dropped
+    template<typename T>
+    future<when_any_result<T>> when_any(std::vector<future<T>> inputs)
+    {
+        if (inputs.empty())
+        {
+            throw std::runtime_error("Error: when_any needs at least one future");
+        }
+
+        struct aggregate
+        {
+            std::atomic<bool> is_claimed { false };
+            promise<when_any_result<T>> target;
+        };
+
+        auto any = std::make_shared<aggregate>();
+        auto result = any->target.get_future();
+
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            auto state = detail::future_access::release(inputs.at(i));
+            auto * pState = state.get();
+
+            pState->on_ready(
+                    [any, state = std::move(state), index = i]()
+                    {
+                        if (any->is_claimed.exchange(true, std::memory_order_acq_rel))
+                        {
+                            return;
+                        }
+
+                        if (state->exception)
+                        {
+                            any->target.set_exception(state->exception);
+                        }
+                        else if constexpr (std::is_void_v<T>)
+                        {
+                            any->target.set_value(when_any_result<void> { index });
+                        }
+                        else
+                        {
+                            any->target.set_value(when_any_result<T> { index, std::move(*state->value) });
+                        }
+                    });
+        }
+
+        return result;
+    }
+}
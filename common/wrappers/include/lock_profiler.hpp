@@ -0,0 +1,165 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <source_location>
+
+// Opt-in contention profiler for winmutex and adaptive_mutex, compiled in with the RLIB_LOCK_PROFILING CMake
+// option (which defines RETRO_LOCK_PROFILING for the wrappers and everything linking them). When it is off
+// the locks carry no extra state and their signatures are unchanged; the functions below still exist and
+// simply report nothing.
+// Every release pushes one event into a fixed-size ring owned by the releasing thread, collect() drains the
+// rings into running totals. A full ring drops the event and counts it instead of blocking the lock holder
+namespace retro::mutex::profiling
+{
+#if defined(RETRO_LOCK_PROFILING)
+    constexpr bool is_enabled = true;
+#else
+    constexpr bool is_enabled = false;
+#endif
+
+    using clock = std::chrono::steady_clock;
+
+    struct stats
+    {
+        uint64_t acquisitions = 0;
+
+        // Acquisitions that did not get the lock on the first attempt
+        uint64_t contended = 0;
+
+        uint64_t wait_ns_total = 0;
+        uint64_t wait_ns_max = 0;
+
+        uint64_t hold_ns_total = 0;
+        uint64_t hold_ns_max = 0;
+
+        [[nodiscard]] double contention_ratio() const
+        {
+            return acquisitions > 0 ? static_cast<double>(contended) / static_cast<double>(acquisitions) : 0.0;
+        }
+    };
+
+    // Where lock() was called from. Calls made through std::lock_guard and friends show up as the standard
+    // library header, lock directly (or through mutex::profiling::guard) to see the real site
+    struct site_stats
+        : stats
+    {
+        const char * file = "";
+        const char * function = "";
+        uint32_t line = 0;
+    };
+
+    // Locks are told apart by address, a lock destroyed and re-created in the same place continues the totals
+    struct lock_stats
+        : stats
+    {
+        const void * address = nullptr;
+        std::string name;
+
+        // Highest total wait first
+        std::vector<site_stats> sites;
+    };
+
+    struct report
+    {
+        // Highest total wait first
+        std::vector<lock_stats> locks;
+
+        // Events lost to full rings since the last reset()
+        uint64_t dropped = 0;
+    };
+
+    // Drains every thread's ring into the totals and returns all of them
+    report collect();
+
+    void reset();
+
+    // Writes collect() as a plain text table, returns false if the file could not be written
+    bool dump(const std::string& path);
+
+    // What an instrumented lock keeps about its current holder. Only ever touched by the thread holding the
+    // lock, so plain members are enough; the depth makes it work for the recursive winmutex as well
+    class lock_probe
+    {
+    public:
+
+        void acquired(clock::time_point started, bool is_contended, const std::source_location& site)
+        {
+            if (m_depth++ == 0)
+            {
+                m_acquired_at = clock::now();
+                m_wait = m_acquired_at - started;
+                m_is_contended = is_contended;
+                m_site = site;
+            }
+        }
+
+        // Has to be called while still holding the lock
+        void released(const void * pLock)
+        {
+            if (--m_depth == 0)
+            {
+                record(pLock, clock::now());
+            }
+        }
+
+        void set_name(const char * name)
+        {
+            m_name = name;
+        }
+
+    private:
+
+        void record(const void * pLock, clock::time_point released_at) const;
+
+    private:
+
+        const char * m_name { nullptr };
+
+        uint32_t m_depth { 0 };
+        bool m_is_contended { false };
+
+        clock::time_point m_acquired_at;
+        clock::duration m_wait { };
+
+        std::source_location m_site;
+
+    };
+
+    // std::lock_guard that passes its own call site on to the lock
+    template<typename Lock>
+    class guard
+    {
+    public:
+
+#if defined(RETRO_LOCK_PROFILING)
+        explicit guard(Lock& lock, std::source_location site = std::source_location::current())
+            : m_lock(lock)
+        {
+            m_lock.lock(site);
+        }
+#else
+        explicit guard(Lock& lock)
+            : m_lock(lock)
+        {
+            m_lock.lock();
+        }
+#endif
+
+        ~guard()
+        {
+            m_lock.unlock();
+        }
+
+        guard(const guard&) = delete;
+
+        guard& operator=(const guard&) = delete;
+
+    private:
+
+        Lock& m_lock;
+
+    };
+}
@@ -0,0 +1,419 @@
+#pragma once
+
+#include <cpu.hpp>
+#include <futex.hpp>
+
+#include <new>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+namespace retro::concurrent
+{
+    // Bounded multi-producer multi-consumer ring (D. Vyukov). Every cell carries a sequence number telling
+    // whose turn it is, so producers and consumers only contend on their own position counter and each
+    // operation is a single CAS. Bulk operations claim a whole run of ready cells with that same single CAS.
+    //
+    // try_* calls never block and never notify. The blocking push()/pop() families park on a futex and wake
+    // each other; a consumer blocked in pop() that is fed by try_push() alone still notices new items, only
+    // with up to park_timeout of extra latency.
+    //
+    // Cells are a cache line each, so neighbouring slots taken by different threads do not share a line.
+    // Items are built in a cell that is already claimed, the slot could never be handed out again if that
+    // threw: construction and moves have to be noexcept
+    template<typename T>
+    class mpmc_queue
+    {
+        static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>, "mpmc_queue items have to move and destroy without throwing");
+
+    public:
+
+        explicit mpmc_queue(size_t capacity)
+        {
+            if (capacity < 2)
+            {
+                capacity = 2;
+            }
+
+            size_t rounded = 1;
+            while (rounded < capacity)
+            {
+                rounded <<= 1;
+            }
+
+            m_mask = rounded - 1;
+            m_cells = std::make_unique<cell[]>(rounded);
+
+            for (size_t i = 0; i < rounded; i++)
+            {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~mpmc_queue()
+        {
+            while (try_pop())
+            {
+            }
+        }
+
+        mpmc_queue(const mpmc_queue&) = delete;
+
+        mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+        template<typename... Args>
+        bool try_emplace(Args&&... args)
+        {
+            static_assert(std::is_nothrow_constructible_v<T, Args&&...>, "Construct the item first and push it, a throw would stall the queue");
+
+            auto position = m_enqueue_position.load(std::memory_order_relaxed);
+            cell * pCell;
+
+            while (true)
+            {
+                pCell = &m_cells[position & m_mask];
+                const auto sequence = pCell->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+                if (difference == 0)
+                {
+                    if (m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = m_enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+
+            new (pCell->storage) T(std::forward<Args>(args)...);
+            pCell->sequence.store(position + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        bool try_push(const T& item)
+        {
+            return try_emplace(item);
+        }
+
+        bool try_push(T&& item)
+        {
+            return try_emplace(std::move(item));
+        }
+
+        std::optional<T> try_pop()
+        {
+            auto position = m_dequeue_position.load(std::memory_order_relaxed);
+            cell * pCell;
+
+            while (true)
+            {
+                pCell = &m_cells[position & m_mask];
+                const auto sequence = pCell->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+                if (difference == 0)
+                {
+                    if (m_dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return std::nullopt;
+                }
+                else
+                {
+                    position = m_dequeue_position.load(std::memory_order_relaxed);
+                }
+            }
+
+            std::optional<T> item = take(*pCell, position);
+            return item;
+        }
+
+        // Pushes a prefix of [first, last) with one CAS, returns how many items went in
+        template<typename It>
+        size_t try_push_bulk(It first, It last)
+        {
+            static_assert(std::is_nothrow_constructible_v<T, decltype(std::move(*first))>, "Items have to be built without throwing");
+
+            const auto wanted = static_cast<size_t>(std::distance(first, last));
+
+            if (wanted == 0)
+            {
+                return 0;
+            }
+
+            auto position = m_enqueue_position.load(std::memory_order_relaxed);
+            size_t count;
+
+            while (true)
+            {
+                count = 0;
+                while (count < wanted && count <= m_mask
+                       && m_cells[(position + count) & m_mask].sequence.load(std::memory_order_acquire) == position + count)
+                {
+                    count++;
+                }
+
+                if (count == 0)
+                {
+                    const auto sequence = m_cells[position & m_mask].sequence.load(std::memory_order_acquire);
+
+                    if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position) < 0)
+                    {
+                        return 0;
+                    }
+
+                    position = m_enqueue_position.load(std::memory_order_relaxed);
+                    continue;
+                }
+
+                if (m_enqueue_position.compare_exchange_weak(position, position + count, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+
+            for (size_t i = 0; i < count; i++, ++first)
+            {
+                auto& target = m_cells[(position + i) & m_mask];
+
+                new (target.storage) T(std::move(*first));
+                target.sequence.store(position + i + 1, std::memory_order_release);
+            }
+
+            return count;
+        }
+
+        // Pops up to max_count items into out with one CAS, returns how many were popped
+        template<typename OutIt>
+        size_t try_pop_bulk(OutIt out, size_t max_count)
+        {
+            if (max_count == 0)
+            {
+                return 0;
+            }
+
+            auto position = m_dequeue_position.load(std::memory_order_relaxed);
+            size_t count;
+
+            while (true)
+            {
+                count = 0;
+                while (count < max_count && count <= m_mask
+                       && m_cells[(position + count) & m_mask].sequence.load(std::memory_order_acquire) == position + count + 1)
+                {
+                    count++;
+                }
+
+                if (count == 0)
+                {
+                    const auto sequence = m_cells[position & m_mask].sequence.load(std::memory_order_acquire);
+
+                    if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1) < 0)
+                    {
+                        return 0;
+                    }
+
+                    position = m_dequeue_position.load(std::memory_order_relaxed);
+                    continue;
+                }
+
+                if (m_dequeue_position.compare_exchange_weak(position, position + count, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                *out = take(m_cells[(position + i) & m_mask], position + i);
+                ++out;
+            }
+
+            return count;
+        }
+
+        void push(T item)
+        {
+            sync::backoff backoff;
+
+            while (!try_push(std::move(item)))
+            {
+                wait_for_change(m_pop_epoch, m_push_waiters, backoff, [this]() { return !full(); });
+            }
+
+            notify(m_push_epoch, m_pop_waiters);
+        }
+
+        T pop()
+        {
+            sync::backoff backoff;
+
+            while (true)
+            {
+                if (auto item = try_pop())
+                {
+                    notify(m_pop_epoch, m_push_waiters);
+                    return std::move(*item);
+                }
+
+                wait_for_change(m_push_epoch, m_pop_waiters, backoff, [this]() { return !empty(); });
+            }
+        }
+
+        // Blocks until every item of [first, last) went in
+        template<typename It>
+        void push_bulk(It first, It last)
+        {
+            sync::backoff backoff;
+
+            while (first != last)
+            {
+                const auto pushed = try_push_bulk(first, last);
+                std::advance(first, pushed);
+
+                if (pushed > 0)
+                {
+                    notify(m_push_epoch, m_pop_waiters);
+                    backoff.reset();
+                }
+                else
+                {
+                    wait_for_change(m_pop_epoch, m_push_waiters, backoff, [this]() { return !full(); });
+                }
+            }
+        }
+
+        // Blocks until at least one item is available, then takes up to max_count
+        template<typename OutIt>
+        size_t pop_bulk(OutIt out, size_t max_count)
+        {
+            sync::backoff backoff;
+
+            while (true)
+            {
+                if (const auto popped = try_pop_bulk(out, max_count))
+                {
+                    notify(m_pop_epoch, m_push_waiters);
+                    return popped;
+                }
+
+                wait_for_change(m_push_epoch, m_pop_waiters, backoff, [this]() { return !empty(); });
+            }
+        }
+
+        [[nodiscard]] size_t capacity() const
+        {
+            return m_mask + 1;
+        }
+
+        // Approximate while producers or consumers are active
+        [[nodiscard]] size_t size() const
+        {
+            const auto enqueued = m_enqueue_position.load(std::memory_order_relaxed);
+            const auto dequeued = m_dequeue_position.load(std::memory_order_relaxed);
+
+            return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+        [[nodiscard]] bool empty() const
+        {
+            return size() == 0;
+        }
+
+        [[nodiscard]] bool full() const
+        {
+            return size() >= capacity();
+        }
+
+    private:
+
+        static constexpr auto park_timeout = std::chrono::milliseconds(1);
+
+        struct alignas(sync::cache_line_size) cell
+        {
+            std::atomic<size_t> sequence { 0 };
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+
+        T take(cell& source, size_t position)
+        {
+            auto * pItem = std::launder(reinterpret_cast<T *>(source.storage));
+
+            T item = std::move(*pItem);
+            pItem->~T();
+
+            source.sequence.store(position + m_mask + 1, std::memory_order_release);
+            return item;
+        }
+
+        template<typename Ready>
+        void wait_for_change(std::atomic<uint32_t>& epoch, std::atomic<uint32_t>& waiters, sync::backoff& backoff, Ready&& is_ready)
+        {
+            for (int i = 0; i < spin_rounds; i++)
+            {
+                if (is_ready())
+                {
+                    return;
+                }
+
+                backoff.pause();
+            }
+
+            const auto observed = epoch.load(std::memory_order_acquire);
+
+            waiters.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (!is_ready())
+            {
+                sync::futex_wait_for(epoch, observed, park_timeout);
+            }
+
+            waiters.fetch_sub(1);
+        }
+
+        static void notify(std::atomic<uint32_t>& epoch, std::atomic<uint32_t>& waiters)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (waiters.load(std::memory_order_relaxed) > 0)
+            {
+                epoch.fetch_add(1, std::memory_order_release);
+                sync::futex_wake_all(epoch);
+            }
+        }
+
+    private:
+
+        static constexpr int spin_rounds = 8;
+
+        size_t m_mask { 0 };
+        std::unique_ptr<cell[]> m_cells;
+
+        alignas(sync::cache_line_size) std::atomic<size_t> m_enqueue_position { 0 };
+        alignas(sync::cache_line_size) std::atomic<size_t> m_dequeue_position { 0 };
+
+        alignas(sync::cache_line_size) std::atomic<uint32_t> m_push_epoch { 0 };
+        std::atomic<uint32_t> m_pop_waiters { 0 };
+
+        alignas(sync::cache_line_size) std::atomic<uint32_t> m_pop_epoch { 0 };
+        std::atomic<uint32_t> m_push_waiters { 0 };
+
+    };
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <pool.hpp>
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <optional>
+#include <cstdint>
+#include <type_traits>
+
+namespace retro::parallel
+{
+    // How for_each hands iterations to its participants. The first three mean what the OpenMP clauses of the
+    // same name mean, so a lab can switch between OpenMP and the pool without changing what is measured
+    enum class schedule
+    {
+        // Fixed assignment decided up front. Without a chunk size every participant gets one contiguous block,
+        // with one the chunks are dealt round-robin. No shared state at all, the worst case for skewed work
+        static_chunks,
+
+        // Participants grab the next chunk from a shared counter, one atomic per chunk. The chunk size
+        // defaults to a single iteration
+        dynamic,
+
+        // Like dynamic, but a grab takes a share of whatever is left, shrinking down to the chunk size. Few
+        // grabs at the start, fine grained at the end
+        guided,
+
+        // Every participant starts on its own contiguous block and eats it chunk by chunk from the front; once
+        // done it steals the back half of someone else's remainder. Keeps the locality of static on even work
+        // and balances like dynamic on skewed work
+        stealing
+    };
+
+    constexpr std::array<const char *, 4> schedule_names = { "Static", "Dynamic", "Guided", "Work stealing" };
+
+    struct options
+    {
+        schedule kind = schedule::static_chunks;
+
+        // Iterations per chunk, 0 picks the schedule's default
+        size_t chunk = 0;
+
+        // Participants including the calling thread, 0 means every pool worker plus the caller. Clamped to
+        // what the pool can actually run at the same time
+        size_t threads = 0;
+
+        // Class of the pool jobs, the calling job's when not set. A background loop leaves workers to
+        // interactive jobs between its chunks, see pool::preemption_point()
+        std::optional<thread::job_priority> level;
+    };
+
+    struct participant_stats
+    {
+        // From entering the loop to finding no work left, so scheduling overhead counts as busy
+        double busy_seconds = 0.0;
+
+        size_t iterations = 0;
+        size_t chunks = 0;
+    };
+
+    struct loop_stats
+    {
+        std::vector<participant_stats> participants;
+
+        double wall_seconds = 0.0;
+
+        // Longest busy time over the mean one, 1.0 is a perfectly balanced loop
+        [[nodiscard]] double imbalance() const;
+    };
+
+    namespace detail
+    {
+        // Runs body over [begin, end), one call per chunk
+        using range_invoker = void (*)(void * pBody, size_t begin, size_t end);
+
+        loop_stats run(size_t first, size_t last, const options& settings, thread::pool& pool, void * pBody, range_invoker invoke);
+    }
+
+    // Calls body(i) for every i in [first, last) on the calling thread and up to options::threads - 1 jobs of
+    // the pool, returns once all of them are done. The first exception thrown by body stops the others from
+    // taking new chunks and is rethrown here. Called from a worker of the same pool it still works, the
+    // waiting worker runs the loop's own jobs
+    template<typename Func>
+    loop_stats for_each(size_t first, size_t last, Func&& body, const options& settings = { }, thread::pool& pool = thread::pool::shared())
+    {
+        static_assert(std::is_invocable_v<Func&, size_t>, "for_each body has to be callable with an index");
+
+        using body_type = std::remove_reference_t<Func>;
+
+        return detail::run(first, last, settings, pool, const_cast<void *>(static_cast<const void *>(std::addressof(body))),
+                           [](void * pBody, size_t begin, size_t end)
+                           {
+                               auto& func = *static_cast<body_type *>(pBody);
+
+                               for (size_t i = begin; i < end; i++)
+                               {
+                                   func(i);
+                               }
+                           });
+    }
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <topology.hpp>
+#include <winthread.hpp>
+#include <mpmc_queue.hpp>
+#include <chase_lev_deque.hpp>
+#include <unique_function.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <exception>
+#include <tuple>
+
+namespace retro::thread
+{
+    // Scheduling class of a pool job. A worker looks for interactive jobs first, then its own deque, normal
+    // jobs, other workers' deques and background jobs last, so a small UI job never queues behind bulk work
+    enum class job_priority
+    {
+        interactive,
+        normal,
+        background
+    };
+
+    constexpr std::array<const char *, 3> job_priority_names = { "Interactive", "Normal", "Background" };
+
+    // Fixed set of winthread workers with a Chase-Lev deque each. Normal jobs submitted from a worker go to its
+    // own deque, everything else goes through a bounded MPMC injection queue per priority (a submitter blocks
+    // while it is full, a worker of the pool runs pending jobs instead); idle workers steal from each other and
+    // park once there is nothing left anywhere.
+    //
+    // Each priority has a quota, the most workers that may run its injected jobs at once. A job waiting on
+    // another one keeps running jobs of any class on its own worker, that never counts against a quota
+    class pool
+    {
+        struct job;
+
+    public:
+
+        class handle
+        {
+        public:
+
+            handle() = default;
+
+            // Blocks until the job has finished and rethrows its exception, if any. Called from a worker of the
+            // same pool it keeps running other jobs instead of blocking, so nested waits can not deadlock
+            void wait() const;
+
+            [[nodiscard]] bool is_done() const;
+
+            [[nodiscard]] bool is_valid() const;
+
+        private:
+
+            friend class pool;
+
+            explicit handle(std::shared_ptr<job> job);
+
+            std::shared_ptr<job> m_job;
+
+        };
+
+        // Zero workers means one per hardware thread
+        explicit pool(size_t workers_count = 0);
+
+        ~pool();
+
+        pool(const pool&) = delete;
+
+        pool& operator=(const pool&) = delete;
+
+        // Same priority as the job the calling worker runs, normal from any other thread
+        template<
+                typename Func,
+                typename... Args,
+                typename = std::enable_if_t<std::is_invocable_v<Func, Args...>>
+        >
+        handle submit(Func&& runnable, Args&&... args)
+        {
+            return submit(current_priority(), std::forward<Func>(runnable), std::forward<Args>(args)...);
+        }
+
+        template<
+                typename Func,
+                typename... Args,
+                typename = std::enable_if_t<std::is_invocable_v<Func, Args...>>
+        >
+        handle submit(job_priority level, Func&& runnable, Args&&... args)
+        {
+            auto new_job = std::make_shared<job>();
+            new_job->level = level;
+
+            if constexpr (sizeof...(Args) == 0)
+            {
+                new_job->invoke = std::forward<Func>(runnable);
+            }
+            else
+            {
+                // A job runs once, so unlike winthread the bound arguments are moved into the call
+                new_job->invoke = [runnable = std::forward<Func>(runnable), args_tuple = std::make_tuple(std::forward<Args>(args)...)]() mutable
+                {
+                    std::apply(std::move(runnable), std::move(args_tuple));
+                };
+            }
+
+            return enqueue(std::move(new_job));
+        }
+
+        // Runs a single pending job on the calling thread, returns false if there was nothing to run
+        bool try_run_pending();
+
+        [[nodiscard]] size_t size() const;
+
+        // Binds worker i to the i-th CPU of the policy's order, pin_policy::none lets them float again.
+        // Safe while jobs run, a worker simply continues on its new CPU
+        void pin(pin_policy policy);
+
+        // Most workers running injected jobs of the class at once, clamped to [1, size()]. Jobs already
+        // running are not interrupted when the quota shrinks, new ones just wait for them to finish
+        void set_quota(job_priority level, size_t max_workers);
+
+        [[nodiscard]] size_t get_quota(job_priority level) const;
+
+        // Workers currently running injected jobs of the class
+        [[nodiscard]] size_t running(job_priority level) const;
+
+        // Runs the pending interactive jobs on the calling worker and returns. Long jobs call it between
+        // chunks, so interactive work does not have to wait for a worker to become free. Does nothing outside
+        // a worker or inside an interactive job
+        static void preemption_point();
+
+        // Priority of the job the calling worker runs, normal on any other thread
+        static job_priority current_priority();
+
+        // Process-wide pool the labs share, created on first use
+        static pool& shared();
+
+        // Pool whose worker is calling, nullptr on any other thread
+        static pool * current();
+
+    private:
+
+        using job_runnable_internal = unique_function<void()>;
+
+        struct job
+        {
+            job_runnable_internal invoke;
+
+            job_priority level { job_priority::normal };
+
+            // Taken out of its class's quota, given back once it has run
+            bool holds_quota { false };
+
+            std::exception_ptr exception { nullptr };
+            std::atomic<bool> is_done { false };
+
+            // The queues hold raw pointers, the job keeps itself alive until a worker has run it
+            std::shared_ptr<job> self;
+        };
+
+        struct worker
+        {
+            concurrent::chase_lev_deque<job *> deque;
+            winthread thread;
+        };
+
+        struct alignas(64) job_class
+        {
+            concurrent::mpmc_queue<job *> injection { injection_capacity };
+
+            std::atomic<size_t> running { 0 };
+            std::atomic<size_t> quota { 0 };
+        };
+
+        static constexpr size_t no_worker = static_cast<size_t>(-1);
+
+        static constexpr size_t injection_capacity = 4096;
+
+        handle enqueue(std::shared_ptr<job> new_job);
+
+        job_class& class_of(job_priority level);
+
+        // Outside a nested wait the class's quota has to have room, the job then holds a share of it
+        job * take_injected(job_priority level, bool is_nested);
+
+        job * find_job(size_t self);
+
+        void run_job(job * pJob);
+
+        void worker_loop(size_t index);
+
+    private:
+
+        std::vector<std::unique_ptr<worker>> m_workers;
+
+        std::array<job_class, job_priority_names.size()> m_classes;
+
+        alignas(64) std::atomic<uint32_t> m_sleeping { 0 };
+        alignas(64) std::atomic<uint32_t> m_wake_epoch { 0 };
+
+        std::atomic<bool> m_is_stopping { false };
+
+        inline thread_local static pool * m_current_pool { nullptr };
+        inline thread_local static size_t m_current_index { no_worker };
+
+        // Jobs the calling thread is running right now, more than one while it waits inside a job
+        inline thread_local static uint32_t m_current_depth { 0 };
+        inline thread_local static job_priority m_current_priority { job_priority::normal };
+
+    };
+}
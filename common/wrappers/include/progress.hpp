@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+namespace retro::thread
+{
+    // Work counter a kernel bumps at chunk boundaries and the UI reads every frame. Everything is relaxed:
+    // the numbers are only ever displayed, nothing is published through them
+    class progress
+    {
+    public:
+
+        using clock = std::chrono::steady_clock;
+
+        void start(uint64_t total)
+        {
+            m_done.store(0, std::memory_order_relaxed);
+            m_total.store(total, std::memory_order_relaxed);
+            m_start_ticks.store(clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        }
+
+        void advance(uint64_t amount = 1)
+        {
+            m_done.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] uint64_t done() const
+        {
+            return m_done.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] uint64_t total() const
+        {
+            return m_total.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] float fraction() const
+        {
+            const auto all = total();
+            return all > 0 ? static_cast<float>(std::min(done(), all)) / static_cast<float>(all) : 0.0F;
+        }
+
+        [[nodiscard]] clock::duration elapsed() const
+        {
+            return clock::now() - clock::time_point(clock::duration(m_start_ticks.load(std::memory_order_relaxed)));
+        }
+
+        // Extrapolated from the average rate so far, zero until the first unit of work is done
+        [[nodiscard]] clock::duration eta() const
+        {
+            const auto finished = done();
+            const auto all = total();
+
+            if (finished == 0 || finished >= all)
+            {
+                return clock::duration::zero();
+            }
+
+            const auto per_unit = std::chrono::duration<double, clock::period>(elapsed()) / static_cast<double>(finished);
+            return std::chrono::duration_cast<clock::duration>(per_unit * static_cast<double>(all - finished));
+        }
+
+    private:
+
+        std::atomic<uint64_t> m_done { 0 };
+        std::atomic<uint64_t> m_total { 0 };
+        std::atomic<clock::rep> m_start_ticks { 0 };
+
+    };
+}
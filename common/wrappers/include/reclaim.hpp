@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace retro::concurrent
+{
+    // Safe memory reclamation for lock-free structures: a node unlinked by one thread may still be read by
+    // another that loaded the pointer just before, so it can only be freed once nobody can be holding it.
+    // Both domains below keep retired objects in per-thread lists and free them in batches; what is left in the
+    // list of an exiting thread is handed over to the domain and freed by whoever collects next.
+    //
+    // A domain has to outlive the guards and hazard pointers made from it. Destroying it frees everything still
+    // retired, so by then no thread may be reading the structure any more
+
+    using reclaim_deleter = void (*)(void * pObject);
+
+    // Epoch based reclamation (K. Fraser). Readers wrap every access in an epoch_guard, which costs one
+    // announcement and a fence. An object retired in epoch e is freed once the global epoch reaches e + 2,
+    // which needs every thread inside a guard to have seen e + 1. Cheapest for readers, but a single thread
+    // stalled inside a guard stops reclamation for everyone
+    class epoch_domain
+    {
+    public:
+
+        // Retired objects a thread piles up before it tries to advance the epoch and free them
+        static constexpr size_t batch_size = 64;
+
+        epoch_domain();
+
+        ~epoch_domain();
+
+        epoch_domain(const epoch_domain&) = delete;
+
+        epoch_domain& operator=(const epoch_domain&) = delete;
+
+        // The object has to be unlinked already: no new reader may be able to reach it
+        template<typename T>
+        void retire(T * pObject)
+        {
+            retire(pObject, [](void * pRetired) { delete static_cast<T *>(pRetired); });
+        }
+
+        void retire(void * pObject, reclaim_deleter deleter);
+
+        // Advances the epoch if every thread inside a guard allows it, then frees whatever the calling thread
+        // and the exited ones retired and is safe by now
+        void collect();
+
+        // Retired but not freed yet, over all threads
+        [[nodiscard]] size_t pending() const;
+
+        [[nodiscard]] uint64_t epoch() const;
+
+        // Process-wide domain, created on first use
+        static epoch_domain& shared();
+
+    private:
+
+        friend class epoch_guard;
+
+        struct state;
+
+        std::shared_ptr<state> m_state;
+
+    };
+
+    // Marks the calling thread as reading structures of the domain. Guards nest, only the outermost one
+    // announces and withdraws
+    class epoch_guard
+    {
+    public:
+
+        explicit epoch_guard(epoch_domain& domain = epoch_domain::shared());
+
+        ~epoch_guard();
+
+        epoch_guard(const epoch_guard&) = delete;
+
+        epoch_guard& operator=(const epoch_guard&) = delete;
+
+    private:
+
+        void * m_record;
+
+    };
+
+    // Hazard pointers (M. Michael). A reader publishes every pointer it is about to dereference, a reclaiming
+    // thread frees only what no published slot holds. Reads cost a store, a fence and a reload per pointer,
+    // but a stalled reader only pins the objects it is holding instead of everything retired after it
+    class hazard_domain
+    {
+    public:
+
+        // A thread scans the slots once its list reaches max(batch_size, 2 * slots), which keeps the scan
+        // amortized at a constant cost per retired object
+        static constexpr size_t batch_size = 64;
+
+        hazard_domain();
+
+        ~hazard_domain();
+
+        hazard_domain(const hazard_domain&) = delete;
+
+        hazard_domain& operator=(const hazard_domain&) = delete;
+
+        template<typename T>
+        void retire(T * pObject)
+        {
+            retire(pObject, [](void * pRetired) { delete static_cast<T *>(pRetired); });
+        }
+
+        void retire(void * pObject, reclaim_deleter deleter);
+
+        // Frees whatever the calling thread and the exited ones retired and no slot holds
+        void collect();
+
+        [[nodiscard]] size_t pending() const;
+
+        static hazard_domain& shared();
+
+    private:
+
+        friend class hazard_pointer;
+
+        struct state;
+
+        std::shared_ptr<state> m_state;
+
+    };
+
+    // One published slot. Slots are recycled between hazard pointers, making one is a scan for a free slot
+    // and only allocates when all of them are taken
+    class hazard_pointer
+    {
+    public:
+
+        explicit hazard_pointer(hazard_domain& domain = hazard_domain::shared());
+
+        ~hazard_pointer();
+
+        hazard_pointer(const hazard_pointer&) = delete;
+
+        hazard_pointer& operator=(const hazard_pointer&) = delete;
+
+        // Loads the source and publishes it until the value is stable, the returned object can then be used
+        // until the next protect() or reset(). Null when the source is
+        template<typename T>
+        T * protect(const std::atomic<T *>& source)
+        {
+            auto * pObject = source.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                m_slot->store(pObject, std::memory_order_seq_cst);
+
+                auto * pCurrent = source.load(std::memory_order_seq_cst);
+
+                if (pCurrent == pObject)
+                {
+                    return pObject;
+                }
+
+                pObject = pCurrent;
+            }
+        }
+
+        void reset();
+
+    private:
+
+        void * m_record;
+
+        std::atomic<void *> * m_slot;
+
+    };
+}
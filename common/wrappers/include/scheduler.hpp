@@ -0,0 +1,112 @@
+#pragma once
+
+#include <winthread.hpp>
+#include <mpmc_queue.hpp>
+#include <unique_function.hpp>
+
+#include <mutex>
+#include <queue>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <condition_variable>
+
+namespace retro::thread
+{
+    // Work posted from any thread and run by the thread that drains the queue; core::Application::Run binds
+    // the shared queue to the UI thread and drains it once per frame
+    class main_thread_queue
+    {
+    public:
+
+        explicit main_thread_queue(size_t capacity = 4096);
+
+        main_thread_queue(const main_thread_queue&) = delete;
+
+        main_thread_queue& operator=(const main_thread_queue&) = delete;
+
+        // Blocks while the queue is full. On the thread it is bound to, runs queued work until there is room
+        void post(unique_function<void()> work);
+
+        // Runs what was queued when the call started, work posted meanwhile waits for the next call.
+        // Returns how many items ran
+        size_t drain();
+
+        void bind_to_current_thread();
+
+        // Called after every post(), on the posting thread. Lets an owner that sleeps between drains (a UI
+        // waiting for input) wake up for the new work
+        void set_notifier(void (*notify)());
+
+        [[nodiscard]] bool is_main_thread() const;
+
+        static main_thread_queue& shared();
+
+    private:
+
+        concurrent::mpmc_queue<unique_function<void()>> m_queue;
+
+        std::atomic<std::thread::id> m_owner { };
+
+        std::atomic<void (*)()> m_notify { nullptr };
+
+    };
+
+    // One thread sleeping until the earliest deadline. Callbacks run on that thread, so they are expected to
+    // only hand work over to a pool or to the main thread queue
+    class timer_service
+    {
+    public:
+
+        using clock = std::chrono::steady_clock;
+
+        timer_service();
+
+        ~timer_service();
+
+        timer_service(const timer_service&) = delete;
+
+        timer_service& operator=(const timer_service&) = delete;
+
+        void schedule(clock::time_point deadline, unique_function<void()> callback);
+
+        static timer_service& shared();
+
+    private:
+
+        struct entry
+        {
+            clock::time_point deadline;
+            uint64_t sequence = 0;
+
+            // priority_queue only hands out const references, the callback is moved out right before pop()
+            mutable unique_function<void()> callback;
+        };
+
+        // Earliest deadline first, ties in scheduling order
+        struct later
+        {
+            bool operator()(const entry& lhs, const entry& rhs) const
+            {
+                return lhs.deadline != rhs.deadline ? lhs.deadline > rhs.deadline : lhs.sequence > rhs.sequence;
+            }
+        };
+
+        void loop();
+
+    private:
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+
+        std::priority_queue<entry, std::vector<entry>, later> m_entries;
+
+        uint64_t m_next_sequence { 0 };
+        bool m_is_stopping { false };
+
+        winthread m_thread;
+
+    };
+}
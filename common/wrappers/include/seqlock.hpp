@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cpu.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace retro::concurrent
+{
+    // Small record published as a whole: UI parameters a worker picks up, or timings and counts a worker
+    // reports to the UI. A writer makes the sequence odd, stores the record and makes it even again; a reader
+    // copies the record and retries if the sequence moved meanwhile. Readers never write shared memory, so any
+    // number of them costs the writer nothing, and a writer never waits for a reader.
+    //
+    // Meant for one writer per record. Concurrent writers are still correct, they take turns on the sequence.
+    // The record is kept as relaxed atomic words, a reader racing a writer copies a torn record but throws it
+    // away without ever having had a data race
+    template<typename T>
+    class seqlock
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "seqlock only holds trivially copyable records");
+        static_assert(std::is_default_constructible_v<T>, "seqlock records are copied out into a default constructed one");
+
+    public:
+
+        explicit seqlock(const T& initial = T { })
+        {
+            write(initial);
+        }
+
+        seqlock(const seqlock&) = delete;
+
+        seqlock& operator=(const seqlock&) = delete;
+
+        void publish(const T& value)
+        {
+            const auto sequence = begin_write();
+
+            write(value);
+            m_sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        // Read-modify-write for when several fields are owned by different writers, e.g. a worker filling in
+        // its part of a shared result. modify(T&) runs with the other writers held off, keep it short
+        template<typename Func>
+        void update(Func&& modify)
+        {
+            const auto sequence = begin_write();
+
+            auto value = read();
+            modify(value);
+
+            write(value);
+            m_sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        [[nodiscard]] T load() const
+        {
+            uint64_t version;
+            return load(version);
+        }
+
+        // Also returns which publish the record came from, 0 being the initial value
+        [[nodiscard]] T load(uint64_t& version) const
+        {
+            sync::backoff wait;
+
+            while (true)
+            {
+                const auto before = m_sequence.load(std::memory_order_acquire);
+
+                if ((before & 1) == 0)
+                {
+                    const auto value = read();
+
+                    // Pairs with the fence in begin_write: having seen any word of a newer record, the reload
+                    // below sees that record's odd sequence or later
+                    std::atomic_thread_fence(std::memory_order_acquire);
+
+                    if (m_sequence.load(std::memory_order_relaxed) == before)
+                    {
+                        version = before / 2;
+                        return value;
+                    }
+                }
+
+                wait.pause();
+            }
+        }
+
+        // Publishes so far. Cheaper than load() for a reader that only wants to know whether anything changed
+        [[nodiscard]] uint64_t version() const
+        {
+            return m_sequence.load(std::memory_order_acquire) / 2;
+        }
+
+    private:
+
+        static constexpr size_t words_count = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        // Returns the even sequence the record had before. Acquire, so a writer starts from what the previous
+        // one published
+        uint64_t begin_write()
+        {
+            sync::backoff wait;
+
+            auto sequence = m_sequence.load(std::memory_order_relaxed);
+
+            while ((sequence & 1) != 0 || !m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                wait.pause();
+                sequence = m_sequence.load(std::memory_order_relaxed);
+            }
+
+            // The odd sequence has to be visible before any word of the new record
+            std::atomic_thread_fence(std::memory_order_release);
+
+            return sequence;
+        }
+
+        void write(const T& value)
+        {
+            std::array<uint64_t, words_count> buffer { };
+            std::memcpy(buffer.data(), &value, sizeof(T));
+
+            for (size_t i = 0; i < words_count; i++)
+            {
+                m_words[i].store(buffer[i], std::memory_order_relaxed);
+            }
+        }
+
+        [[nodiscard]] T read() const
+        {
+            std::array<uint64_t, words_count> buffer { };
+
+            for (size_t i = 0; i < words_count; i++)
+            {
+                buffer[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+
+            T value;
+            std::memcpy(static_cast<void *>(&value), buffer.data(), sizeof(T));
+
+            return value;
+        }
+
+        // Readers poll the sequence and the words together, so they share the line instead of being padded apart
+        alignas(sync::cache_line_size) std::atomic<uint64_t> m_sequence { 0 };
+
+        std::array<std::atomic<uint64_t>, words_count> m_words { };
+
+    };
+}
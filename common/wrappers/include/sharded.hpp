@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cpu.hpp>
+
+#include <bit>
+#include <limits>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+namespace retro::concurrent
+{
+    namespace detail
+    {
+        // Threads get consecutive hints in creation order, so up to shard count threads never share a shard.
+        // Keyed by thread rather than by current CPU: a CPU index would need a syscall or rdtscp per update
+        // and still go stale right after a migration
+        inline uint32_t thread_shard_hint()
+        {
+            static std::atomic<uint32_t> next_hint { 0 };
+            thread_local const uint32_t hint = next_hint.fetch_add(1, std::memory_order_relaxed);
+
+            return hint;
+        }
+
+        // One shard per hardware thread, rounded up to a power of two
+        inline size_t default_shard_count()
+        {
+            return std::bit_ceil(static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1U)));
+        }
+
+        // Everything is relaxed: a sharded value is read for display or once all writers are done, nothing
+        // else is ever published through it
+        template<typename T>
+        void store_min(std::atomic<T>& target, T value)
+        {
+            auto current = target.load(std::memory_order_relaxed);
+            while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        template<typename T>
+        void store_max(std::atomic<T>& target, T value)
+        {
+            auto current = target.load(std::memory_order_relaxed);
+            while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+    }
+
+    // Counter split into cache line sized shards, each thread adding to its own. An update is an uncontended
+    // atomic add on a line no other core writes, where a single std::atomic has every core fight over one
+    // line. The price is the read: load() walks all shards and is not a snapshot while writers are running
+    template<typename T = uint64_t>
+    class sharded_counter
+    {
+        static_assert(std::is_integral_v<T>, "sharded_counter only holds integers");
+
+    public:
+
+        explicit sharded_counter(size_t shards_count = detail::default_shard_count())
+            : m_mask(std::bit_ceil(std::max<size_t>(shards_count, 1)) - 1)
+            , m_shards(std::make_unique<shard[]>(m_mask + 1))
+        {
+        }
+
+        sharded_counter(const sharded_counter&) = delete;
+
+        sharded_counter& operator=(const sharded_counter&) = delete;
+
+        void add(T amount)
+        {
+            local().value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        void increment()
+        {
+            add(1);
+        }
+
+        // Sum over the shards. Exact once the writers are done, a value somewhere between the counts at the
+        // start and at the end of the call while they are not
+        [[nodiscard]] T load() const
+        {
+            T total = 0;
+
+            for (size_t i = 0; i <= m_mask; i++)
+            {
+                total += m_shards[i].value.load(std::memory_order_relaxed);
+            }
+
+            return total;
+        }
+
+        // Adds racing with it may or may not survive
+        void reset()
+        {
+            for (size_t i = 0; i <= m_mask; i++)
+            {
+                m_shards[i].value.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        [[nodiscard]] size_t shards_count() const
+        {
+            return m_mask + 1;
+        }
+
+    private:
+
+        struct alignas(sync::cache_line_size) shard
+        {
+            std::atomic<T> value { 0 };
+        };
+
+        shard& local()
+        {
+            return m_shards[detail::thread_shard_hint() & m_mask];
+        }
+
+    private:
+
+        size_t m_mask;
+
+        std::unique_ptr<shard[]> m_shards;
+
+    };
+
+    template<typename T>
+    struct accumulated
+    {
+        uint64_t count = 0;
+
+        T sum = 0;
+        T min = std::numeric_limits<T>::max();
+        T max = std::numeric_limits<T>::lowest();
+
+        [[nodiscard]] double mean() const
+        {
+            return count > 0 ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+        }
+    };
+
+    // Count, sum, min and max of a stream of samples, sharded the same way as sharded_counter. Min and max only
+    // write when the sample actually improves on them, which after a short warm up is almost never
+    template<typename T = double>
+    class sharded_accumulator
+    {
+        static_assert(std::is_arithmetic_v<T>, "sharded_accumulator only holds numbers");
+
+    public:
+
+        explicit sharded_accumulator(size_t shards_count = detail::default_shard_count())
+            : m_mask(std::bit_ceil(std::max<size_t>(shards_count, 1)) - 1)
+            , m_shards(std::make_unique<shard[]>(m_mask + 1))
+        {
+        }
+
+        sharded_accumulator(const sharded_accumulator&) = delete;
+
+        sharded_accumulator& operator=(const sharded_accumulator&) = delete;
+
+        void add(T sample)
+        {
+            auto& own = local();
+
+            own.count.fetch_add(1, std::memory_order_relaxed);
+            own.sum.fetch_add(sample, std::memory_order_relaxed);
+
+            detail::store_min(own.min, sample);
+            detail::store_max(own.max, sample);
+        }
+
+        // Combines all shards. Same caveat as sharded_counter::load(), and the four fields may also disagree
+        // with each other by the samples added during the call
+        [[nodiscard]] accumulated<T> load() const
+        {
+            accumulated<T> total;
+
+            for (size_t i = 0; i <= m_mask; i++)
+            {
+                const auto& entry = m_shards[i];
+
+                total.count += entry.count.load(std::memory_order_relaxed);
+                total.sum += entry.sum.load(std::memory_order_relaxed);
+                total.min = std::min(total.min, entry.min.load(std::memory_order_relaxed));
+                total.max = std::max(total.max, entry.max.load(std::memory_order_relaxed));
+            }
+
+            return total;
+        }
+
+        void reset()
+        {
+            for (size_t i = 0; i <= m_mask; i++)
+            {
+                auto& entry = m_shards[i];
+
+                entry.count.store(0, std::memory_order_relaxed);
+                entry.sum.store(0, std::memory_order_relaxed);
+                entry.min.store(std::numeric_limits<T>::max(), std::memory_order_relaxed);
+                entry.max.store(std::numeric_limits<T>::lowest(), std::memory_order_relaxed);
+            }
+        }
+
+        [[nodiscard]] size_t shards_count() const
+        {
+            return m_mask + 1;
+        }
+
+    private:
+
+        struct alignas(sync::cache_line_size) shard
+        {
+            std::atomic<uint64_t> count { 0 };
+            std::atomic<T> sum { 0 };
+            std::atomic<T> min { std::numeric_limits<T>::max() };
+            std::atomic<T> max { std::numeric_limits<T>::lowest() };
+        };
+
+        shard& local()
+        {
+            return m_shards[detail::thread_shard_hint() & m_mask];
+        }
+
+    private:
+
+        size_t m_mask;
+
+        std::unique_ptr<shard[]> m_shards;
+
+    };
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cpu.hpp>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// Classic user-space spin locks, kept header-only so the benchmarks measure the algorithm and not a call.
+// All of them satisfy BasicLockable; none of them ever parks, use adaptive_mutex for long critical sections
+namespace retro::mutex
+{
+    // Test-and-test-and-set: waiters spin on a plain load and only attempt the exchange once the lock looks free
+    class ttas_lock
+    {
+    public:
+
+        void lock()
+        {
+            sync::backoff backoff;
+
+            while (m_is_locked.exchange(true, std::memory_order_acquire))
+            {
+                while (m_is_locked.load(std::memory_order_relaxed))
+                {
+                    backoff.pause();
+                }
+            }
+        }
+
+        bool try_lock()
+        {
+            return !m_is_locked.load(std::memory_order_relaxed) && !m_is_locked.exchange(true, std::memory_order_acquire);
+        }
+
+        void unlock()
+        {
+            m_is_locked.store(false, std::memory_order_release);
+        }
+
+    private:
+
+        std::atomic<bool> m_is_locked { false };
+
+    };
+
+    // FIFO fair: every waiter draws a ticket and spins until it is served. All waiters spin on the same line
+    class ticket_lock
+    {
+    public:
+
+        void lock()
+        {
+            const auto ticket = m_next_ticket.fetch_add(1, std::memory_order_relaxed);
+            sync::backoff backoff;
+
+            while (m_now_serving.load(std::memory_order_acquire) != ticket)
+            {
+                backoff.pause();
+            }
+        }
+
+        bool try_lock()
+        {
+            auto serving = m_now_serving.load(std::memory_order_relaxed);
+            return m_next_ticket.compare_exchange_strong(serving, serving + 1, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock()
+        {
+            m_now_serving.store(m_now_serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+    private:
+
+        alignas(sync::cache_line_size) std::atomic<uint32_t> m_next_ticket { 0 };
+        alignas(sync::cache_line_size) std::atomic<uint32_t> m_now_serving { 0 };
+
+    };
+
+    // Mellor-Crummey & Scott queue lock: FIFO, every waiter spins on a flag in its own queue node, so a
+    // release only touches the successor's cache line
+    class mcs_lock
+    {
+    public:
+
+        mcs_lock() = default;
+
+        mcs_lock(const mcs_lock&) = delete;
+
+        mcs_lock& operator=(const mcs_lock&) = delete;
+
+        void lock()
+        {
+            auto * pNode = acquire_node();
+            pNode->next.store(nullptr, std::memory_order_relaxed);
+            pNode->is_locked.store(true, std::memory_order_relaxed);
+
+            auto * pPredecessor = m_tail.exchange(pNode, std::memory_order_acq_rel);
+
+            if (pPredecessor != nullptr)
+            {
+                pPredecessor->next.store(pNode, std::memory_order_release);
+
+                sync::backoff backoff;
+                while (pNode->is_locked.load(std::memory_order_acquire))
+                {
+                    backoff.pause();
+                }
+            }
+
+            m_owner = pNode;
+        }
+
+        void unlock()
+        {
+            auto * pNode = m_owner;
+            auto * pSuccessor = pNode->next.load(std::memory_order_acquire);
+
+            if (pSuccessor == nullptr)
+            {
+                auto * pExpected = pNode;
+
+                if (m_tail.compare_exchange_strong(pExpected, nullptr, std::memory_order_release, std::memory_order_relaxed))
+                {
+                    release_node(pNode);
+                    return;
+                }
+
+                // A successor swapped itself in but has not linked up yet
+                sync::backoff backoff;
+                while ((pSuccessor = pNode->next.load(std::memory_order_acquire)) == nullptr)
+                {
+                    backoff.pause();
+                }
+            }
+
+            pSuccessor->is_locked.store(false, std::memory_order_release);
+            release_node(pNode);
+        }
+
+    private:
+
+        struct alignas(sync::cache_line_size) node
+        {
+            std::atomic<node *> next { nullptr };
+            std::atomic<bool> is_locked { false };
+        };
+
+        // Nodes are recycled per thread, so a thread holding several MCS locks simply takes several nodes
+        static node * acquire_node()
+        {
+            if (m_free_nodes.empty())
+            {
+                return new node();
+            }
+
+            auto * pNode = m_free_nodes.back().release();
+            m_free_nodes.pop_back();
+
+            return pNode;
+        }
+
+        static void release_node(node * pNode)
+        {
+            m_free_nodes.emplace_back(pNode);
+        }
+
+    private:
+
+        alignas(sync::cache_line_size) std::atomic<node *> m_tail { nullptr };
+
+        // Only touched by the lock holder
+        node * m_owner { nullptr };
+
+        inline thread_local static std::vector<std::unique_ptr<node>> m_free_nodes;
+
+    };
+
+    // Craig, Landin & Hagersten queue lock: an implicit queue where every waiter spins on its predecessor's
+    // node. On release the holder keeps the predecessor's node and leaves its own one behind in the queue
+    class clh_lock
+    {
+    public:
+
+        clh_lock()
+        {
+            m_tail.store(new node(), std::memory_order_relaxed);
+        }
+
+        ~clh_lock()
+        {
+            delete m_tail.load(std::memory_order_relaxed);
+        }
+
+        clh_lock(const clh_lock&) = delete;
+
+        clh_lock& operator=(const clh_lock&) = delete;
+
+        void lock()
+        {
+            auto * pNode = acquire_node();
+            pNode->is_locked.store(true, std::memory_order_relaxed);
+
+            auto * pPredecessor = m_tail.exchange(pNode, std::memory_order_acq_rel);
+
+            sync::backoff backoff;
+            while (pPredecessor->is_locked.load(std::memory_order_acquire))
+            {
+                backoff.pause();
+            }
+
+            m_owner = pNode;
+            m_predecessor = pPredecessor;
+        }
+
+        void unlock()
+        {
+            auto * pPredecessor = m_predecessor;
+
+            m_owner->is_locked.store(false, std::memory_order_release);
+            release_node(pPredecessor);
+        }
+
+    private:
+
+        struct alignas(sync::cache_line_size) node
+        {
+            std::atomic<bool> is_locked { false };
+        };
+
+        static node * acquire_node()
+        {
+            if (m_free_nodes.empty())
+            {
+                return new node();
+            }
+
+            auto * pNode = m_free_nodes.back().release();
+            m_free_nodes.pop_back();
+
+            return pNode;
+        }
+
+        static void release_node(node * pNode)
+        {
+            m_free_nodes.emplace_back(pNode);
+        }
+
+    private:
+
+        alignas(sync::cache_line_size) std::atomic<node *> m_tail { nullptr };
+
+        // Only touched by the lock holder
+        node * m_owner { nullptr };
+        node * m_predecessor { nullptr };
+
+        inline thread_local static std::vector<std::unique_ptr<node>> m_free_nodes;
+
+    };
+}
@@ -0,0 +1,412 @@
+#pragma once
+
+#include <pool.hpp>
+#include <future.hpp>
+#include <scheduler.hpp>
+
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <stdexcept>
+#include <coroutine>
+#include <type_traits>
+
+// Lazily started coroutines. A task runs when it is awaited by another task or handed to spawn(); every
+// co_await below suspends the coroutine without holding a thread, and resumes it on the pool worker or the
+// main thread it was suspended on (any other thread continues on the shared pool)
+namespace retro::thread
+{
+    template<typename T = void>
+    class task;
+
+    namespace detail
+    {
+        struct resume_point
+        {
+            pool * pPool { nullptr };
+            bool is_main { false };
+
+            static resume_point here()
+            {
+                resume_point point;
+
+                point.pPool = pool::current();
+                point.is_main = point.pPool == nullptr && main_thread_queue::shared().is_main_thread();
+
+                return point;
+            }
+
+            void resume(std::coroutine_handle<> handle) const
+            {
+                if (is_main)
+                {
+                    main_thread_queue::shared().post([handle]() { handle.resume(); });
+                }
+                else
+                {
+                    (pPool != nullptr ? *pPool : pool::shared()).submit([handle]() { handle.resume(); });
+                }
+            }
+        };
+
+        struct task_promise_base
+        {
+            struct final_awaiter
+            {
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                // Symmetric transfer straight into whoever awaited the task, no stack growth on long chains
+                template<typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+                {
+                    return handle.promise().continuation;
+                }
+
+                void await_resume() const noexcept
+                {
+                }
+            };
+
+            std::suspend_always initial_suspend() const noexcept
+            {
+                return { };
+            }
+
+            final_awaiter final_suspend() const noexcept
+            {
+                return { };
+            }
+
+            void unhandled_exception()
+            {
+                exception = std::current_exception();
+            }
+
+            std::coroutine_handle<> continuation { std::noop_coroutine() };
+            std::exception_ptr exception { nullptr };
+        };
+
+        template<typename T>
+        struct task_promise
+            : task_promise_base
+        {
+            task<T> get_return_object();
+
+            template<typename Value>
+            void return_value(Value&& returned)
+            {
+                value.emplace(std::forward<Value>(returned));
+            }
+
+            T result()
+            {
+                if (exception)
+                {
+                    std::rethrow_exception(exception);
+                }
+
+                return std::move(*value);
+            }
+
+            std::optional<T> value;
+        };
+
+        template<>
+        struct task_promise<void>
+            : task_promise_base
+        {
+            task<void> get_return_object();
+
+            void return_void() const noexcept
+            {
+            }
+
+            void result() const
+            {
+                if (exception)
+                {
+                    std::rethrow_exception(exception);
+                }
+            }
+        };
+
+        // Eager, self-destroying coroutine used by spawn() to drive a task nobody awaits
+        struct detached_task
+        {
+            struct promise_type
+            {
+                detached_task get_return_object() const noexcept
+                {
+                    return { };
+                }
+
+                std::suspend_never initial_suspend() const noexcept
+                {
+                    return { };
+                }
+
+                std::suspend_never final_suspend() const noexcept
+                {
+                    return { };
+                }
+
+                void return_void() const noexcept
+                {
+                }
+
+                void unhandled_exception() const noexcept
+                {
+                    std::terminate();
+                }
+            };
+        };
+
+        template<typename T>
+        detached_task run_detached(task<T> work, promise<T> target)
+        {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    co_await work;
+                    target.set_value();
+                }
+                else
+                {
+                    target.set_value(co_await work);
+                }
+            }
+            catch (...)
+            {
+                target.set_exception(std::current_exception());
+            }
+        }
+    }
+
+    template<typename T>
+    class [[nodiscard]] task
+    {
+    public:
+
+        using promise_type = detail::task_promise<T>;
+
+        task() = default;
+
+        explicit task(std::coroutine_handle<promise_type> handle)
+            : m_handle(handle)
+        {
+        }
+
+        task(task&& other) noexcept
+            : m_handle(std::exchange(other.m_handle, nullptr))
+        {
+        }
+
+        task& operator=(task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (m_handle)
+                {
+                    m_handle.destroy();
+                }
+
+                m_handle = std::exchange(other.m_handle, nullptr);
+            }
+
+            return *this;
+        }
+
+        task(const task&) = delete;
+
+        task& operator=(const task&) = delete;
+
+        ~task()
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+        }
+
+        [[nodiscard]] bool is_valid() const
+        {
+            return static_cast<bool>(m_handle);
+        }
+
+        bool await_ready() const noexcept
+        {
+            return !m_handle || m_handle.done();
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+            m_handle.promise().continuation = awaiting;
+            return m_handle;
+        }
+
+        T await_resume()
+        {
+            if (!m_handle)
+            {
+                throw std::runtime_error("Error: Awaiting an empty task");
+            }
+
+            return m_handle.promise().result();
+        }
+
+    private:
+
+        std::coroutine_handle<promise_type> m_handle { nullptr };
+
+    };
+
+    namespace detail
+    {
+        template<typename T>
+        task<T> task_promise<T>::get_return_object()
+        {
+            return task<T>(std::coroutine_handle<task_promise<T>>::from_promise(*this));
+        }
+
+        inline task<void> task_promise<void>::get_return_object()
+        {
+            return task<void>(std::coroutine_handle<task_promise<void>>::from_promise(*this));
+        }
+    }
+
+    // Starts the task on the calling thread, it runs until its first suspension. The future is how the
+    // result (or exception) comes back; dropping it is fine, the coroutine frame frees itself when done
+    template<typename T>
+    future<T> spawn(task<T> work)
+    {
+        promise<T> target;
+        auto result = target.get_future();
+
+        detail::run_detached(std::move(work), std::move(target));
+
+        return result;
+    }
+
+    // Continues the coroutine as a job of the given pool, a no-op on one of its own workers
+    inline auto resume_on(pool& executor)
+    {
+        struct awaiter
+        {
+            pool& executor;
+
+            bool await_ready() const noexcept
+            {
+                return pool::current() == &executor;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) const
+            {
+                executor.submit([handle]() { handle.resume(); });
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+        };
+
+        return awaiter { executor };
+    }
+
+    // Continues the coroutine on the thread draining main_thread_queue::shared(), i.e. the UI thread
+    inline auto resume_on_main()
+    {
+        struct awaiter
+        {
+            bool await_ready() const noexcept
+            {
+                return main_thread_queue::shared().is_main_thread();
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) const
+            {
+                main_thread_queue::shared().post([handle]() { handle.resume(); });
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+        };
+
+        return awaiter { };
+    }
+
+    template<typename Rep, typename Period>
+    auto delay(std::chrono::duration<Rep, Period> duration)
+    {
+        struct awaiter
+        {
+            timer_service::clock::duration duration;
+
+            bool await_ready() const noexcept
+            {
+                return duration <= timer_service::clock::duration::zero();
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) const
+            {
+                timer_service::shared().schedule(timer_service::clock::now() + duration,
+                                                 [point = detail::resume_point::here(), handle]() { point.resume(handle); });
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+        };
+
+        return awaiter { std::chrono::duration_cast<timer_service::clock::duration>(duration) };
+    }
+
+    // Awaiting a future consumes it, the same way get() does
+    template<typename T>
+    auto operator co_await(future<T>& source)
+    {
+        struct awaiter
+        {
+            std::shared_ptr<detail::future_state<T>> state;
+
+            bool await_ready() const noexcept
+            {
+                return state->is_ready.load(std::memory_order_acquire);
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) const
+            {
+                // The coroutine may be resumed (and this awaiter destroyed) before on_ready returns
+                auto keep_alive = state;
+                keep_alive->on_ready([point = detail::resume_point::here(), handle]() { point.resume(handle); });
+            }
+
+            T await_resume() const
+            {
+                if (state->exception)
+                {
+                    std::rethrow_exception(state->exception);
+                }
+
+                if constexpr (!std::is_void_v<T>)
+                {
+                    return std::move(*state->value);
+                }
+            }
+        };
+
+        return awaiter { detail::future_access::release(source) };
+    }
+
+    template<typename T>
+    auto operator co_await(future<T>&& source)
+    {
+        return operator co_await(source);
+    }
+}
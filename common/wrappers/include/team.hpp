@@ -0,0 +1,81 @@
+#pragma once
+
+#include <barrier.hpp>
+#include <topology.hpp>
+#include <winthread.hpp>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <exception>
+#include <type_traits>
+
+namespace retro::thread
+{
+    // Persistent group of threads for iterative kernels. The same size - 1 winthreads plus the calling
+    // thread run every body handed to run(), and sync() inside the body is a barrier among them, so a kernel
+    // with n iterations pays n barriers instead of n fork/joins. Between runs the members park in the barrier
+    class team
+    {
+    public:
+
+        // Zero members means one per hardware thread. Member i is bound to the i-th CPU of the policy's order,
+        // except member 0: that is whichever thread calls run() and it is left where it is
+        explicit team(uint32_t size = 0, pin_policy policy = pin_policy::none);
+
+        ~team();
+
+        team(const team&) = delete;
+
+        team& operator=(const team&) = delete;
+
+        // Runs func(index, size) on every member, the calling thread being member 0, and returns once all of
+        // them are done. The first exception thrown by a member is rethrown here; a throwing member skips
+        // its remaining sync() calls, so a body that syncs must not throw halfway through
+        template<typename Func>
+        void run(Func&& func)
+        {
+            using body_type = std::remove_reference_t<Func>;
+
+            dispatch(const_cast<void *>(static_cast<const void *>(std::addressof(func))),
+                     [](void * pBody, uint32_t index, uint32_t size) { (*static_cast<body_type *>(pBody))(index, size); });
+        }
+
+        // Barrier among all members, only meaningful inside run(). Every member has to make the same number
+        // of calls. Returns true on exactly one member per phase
+        bool sync(uint32_t index);
+
+        [[nodiscard]] uint32_t size() const;
+
+        [[nodiscard]] pin_policy get_pin_policy() const;
+
+    private:
+
+        using invoker = void (*)(void * pBody, uint32_t index, uint32_t size);
+
+        void dispatch(void * pBody, invoker invoke);
+
+        void run_body(uint32_t index);
+
+        void member_loop(uint32_t index);
+
+    private:
+
+        uint32_t m_size;
+        pin_policy m_pin_policy;
+
+        sync::tree_barrier m_barrier;
+
+        // Written by member 0 before the start barrier, read by the others after it
+        void * m_body { nullptr };
+        invoker m_invoke { nullptr };
+        bool m_is_stopping { false };
+
+        std::atomic<bool> m_has_failed { false };
+        std::exception_ptr m_exception { nullptr };
+
+        std::vector<winthread> m_members;
+
+    };
+}
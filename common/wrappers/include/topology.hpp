@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace retro::thread
+{
+    // Where consecutive workers go. Worker i gets the i-th CPU of topology::order(), wrapping around when
+    // there are more workers than CPUs in the order
+    enum class pin_policy
+    {
+        // Leave placement to the OS scheduler
+        none,
+
+        // Fill a core's SMT siblings first, then the next core, then the next package / NUMA node. Best when
+        // workers share data and few of them are used
+        compact,
+
+        // Spread over NUMA nodes first, then over cores, SMT siblings last. Most cache and memory bandwidth
+        // per worker
+        scatter,
+
+        // One worker per physical core, SMT siblings stay idle. Stable curves up to the physical core count
+        physical_cores
+    };
+
+    constexpr std::array<const char *, 4> pin_policy_names = { "None", "Compact", "Scatter", "One per physical core" };
+
+    struct logical_cpu
+    {
+        // What the OS calls this CPU: the Linux CPU number, or group * 64 + number on Windows
+        uint32_t id = 0;
+
+        // Dense indices, assigned in detection order
+        uint32_t core = 0;
+        uint32_t package = 0;
+        uint32_t numa_node = 0;
+
+        // Group of CPUs behind the same last level cache
+        uint32_t llc = 0;
+
+        // Position among the SMT siblings of its core, 0 for the first one
+        uint32_t smt_index = 0;
+    };
+
+    // Logical CPUs this process may run on, read from /sys/devices/system/cpu and /sys/devices/system/node on
+    // Linux and GetLogicalProcessorInformationEx on Windows. Detection never fails: whatever can not be read
+    // is assumed flat, every CPU its own core on one package and node
+    class topology
+    {
+    public:
+
+        // Detected once, on first use
+        static const topology& current();
+
+        static topology detect();
+
+        [[nodiscard]] const std::vector<logical_cpu>& cpus() const;
+
+        [[nodiscard]] uint32_t logical_count() const;
+
+        [[nodiscard]] uint32_t physical_core_count() const;
+
+        [[nodiscard]] uint32_t package_count() const;
+
+        [[nodiscard]] uint32_t numa_node_count() const;
+
+        [[nodiscard]] uint32_t llc_count() const;
+
+        // CPU ids in placement order for the policy, empty for pin_policy::none
+        [[nodiscard]] std::vector<uint32_t> order(pin_policy policy) const;
+
+        // CPU id for the index-th worker, or -1 for pin_policy::none
+        [[nodiscard]] int32_t cpu_for(pin_policy policy, uint32_t index) const;
+
+        // "16 logical CPUs, 8 cores, 1 package, 1 NUMA node, 2 LLC groups"
+        [[nodiscard]] std::string describe() const;
+
+    private:
+
+        // Renumbers core / package / node / llc keys as read from the OS into dense indices and fills smt_index
+        void normalize();
+
+    private:
+
+        std::vector<logical_cpu> m_cpus;
+
+    };
+
+    // Binds the calling thread to one CPU, -1 lifts any binding. Returns false if the OS refused
+    bool pin_current_thread(int32_t cpu);
+
+    // Binds the calling thread as the index-th worker of the policy, e.g. from inside an OpenMP region with
+    // omp_get_thread_num(). pin_policy::none lifts any binding
+    bool pin_current_thread(pin_policy policy, uint32_t index);
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+// Timeline tracing: scoped zones, counters and flow arrows, recorded per thread and exported as Chrome trace
+// JSON (chrome://tracing, ui.perfetto.dev). Always compiled in, off until start(): a zone then costs a relaxed
+// load when recording is off and two clock reads plus one ring push when it is on.
+//
+// Like the lock profiler every thread records into a fixed-size ring of its own, collect() drains the rings
+// into a per-thread history that keeps the last history() worth of events. A full ring drops the event and
+// counts it. Names are not copied: pass string literals, or intern() anything built at run time
+namespace retro::trace
+{
+    enum class event_kind : uint8_t
+    {
+        zone,
+        counter,
+        flow_begin,
+        flow_step,
+        flow_end
+    };
+
+    struct event
+    {
+        const char * name = "";
+
+        event_kind kind = event_kind::zone;
+
+        // Zones open on the thread when this one started, 0 for the outermost
+        uint16_t depth = 0;
+
+        // Since the process started, see now_ns()
+        uint64_t start_ns = 0;
+
+        // Zones only
+        uint64_t duration_ns = 0;
+
+        // Flows only, the events of one arrow share it
+        uint64_t flow_id = 0;
+
+        // Counters only
+        double value = 0.0;
+    };
+
+    struct thread_timeline
+    {
+        // In the order threads first recorded something, also the tid of the export
+        uint32_t id = 0;
+
+        std::string name;
+
+        // Zones by end time, everything else by start time
+        std::vector<event> events;
+    };
+
+    struct snapshot
+    {
+        std::vector<thread_timeline> threads;
+
+        // The window the events were picked from
+        uint64_t begin_ns = 0;
+        uint64_t end_ns = 0;
+
+        // Events lost to full rings since the last reset()
+        uint64_t dropped = 0;
+    };
+
+    namespace detail
+    {
+        inline std::atomic<bool> is_recording { false };
+
+        inline thread_local uint16_t depth = 0;
+
+        void record(const event& recorded);
+    }
+
+    [[nodiscard]] inline bool is_recording()
+    {
+        return detail::is_recording.load(std::memory_order_relaxed);
+    }
+
+    void start();
+
+    void stop();
+
+    // The trace clock, steady and shared by all threads
+    [[nodiscard]] uint64_t now_ns();
+
+    // Stable copy of a name built at run time. Takes a lock, keep it out of hot loops
+    [[nodiscard]] const char * intern(std::string_view name);
+
+    // Shown instead of "Thread N" in the timeline and the export. Allocates nothing: a thread that never
+    // records gets no ring
+    void set_thread_name(std::string_view name);
+
+    // How far back collect() keeps events, 10 s by default
+    void set_history(std::chrono::milliseconds history);
+
+    [[nodiscard]] std::chrono::milliseconds history();
+
+    // Drains every thread's ring and returns the events of the last window (the whole history if it is zero).
+    // Threads without events in the window are left out
+    snapshot collect(std::chrono::milliseconds window = std::chrono::milliseconds(0));
+
+    void reset();
+
+    // Writes the whole history as Chrome trace JSON, returns false if the file could not be written
+    bool export_chrome(const std::string& path);
+
+    // Unique within the process, for the flow_* calls
+    [[nodiscard]] uint64_t new_flow_id();
+
+    void counter(const char * name, double value);
+
+    // An arrow from the zone around flow_begin() through the ones around flow_step() to the zone around
+    // flow_end(), usually on different threads: a job posted here and picked up there
+    void flow_begin(const char * name, uint64_t id);
+
+    void flow_step(const char * name, uint64_t id);
+
+    void flow_end(const char * name, uint64_t id);
+
+    class zone
+    {
+    public:
+
+        explicit zone(const char * name)
+        {
+            if (is_recording())
+            {
+                m_name = name;
+                m_depth = detail::depth++;
+                m_start_ns = now_ns();
+            }
+        }
+
+        ~zone()
+        {
+            if (m_name != nullptr)
+            {
+                const auto end_ns = now_ns();
+                detail::depth--;
+
+                event recorded;
+
+                recorded.name = m_name;
+                recorded.depth = m_depth;
+                recorded.start_ns = m_start_ns;
+                recorded.duration_ns = end_ns - m_start_ns;
+
+                detail::record(recorded);
+            }
+        }
+
+        zone(const zone&) = delete;
+
+        zone& operator=(const zone&) = delete;
+
+    private:
+
+        // Null when recording was off on entry, the zone then records nothing even if it was started since
+        const char * m_name { nullptr };
+
+        uint16_t m_depth { 0 };
+
+        uint64_t m_start_ns { 0 };
+
+    };
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+
+namespace retro::thread
+{
+    template<typename Signature, size_t InlineSize = 6 * sizeof(void *)>
+    class unique_function;
+
+    // Move-only replacement for std::function. Callables up to InlineSize bytes that can be moved without
+    // throwing live inside the object, bigger ones take a single heap allocation. Move-only callables
+    // (unique_ptr captures, packaged tasks) are accepted, and there is no copy to pay for on the way in
+    template<typename R, typename... Args, size_t InlineSize>
+    class unique_function<R(Args...), InlineSize>
+    {
+    public:
+
+        unique_function() = default;
+
+        unique_function(std::nullptr_t)
+        {
+        }
+
+        template<
+                typename Func,
+                typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, unique_function> && std::is_invocable_r_v<R, std::decay_t<Func>&, Args...>>
+        >
+        unique_function(Func&& func)
+        {
+            emplace<std::decay_t<Func>>(std::forward<Func>(func));
+        }
+
+        unique_function(unique_function&& other) noexcept
+        {
+            move_from(other);
+        }
+
+        unique_function& operator=(unique_function&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                move_from(other);
+            }
+
+            return *this;
+        }
+
+        unique_function& operator=(std::nullptr_t)
+        {
+            reset();
+            return *this;
+        }
+
+        template<
+                typename Func,
+                typename = std::enable_if_t<!std::is_same_v<std::decay_t<Func>, unique_function> && std::is_invocable_r_v<R, std::decay_t<Func>&, Args...>>
+        >
+        unique_function& operator=(Func&& func)
+        {
+            reset();
+            emplace<std::decay_t<Func>>(std::forward<Func>(func));
+
+            return *this;
+        }
+
+        unique_function(const unique_function&) = delete;
+
+        unique_function& operator=(const unique_function&) = delete;
+
+        ~unique_function()
+        {
+            reset();
+        }
+
+        R operator()(Args... args)
+        {
+            if (m_ops == nullptr)
+            {
+                throw std::bad_function_call();
+            }
+
+            return m_ops->invoke(m_storage, std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const
+        {
+            return m_ops != nullptr;
+        }
+
+        // True when the callable lives inside the object, i.e. constructing it did not allocate
+        [[nodiscard]] bool is_inline() const
+        {
+            return m_ops != nullptr && m_ops->is_inline;
+        }
+
+        void reset()
+        {
+            if (m_ops != nullptr)
+            {
+                m_ops->destroy(m_storage);
+                m_ops = nullptr;
+            }
+        }
+
+        template<typename Func>
+        static constexpr bool fits_inline = sizeof(Func) <= InlineSize
+                                            && alignof(Func) <= alignof(std::max_align_t)
+                                            && std::is_nothrow_move_constructible_v<Func>;
+
+    private:
+
+        // One table per stored type instead of virtual functions, so the object itself holds no vptr
+        struct operations
+        {
+            R (*invoke)(void * storage, Args&&... args);
+            void (*relocate)(void * destination, void * source) noexcept;
+            void (*destroy)(void * storage) noexcept;
+            bool is_inline;
+        };
+
+        template<typename Func>
+        struct inline_operations
+        {
+            static Func * get(void * storage)
+            {
+                return std::launder(static_cast<Func *>(storage));
+            }
+
+            static R invoke(void * storage, Args&&... args)
+            {
+                return std::invoke(*get(storage), std::forward<Args>(args)...);
+            }
+
+            static void relocate(void * destination, void * source) noexcept
+            {
+                new (destination) Func(std::move(*get(source)));
+                get(source)->~Func();
+            }
+
+            static void destroy(void * storage) noexcept
+            {
+                get(storage)->~Func();
+            }
+
+            static constexpr operations table { &invoke, &relocate, &destroy, true };
+        };
+
+        template<typename Func>
+        struct heap_operations
+        {
+            static Func *& get(void * storage)
+            {
+                return *std::launder(static_cast<Func **>(storage));
+            }
+
+            static R invoke(void * storage, Args&&... args)
+            {
+                return std::invoke(*get(storage), std::forward<Args>(args)...);
+            }
+
+            static void relocate(void * destination, void * source) noexcept
+            {
+                new (destination) Func *(get(source));
+            }
+
+            static void destroy(void * storage) noexcept
+            {
+                delete get(storage);
+            }
+
+            static constexpr operations table { &invoke, &relocate, &destroy, false };
+        };
+
+        template<typename Func, typename Source>
+        void emplace(Source&& func)
+        {
+            if constexpr (fits_inline<Func>)
+            {
+                new (m_storage) Func(std::forward<Source>(func));
+                m_ops = &inline_operations<Func>::table;
+            }
+            else
+            {
+                new (m_storage) Func *(new Func(std::forward<Source>(func)));
+                m_ops = &heap_operations<Func>::table;
+            }
+        }
+
+        void move_from(unique_function& other) noexcept
+        {
+            if (other.m_ops != nullptr)
+            {
+                other.m_ops->relocate(m_storage, other.m_storage);
+
+                m_ops = other.m_ops;
+                other.m_ops = nullptr;
+            }
+        }
+
+    private:
+
+        static_assert(InlineSize >= sizeof(void *), "unique_function needs room for at least a pointer");
+
+        const operations * m_ops { nullptr };
+
+        alignas(std::max_align_t) unsigned char m_storage[InlineSize];
+
+    };
+}
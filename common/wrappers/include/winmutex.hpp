@@ -1,10 +1,13 @@
 #pragma once
 
-#if !defined(_WIN32) && !defined(WIN32)
-# error "Incompatible platform"
+#if defined(_WIN32) || defined(WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
 #endif
 
-#include <windows.h>
+#include <lock_profiler.hpp>
+
 #include <stdexcept>
 
 namespace retro::mutex
@@ -17,13 +20,42 @@ namespace retro::mutex
 
         ~winmutex();
 
+#if defined(RETRO_LOCK_PROFILING)
+        void lock(std::source_location site = std::source_location::current());
+#else
         void lock();
+#endif
 
         void unlock();
 
+        // Label for the lock profiler, has to outlive the lock. Does nothing without RETRO_LOCK_PROFILING
+        void set_name(const char * name)
+        {
+#if defined(RETRO_LOCK_PROFILING)
+            m_probe.set_name(name);
+#else
+            (void)name;
+#endif
+        }
+
     protected:
 
+        // Blocks until the mutex is owned, the part of lock() that does not depend on profiling
+        void lock_native();
+
+#if defined(RETRO_LOCK_PROFILING)
+        // True if the mutex was free, i.e. locking it does not count as contended
+        bool try_lock_native();
+
+        profiling::lock_probe m_probe;
+#endif
+
+#if defined(_WIN32) || defined(WIN32)
         HANDLE m_hMutex;
+#else
+        // Recursive, like the Win32 mutex object it stands in for
+        pthread_mutex_t m_mutex;
+#endif
 
     };
 }
@@ -1,11 +1,20 @@
 #pragma once
 
-#if !defined(_WIN32) && !defined(WIN32)
-# error "Incompatible platform"
+#if defined(_WIN32) || defined(WIN32)
+# include <windows.h>
+#else
+# include <pthread.h>
+# include <sys/types.h>
 #endif
 
-#include <windows.h>
-#include <functional>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <tuple>
+#include <cstdint>
+#include <stop_token>
+
+#include <unique_function.hpp>
 
 namespace retro::thread
 {
@@ -18,11 +27,27 @@ namespace retro::thread
         high
     };
 
+    // A paused thread is still considered running, see winthread::is_running()
+    enum class state : uint32_t
+    {
+        idle,
+        running,
+        paused,
+        finished
+    };
+
     class winthread
     {
     public:
+
+        using clock = std::chrono::steady_clock;
+
         explicit winthread() = default;
 
+        winthread(winthread&& other) noexcept = default;
+
+        winthread& operator=(winthread&& other) noexcept;
+
         ~winthread();
 
         void run();
@@ -39,12 +64,45 @@ namespace retro::thread
 
         void set_priority(priority priority);
 
+        // Binds the thread to one logical CPU (see topology), -1 lifts the binding. Like the priority it is
+        // remembered and applied by every run(), and right away if the thread is running
+        void set_affinity(int32_t cpu);
+
+        [[nodiscard]] int32_t get_affinity() const;
+
         [[nodiscard]] bool is_paused() const;
 
         [[nodiscard]] bool is_running() const;
 
         [[nodiscard]] bool is_finished() const;
 
+        [[nodiscard]] state get_state() const;
+
+        // Blocks until the thread reaches the given state, returns false if it did not within the timeout.
+        // The state word is only notified on transitions, so waiting costs nothing while the worker runs
+        bool wait_for_state(state target, std::chrono::nanoseconds timeout) const;
+
+        // Taken by the worker itself right before and right after the runnable, both are the epoch until
+        // the thread gets there. Terminated threads get the moment terminate() returned as finish time
+        [[nodiscard]] clock::time_point get_start_time() const;
+
+        [[nodiscard]] clock::time_point get_finish_time() const;
+
+        // Cooperative cancellation: every run() gets a fresh stop source, the runnable (and whatever it hands
+        // the token to, e.g. OpenMP team members) polls it at convenient points and returns early.
+        // Unlike terminate() this is safe in the middle of an OpenMP region or while holding a lock
+        bool request_stop();
+
+        [[nodiscard]] std::stop_token get_stop_token() const;
+
+        // Token of the winthread the caller is running on, one that never stops on foreign threads
+        static std::stop_token current_stop_token();
+
+        // Parks the calling thread while the winthread it belongs to is paused. On POSIX there is no safe way
+        // to suspend a thread from the outside, so pause() and terminate() only take effect once the worker
+        // reaches a safe point (or a blocking call, for terminate()). Does nothing on foreign threads
+        static void safe_point();
+
         template<
                 typename Func,
                 typename... Args,
@@ -52,11 +110,7 @@ namespace retro::thread
         >
         void run(Func&& runnable, Args&&... args)
         {
-            auto args_tuple = std::make_tuple(std::forward<Args>(args)...);
-            m_invoke = [runnable, args_tuple]() mutable
-            {
-                std::apply(runnable, args_tuple);
-            };
+            m_context->invoke = bind_runnable(std::forward<Func>(runnable), std::forward<Args>(args)...);
             run();
         }
 
@@ -67,30 +121,84 @@ namespace retro::thread
         >
         explicit winthread(Func&& runnable, Args&&... args)
         {
-            auto args_tuple = std::make_tuple(std::forward<Args>(args)...);
-            m_invoke = [runnable, args_tuple]() mutable
-            {
-                std::apply(runnable, args_tuple);
-            };
+            m_context->invoke = bind_runnable(std::forward<Func>(runnable), std::forward<Args>(args)...);
         }
 
     protected:
 
-        using winthread_runnable_internal = std::function<void()>;
+        using winthread_runnable_internal = unique_function<void()>;
 
-        bool m_is_paused { false };
-        bool m_is_running { false };
-        bool m_is_finished { false };
+        // Moves rvalue callables and arguments in instead of copying them. The result is invoked again on
+        // every run(), so bound arguments are handed to the runnable as lvalues
+        template<typename Func, typename... Args>
+        static winthread_runnable_internal bind_runnable(Func&& runnable, Args&&... args)
+        {
+            if constexpr (sizeof...(Args) == 0)
+            {
+                return winthread_runnable_internal(std::forward<Func>(runnable));
+            }
+            else
+            {
+                return [runnable = std::forward<Func>(runnable), args_tuple = std::make_tuple(std::forward<Args>(args)...)]() mutable
+                {
+                    std::apply(runnable, args_tuple);
+                };
+            }
+        }
+
+        // Everything the worker touches lives here, so moving a winthread (e.g. inside a std::vector)
+        // never pulls the state from under a running thread
+        struct context
+        {
+            // Written by both the owner and the worker, waited on through sync::futex_wait_for
+            std::atomic<uint32_t> status { static_cast<uint32_t>(state::idle) };
+
+            std::atomic<clock::rep> start_ticks { 0 };
+            std::atomic<clock::rep> finish_ticks { 0 };
+
+            // Only replaced by run() while no worker exists
+            std::stop_source stop;
 
-        HANDLE m_hThread { nullptr };
+            priority current_priority { priority::normal };
 
-        priority m_priority { priority::normal };
+            int32_t affinity { -1 };
 
-        winthread_runnable_internal m_invoke { nullptr };
+            winthread_runnable_internal invoke;
+
+#if defined(_WIN32) || defined(WIN32)
+            HANDLE hThread { nullptr };
+#else
+            pthread_t thread { };
+            pid_t native_id { 0 };
+            bool is_joinable { false };
+#endif
+
+            [[nodiscard]] state load_state() const
+            {
+                return static_cast<state>(status.load(std::memory_order_acquire));
+            }
+
+            void store_state(state new_state);
+
+            bool exchange_state(state expected, state desired);
+
+            void stamp(std::atomic<clock::rep>& ticks)
+            {
+                ticks.store(clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+            }
+        };
+
+        std::unique_ptr<context> m_context { std::make_unique<context>() };
 
     private:
 
+        inline thread_local static context * m_current_context { nullptr };
+
+#if defined(_WIN32) || defined(WIN32)
         static DWORD WINAPI thread_function(LPVOID lpParam);
+#else
+        static void * thread_function(void * param);
+#endif
 
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,112 @@
+#include <adaptive_mutex.hpp>
+
+#include <cpu.hpp>
+#include <futex.hpp>
+
+using namespace retro::mutex;
+
+adaptive_mutex::adaptive_mutex(uint32_t spin_limit)
+    : m_spin_limit(spin_limit)
+{
+}
+
+#if defined(RETRO_LOCK_PROFILING)
+void adaptive_mutex::lock(std::source_location site)
+{
+    const auto started = profiling::clock::now();
+    uint32_t expected = unlocked;
+
+    const bool is_contended = !m_state.compare_exchange_strong(expected, locked, std::memory_order_acquire, std::memory_order_relaxed);
+
+    if (is_contended)
+    {
+        lock_contended();
+    }
+
+    m_probe.acquired(started, is_contended, site);
+}
+
+bool adaptive_mutex::try_lock(std::source_location site)
+{
+    const auto started = profiling::clock::now();
+    uint32_t expected = unlocked;
+
+    if (!m_state.compare_exchange_strong(expected, locked, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    m_probe.acquired(started, false, site);
+    return true;
+}
+#else
+void adaptive_mutex::lock()
+{
+    uint32_t expected = unlocked;
+
+    if (!m_state.compare_exchange_strong(expected, locked, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+        lock_contended();
+    }
+}
+
+bool adaptive_mutex::try_lock()
+{
+    uint32_t expected = unlocked;
+    return m_state.compare_exchange_strong(expected, locked, std::memory_order_acquire, std::memory_order_relaxed);
+}
+#endif
+
+void adaptive_mutex::unlock()
+{
+#if defined(RETRO_LOCK_PROFILING)
+    m_probe.released(this);
+#endif
+
+    if (m_state.exchange(unlocked, std::memory_order_release) == locked_with_waiters)
+    {
+        sync::futex_wake_one(m_state);
+    }
+}
+
+void adaptive_mutex::lock_contended()
+{
+    // Spin while the owner is likely to be running on another core, backing off exponentially so the
+    // spinners do not hammer the line. Stop early once somebody is already parked: the lock is clearly
+    // held for long and spinning only delays them further
+    uint32_t backoff = 1;
+
+    for (uint32_t spin = 0; spin < m_spin_limit; spin += backoff)
+    {
+        auto current = m_state.load(std::memory_order_relaxed);
+
+        if (current == unlocked)
+        {
+            if (m_state.compare_exchange_weak(current, locked, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                return;
+            }
+        }
+        else if (current == locked_with_waiters)
+        {
+            break;
+        }
+
+        for (uint32_t i = 0; i < backoff; i++)
+        {
+            sync::cpu_relax();
+        }
+
+        backoff = backoff < 32 ? backoff * 2 : backoff;
+    }
+
+    // Drepper's "Futexes are tricky" mutex #3: once we park, the state stays locked_with_waiters until the
+    // last waiter leaves, so unlock() knows it has to issue a wake
+    auto current = m_state.exchange(locked_with_waiters, std::memory_order_acquire);
+
+    while (current != unlocked)
+    {
+        sync::futex_wait(m_state, locked_with_waiters);
+        current = m_state.exchange(locked_with_waiters, std::memory_order_acquire);
+    }
+}
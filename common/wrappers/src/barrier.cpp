@@ -0,0 +1,345 @@
+#include <barrier.hpp>
+
+#include <futex.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace retro::sync;
+
+namespace
+{
+    // True once the phase word moved past target. Wrap-around safe as long as nobody lags 2^31 phases
+    bool is_past(uint32_t phase, uint32_t target)
+    {
+        return static_cast<int32_t>(phase - target) > 0;
+    }
+
+    // Spins, then parks until the phase word moves past target. The sleepers count is what lets the
+    // releasing side skip the wake syscall when everybody was still spinning; both sides use seq_cst so
+    // either the waiter sees the new phase or the releaser sees the waiter
+    uint32_t wait_past(std::atomic<uint32_t>& phase, uint32_t target, std::atomic<uint32_t>& sleepers, uint32_t spin_limit)
+    {
+        for (uint32_t spin = 0; spin < spin_limit; spin++)
+        {
+            const auto current = phase.load(std::memory_order_acquire);
+
+            if (is_past(current, target))
+            {
+                return current;
+            }
+
+            cpu_relax();
+        }
+
+        sleepers.fetch_add(1, std::memory_order_seq_cst);
+
+        auto current = phase.load(std::memory_order_seq_cst);
+
+        while (!is_past(current, target))
+        {
+            futex_wait(phase, current);
+            current = phase.load(std::memory_order_seq_cst);
+        }
+
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+        return current;
+    }
+
+    void wake_sleepers(std::atomic<uint32_t>& phase, std::atomic<uint32_t>& sleepers)
+    {
+        if (sleepers.load(std::memory_order_seq_cst) != 0)
+        {
+            futex_wake_all(phase);
+        }
+    }
+
+    void check_count(uint32_t count)
+    {
+        if (count == 0)
+        {
+            throw std::runtime_error("Error: Barrier needs at least one participant");
+        }
+    }
+}
+
+latch::latch(uint32_t count, uint32_t spin_limit)
+    : m_spin_limit(spin_limit)
+    , m_remaining(count)
+{
+}
+
+void latch::count_down(uint32_t amount)
+{
+    const auto previous = m_remaining.fetch_sub(amount, std::memory_order_acq_rel);
+
+    if (previous < amount)
+    {
+        throw std::runtime_error("Error: Latch counted down below zero");
+    }
+
+    // Single use, so one unconditional wake at the very end is cheaper than tracking sleepers
+    if (previous == amount)
+    {
+        futex_wake_all(m_remaining);
+    }
+}
+
+bool latch::try_wait() const
+{
+    return m_remaining.load(std::memory_order_acquire) == 0;
+}
+
+void latch::wait() const
+{
+    for (uint32_t spin = 0; spin < m_spin_limit; spin++)
+    {
+        if (try_wait())
+        {
+            return;
+        }
+
+        cpu_relax();
+    }
+
+    auto current = m_remaining.load(std::memory_order_acquire);
+
+    while (current != 0)
+    {
+        futex_wait(m_remaining, current);
+        current = m_remaining.load(std::memory_order_acquire);
+    }
+}
+
+void latch::arrive_and_wait(uint32_t amount)
+{
+    count_down(amount);
+    wait();
+}
+
+barrier::barrier(uint32_t count, uint32_t spin_limit)
+    : m_count(count)
+    , m_spin_limit(spin_limit)
+    , m_remaining(count)
+{
+    check_count(count);
+}
+
+bool barrier::arrive_and_wait()
+{
+    // Has to be read before arriving: the phase cannot move until this thread's arrival is counted
+    const auto phase = m_phase.load(std::memory_order_acquire);
+
+    if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+        wait_past(m_phase, phase, m_sleepers, m_spin_limit);
+        return false;
+    }
+
+    m_remaining.store(m_count, std::memory_order_relaxed);
+    m_phase.fetch_add(1, std::memory_order_seq_cst);
+
+    wake_sleepers(m_phase, m_sleepers);
+    return true;
+}
+
+uint32_t barrier::count() const
+{
+    return m_count;
+}
+
+tree_barrier::tree_barrier(uint32_t count, uint32_t spin_limit)
+    : m_count(count)
+    , m_spin_limit(spin_limit)
+{
+    check_count(count);
+
+    // Levels are stored one after another, leaves first, the root is the last node
+    std::vector<uint32_t> level_sizes;
+
+    for (uint32_t members = count; ; members = level_sizes.back())
+    {
+        level_sizes.push_back((members + fan_in - 1) / fan_in);
+
+        if (level_sizes.back() == 1)
+        {
+            break;
+        }
+    }
+
+    uint32_t total = 0;
+    for (const auto size : level_sizes)
+    {
+        total += size;
+    }
+
+    m_nodes = std::make_unique<node[]>(total);
+
+    uint32_t offset = 0;
+    uint32_t members = count;
+
+    for (const auto size : level_sizes)
+    {
+        const auto next_offset = offset + size;
+
+        for (uint32_t i = 0; i < size; i++)
+        {
+            auto& current = m_nodes[offset + i];
+
+            current.count = std::min(fan_in, members - i * fan_in);
+            current.remaining.store(current.count, std::memory_order_relaxed);
+            current.parent = size == 1 ? no_parent : next_offset + i / fan_in;
+        }
+
+        offset = next_offset;
+        members = size;
+    }
+}
+
+bool tree_barrier::arrive_and_wait(uint32_t index)
+{
+    const auto phase = m_phase.load(std::memory_order_acquire);
+
+    for (auto current = index / fan_in; ;)
+    {
+        auto& arrived = m_nodes[current];
+
+        if (arrived.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        {
+            wait_past(m_phase, phase, m_sleepers, m_spin_limit);
+            return false;
+        }
+
+        // Last of its group: nobody touches this node again before the release, reset it and climb
+        arrived.remaining.store(arrived.count, std::memory_order_relaxed);
+
+        if (arrived.parent == no_parent)
+        {
+            break;
+        }
+
+        current = arrived.parent;
+    }
+
+    m_phase.fetch_add(1, std::memory_order_seq_cst);
+
+    wake_sleepers(m_phase, m_sleepers);
+    return true;
+}
+
+uint32_t tree_barrier::count() const
+{
+    return m_count;
+}
+
+phaser::phaser(uint32_t parties, uint32_t spin_limit)
+    : m_spin_limit(spin_limit)
+    , m_state(pack(0, parties, parties))
+    , m_phase(0)
+{
+    if (parties > party_mask)
+    {
+        throw std::runtime_error("Error: Too many phaser parties");
+    }
+}
+
+uint64_t phaser::pack(uint32_t phase, uint32_t parties, uint32_t unarrived)
+{
+    return (static_cast<uint64_t>(phase) << phase_shift) | (static_cast<uint64_t>(parties) << parties_shift) | unarrived;
+}
+
+uint32_t phaser::register_party()
+{
+    auto state = m_state.load(std::memory_order_acquire);
+
+    while (true)
+    {
+        const auto phase = static_cast<uint32_t>(state >> phase_shift);
+        const auto parties = static_cast<uint32_t>((state >> parties_shift) & party_mask);
+        const auto unarrived = static_cast<uint32_t>(state & party_mask);
+
+        if (parties == party_mask)
+        {
+            throw std::runtime_error("Error: Too many phaser parties");
+        }
+
+        if (m_state.compare_exchange_weak(state, pack(phase, parties + 1, unarrived + 1), std::memory_order_acq_rel))
+        {
+            return phase;
+        }
+    }
+}
+
+uint32_t phaser::arrive()
+{
+    return arrive(0);
+}
+
+uint32_t phaser::arrive_and_deregister()
+{
+    return arrive(1);
+}
+
+uint32_t phaser::arrive_and_wait()
+{
+    return await_advance(arrive(0));
+}
+
+uint32_t phaser::arrive(uint32_t parties_delta)
+{
+    auto state = m_state.load(std::memory_order_acquire);
+
+    while (true)
+    {
+        const auto phase = static_cast<uint32_t>(state >> phase_shift);
+        const auto parties = static_cast<uint32_t>((state >> parties_shift) & party_mask);
+        const auto unarrived = static_cast<uint32_t>(state & party_mask);
+
+        if (unarrived == 0)
+        {
+            throw std::runtime_error("Error: Phaser arrival without a registered party");
+        }
+
+        const auto remaining_parties = parties - parties_delta;
+        const auto is_last = unarrived == 1;
+
+        const auto next = is_last ? pack(phase + 1, remaining_parties, remaining_parties)
+                                  : pack(phase, remaining_parties, unarrived - 1);
+
+        if (!m_state.compare_exchange_weak(state, next, std::memory_order_acq_rel))
+        {
+            continue;
+        }
+
+        if (is_last)
+        {
+            // Two advances in a row may publish out of order, the mirror only ever moves forward
+            auto mirrored = m_phase.load(std::memory_order_relaxed);
+
+            while (is_past(phase + 1, mirrored)
+                   && !m_phase.compare_exchange_weak(mirrored, phase + 1, std::memory_order_seq_cst))
+            {
+            }
+
+            wake_sleepers(m_phase, m_sleepers);
+        }
+
+        return phase;
+    }
+}
+
+uint32_t phaser::await_advance(uint32_t phase) const
+{
+    return wait_past(m_phase, phase, m_sleepers, m_spin_limit);
+}
+
+uint32_t phaser::get_phase() const
+{
+    return static_cast<uint32_t>(m_state.load(std::memory_order_acquire) >> phase_shift);
+}
+
+uint32_t phaser::get_registered_parties() const
+{
+    return static_cast<uint32_t>((m_state.load(std::memory_order_acquire) >> parties_shift) & party_mask);
+}
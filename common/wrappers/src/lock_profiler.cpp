@@ -0,0 +1,271 @@
+#include <lock_profiler.hpp>
+
+#include <cpu.hpp>
+
+#include <map>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdio>
+#include <utility>
+#include <fstream>
+#include <algorithm>
+
+using namespace retro::mutex::profiling;
+
+namespace
+{
+    struct event
+    {
+        const void * lock = nullptr;
+        const char * name = nullptr;
+
+        const char * file = "";
+        const char * function = "";
+        uint32_t line = 0;
+
+        bool is_contended = false;
+
+        uint64_t wait_ns = 0;
+        uint64_t hold_ns = 0;
+    };
+
+    // Written by its thread only, drained by collect() only (under the registry lock): a plain SPSC ring
+    struct thread_ring
+    {
+        static constexpr uint32_t capacity = 4096;
+
+        std::array<event, capacity> events;
+
+        alignas(retro::sync::cache_line_size) std::atomic<uint32_t> head { 0 };
+        alignas(retro::sync::cache_line_size) std::atomic<uint32_t> tail { 0 };
+
+        std::atomic<uint64_t> dropped { 0 };
+
+        void push(const event& recorded)
+        {
+            const auto position = head.load(std::memory_order_relaxed);
+
+            if (position - tail.load(std::memory_order_acquire) == capacity)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            events.at(position % capacity) = recorded;
+            head.store(position + 1, std::memory_order_release);
+        }
+    };
+
+    struct lock_totals
+    {
+        lock_stats summary;
+        std::map<std::pair<const char *, uint32_t>, site_stats> sites;
+    };
+
+    struct registry
+    {
+        std::mutex sync;
+
+        // Rings outlive their threads until the next drain, so nothing recorded right before exit is lost
+        std::vector<std::shared_ptr<thread_ring>> rings;
+
+        std::map<const void *, lock_totals> totals;
+        uint64_t dropped = 0;
+    };
+
+    registry& get_registry()
+    {
+        static registry instance;
+        return instance;
+    }
+
+    thread_ring& local_ring()
+    {
+        thread_local const auto ring = []()
+        {
+            auto created = std::make_shared<thread_ring>();
+
+            auto& shared = get_registry();
+            std::lock_guard lock(shared.sync);
+            shared.rings.push_back(created);
+
+            return created;
+        }();
+
+        return *ring;
+    }
+
+    void add(stats& target, const event& recorded)
+    {
+        target.acquisitions++;
+        target.contended += recorded.is_contended ? 1 : 0;
+
+        target.wait_ns_total += recorded.wait_ns;
+        target.wait_ns_max = std::max(target.wait_ns_max, recorded.wait_ns);
+
+        target.hold_ns_total += recorded.hold_ns;
+        target.hold_ns_max = std::max(target.hold_ns_max, recorded.hold_ns);
+    }
+
+    void merge(registry& shared, const event& recorded)
+    {
+        auto& totals = shared.totals[recorded.lock];
+
+        totals.summary.address = recorded.lock;
+
+        if (recorded.name != nullptr)
+        {
+            totals.summary.name = recorded.name;
+        }
+
+        add(totals.summary, recorded);
+
+        auto& site = totals.sites[{ recorded.file, recorded.line }];
+
+        site.file = recorded.file;
+        site.function = recorded.function;
+        site.line = recorded.line;
+
+        add(site, recorded);
+    }
+
+    // Expects the registry lock to be held
+    void drain(registry& shared, bool keep)
+    {
+        for (const auto& ring : shared.rings)
+        {
+            const auto end = ring->head.load(std::memory_order_acquire);
+
+            for (auto position = ring->tail.load(std::memory_order_relaxed); keep && position != end; position++)
+            {
+                merge(shared, ring->events.at(position % thread_ring::capacity));
+            }
+
+            ring->tail.store(end, std::memory_order_release);
+            shared.dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+        }
+
+        // Only the registry still points at the ring of a thread that has exited, and it was just drained
+        std::erase_if(shared.rings, [](const std::shared_ptr<thread_ring>& ring) { return ring.use_count() == 1; });
+    }
+
+    bool by_total_wait(const stats& lhs, const stats& rhs)
+    {
+        return lhs.wait_ns_total > rhs.wait_ns_total;
+    }
+
+    std::string describe_address(const void * address)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "lock %p", address);
+
+        return buffer;
+    }
+}
+
+void lock_probe::record(const void * pLock, clock::time_point released_at) const
+{
+    event recorded;
+
+    recorded.lock = pLock;
+    recorded.name = m_name;
+
+    recorded.file = m_site.file_name();
+    recorded.function = m_site.function_name();
+    recorded.line = m_site.line();
+
+    recorded.is_contended = m_is_contended;
+    recorded.wait_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(m_wait).count());
+    recorded.hold_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(released_at - m_acquired_at).count());
+
+    local_ring().push(recorded);
+}
+
+report retro::mutex::profiling::collect()
+{
+    auto& shared = get_registry();
+    std::lock_guard lock(shared.sync);
+
+    drain(shared, true);
+
+    report result;
+    result.dropped = shared.dropped;
+
+    for (const auto& [address, totals] : shared.totals)
+    {
+        auto summary = totals.summary;
+
+        if (summary.name.empty())
+        {
+            summary.name = describe_address(address);
+        }
+
+        for (const auto& [key, site] : totals.sites)
+        {
+            summary.sites.push_back(site);
+        }
+
+        std::sort(summary.sites.begin(), summary.sites.end(), by_total_wait);
+        result.locks.push_back(std::move(summary));
+    }
+
+    std::sort(result.locks.begin(), result.locks.end(), by_total_wait);
+    return result;
+}
+
+void retro::mutex::profiling::reset()
+{
+    auto& shared = get_registry();
+    std::lock_guard lock(shared.sync);
+
+    drain(shared, false);
+
+    shared.totals.clear();
+    shared.dropped = 0;
+}
+
+bool retro::mutex::profiling::dump(const std::string& path)
+{
+    const auto result = collect();
+    std::ofstream file(path);
+
+    if (!file)
+    {
+        return false;
+    }
+
+    char line[512];
+
+    const auto write_row = [&](const char * label, const stats& row)
+    {
+        std::snprintf(line, sizeof(line), "%-48s %12llu %9.2f%% %14.3f %12.3f %14.3f %12.3f\n",
+                      label,
+                      static_cast<unsigned long long>(row.acquisitions),
+                      row.contention_ratio() * 100.0,
+                      static_cast<double>(row.wait_ns_total) / 1e6,
+                      static_cast<double>(row.wait_ns_max) / 1e3,
+                      static_cast<double>(row.hold_ns_total) / 1e6,
+                      static_cast<double>(row.hold_ns_max) / 1e3);
+        file << line;
+    };
+
+    std::snprintf(line, sizeof(line), "%-48s %12s %10s %14s %12s %14s %12s\n",
+                  "Lock / call site", "Acquired", "Contended", "Wait total ms", "Wait max us", "Hold total ms", "Hold max us");
+    file << line;
+
+    for (const auto& lock : result.locks)
+    {
+        write_row(lock.name.c_str(), lock);
+
+        for (const auto& site : lock.sites)
+        {
+            const auto label = "  " + std::string(site.file) + ":" + std::to_string(site.line);
+            write_row(label.c_str(), site);
+        }
+    }
+
+    file << "Dropped events: " << result.dropped << "\n";
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,374 @@
+#include <parallel.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace retro::parallel;
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    // A participant's remainder for schedule::stealing: begin in the low half, end in the high half, both
+    // relative to the loop's first index. The whole state is in the one word, so the owner taking from the
+    // front and thieves taking from the back only ever race on a single CAS
+    struct alignas(64) stealing_range
+    {
+        std::atomic<uint64_t> bounds { 0 };
+    };
+
+    constexpr uint64_t pack(uint64_t begin, uint64_t end)
+    {
+        return (end << 32) | begin;
+    }
+
+    constexpr size_t begin_of(uint64_t bounds)
+    {
+        return static_cast<size_t>(bounds & 0xFFFFFFFFULL);
+    }
+
+    constexpr size_t end_of(uint64_t bounds)
+    {
+        return static_cast<size_t>(bounds >> 32);
+    }
+
+    // Everything only hands out indices, all orderings are relaxed: the body's results are published by the
+    // pool handles the caller waits on
+    struct loop_state
+    {
+        size_t first = 0;
+        size_t count = 0;
+        size_t chunk = 0;
+        size_t participants = 0;
+        schedule kind = schedule::static_chunks;
+
+        void * pBody = nullptr;
+        detail::range_invoker invoke = nullptr;
+
+        alignas(64) std::atomic<size_t> next { 0 };
+
+        std::unique_ptr<stealing_range[]> ranges;
+
+        std::atomic<bool> has_failed { false };
+        std::exception_ptr exception { nullptr };
+
+        std::vector<participant_stats> stats;
+    };
+
+    size_t default_chunk(schedule kind, size_t count, size_t participants)
+    {
+        switch (kind)
+        {
+            case schedule::stealing:
+                // Small enough that a thief finds something left, large enough that the owner's CAS per chunk
+                // does not show
+                return std::max<size_t>(1, count / (participants * 64));
+
+            case schedule::static_chunks:
+                // Zero means one block per participant
+                return 0;
+
+            default:
+                return 1;
+        }
+    }
+
+    bool take_front(stealing_range& range, size_t chunk, size_t& begin, size_t& end)
+    {
+        auto bounds = range.bounds.load(std::memory_order_relaxed);
+
+        while (begin_of(bounds) < end_of(bounds))
+        {
+            const auto size = std::min(chunk, end_of(bounds) - begin_of(bounds));
+
+            if (range.bounds.compare_exchange_weak(bounds, pack(begin_of(bounds) + size, end_of(bounds)), std::memory_order_relaxed))
+            {
+                begin = begin_of(bounds);
+                end = begin + size;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Takes the back half, rounded up, so a single remaining iteration can be stolen as well: the owner may be
+    // a job that has not even started yet
+    bool steal_back(stealing_range& victim, size_t& begin, size_t& end)
+    {
+        auto bounds = victim.bounds.load(std::memory_order_relaxed);
+
+        while (begin_of(bounds) < end_of(bounds))
+        {
+            const auto middle = begin_of(bounds) + (end_of(bounds) - begin_of(bounds)) / 2;
+
+            if (victim.bounds.compare_exchange_weak(bounds, pack(begin_of(bounds), middle), std::memory_order_relaxed))
+            {
+                begin = middle;
+                end = end_of(bounds);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void participate(loop_state& state, size_t index)
+    {
+        const auto start = clock::now();
+
+        participant_stats stats;
+
+        auto run_chunk = [&](size_t begin, size_t end)
+        {
+            if (state.has_failed.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+
+            try
+            {
+                state.invoke(state.pBody, state.first + begin, state.first + end);
+            }
+            catch (...)
+            {
+                if (!state.has_failed.exchange(true))
+                {
+                    state.exception = std::current_exception();
+                }
+
+                return false;
+            }
+
+            stats.iterations += end - begin;
+            stats.chunks++;
+
+            retro::thread::pool::preemption_point();
+
+            return true;
+        };
+
+        const auto count = state.count;
+        const auto chunk = state.chunk;
+        const auto participants = state.participants;
+
+        switch (state.kind)
+        {
+            case schedule::static_chunks:
+            {
+                if (chunk == 0)
+                {
+                    const auto base = count / participants;
+                    const auto extra = count % participants;
+
+                    const auto begin = index * base + std::min(index, extra);
+                    run_chunk(begin, begin + base + (index < extra ? 1 : 0));
+                }
+                else
+                {
+                    for (size_t begin = index * chunk; begin < count; begin += participants * chunk)
+                    {
+                        if (!run_chunk(begin, std::min(begin + chunk, count)))
+                        {
+                            break;
+                        }
+                    }
+                }
+
+                break;
+            }
+
+            case schedule::dynamic:
+            {
+                while (true)
+                {
+                    const auto begin = state.next.fetch_add(chunk, std::memory_order_relaxed);
+
+                    if (begin >= count || !run_chunk(begin, std::min(begin + chunk, count)))
+                    {
+                        break;
+                    }
+                }
+
+                break;
+            }
+
+            case schedule::guided:
+            {
+                auto begin = state.next.load(std::memory_order_relaxed);
+
+                while (begin < count)
+                {
+                    const auto remaining = count - begin;
+                    const auto size = std::min(remaining, std::max(chunk, remaining / (2 * participants)));
+
+                    if (!state.next.compare_exchange_weak(begin, begin + size, std::memory_order_relaxed))
+                    {
+                        continue;
+                    }
+
+                    if (!run_chunk(begin, begin + size))
+                    {
+                        break;
+                    }
+
+                    begin = state.next.load(std::memory_order_relaxed);
+                }
+
+                break;
+            }
+
+            case schedule::stealing:
+            {
+                auto& own = state.ranges[index];
+
+                size_t begin = 0;
+                size_t end = 0;
+
+                while (true)
+                {
+                    if (take_front(own, chunk, begin, end))
+                    {
+                        if (!run_chunk(begin, end))
+                        {
+                            break;
+                        }
+
+                        continue;
+                    }
+
+                    // Nothing left anywhere means every remaining iteration is already being run by someone
+                    bool has_stolen = false;
+
+                    for (size_t i = 1; i < participants && !has_stolen; i++)
+                    {
+                        has_stolen = steal_back(state.ranges[(index + i) % participants], begin, end);
+                    }
+
+                    if (!has_stolen)
+                    {
+                        break;
+                    }
+
+                    // Only thieves write a non-empty range and ours is empty, so a plain store loses no update
+                    own.bounds.store(pack(begin, end), std::memory_order_relaxed);
+                }
+
+                break;
+            }
+        }
+
+        stats.busy_seconds = std::chrono::duration<double>(clock::now() - start).count();
+        state.stats.at(index) = stats;
+    }
+}
+
+double loop_stats::imbalance() const
+{
+    if (participants.empty())
+    {
+        return 1.0;
+    }
+
+    const auto longest = std::max_element(participants.begin(), participants.end(),
+                                          [](const auto& lhs, const auto& rhs) { return lhs.busy_seconds < rhs.busy_seconds; });
+
+    const auto total = std::accumulate(participants.begin(), participants.end(), 0.0,
+                                       [](double sum, const auto& entry) { return sum + entry.busy_seconds; });
+
+    const auto mean = total / static_cast<double>(participants.size());
+
+    return mean > 0.0 ? longest->busy_seconds / mean : 1.0;
+}
+
+loop_stats detail::run(size_t first, size_t last, const options& settings, thread::pool& pool, void * pBody, range_invoker invoke)
+{
+    loop_stats result;
+
+    if (last <= first)
+    {
+        return result;
+    }
+
+    const auto start = clock::now();
+
+    const auto level = settings.level.value_or(thread::pool::current_priority());
+
+    // The quota is what the class can run at once. A worker of this pool calling in occupies one of the
+    // workers itself
+    const auto capacity = std::min(pool.size(), pool.get_quota(level)) + (thread::pool::current() == &pool ? 0 : 1);
+
+    loop_state state;
+
+    state.first = first;
+    state.count = last - first;
+    state.kind = settings.kind;
+    state.pBody = pBody;
+    state.invoke = invoke;
+
+    state.participants = std::min(settings.threads == 0 ? capacity : std::min(settings.threads, capacity), state.count);
+    state.chunk = settings.chunk != 0 ? settings.chunk : default_chunk(state.kind, state.count, state.participants);
+
+    state.stats.resize(state.participants);
+
+    if (state.kind == schedule::stealing)
+    {
+        if (state.count > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::runtime_error("Error: Work stealing schedule is limited to 2^32 iterations per loop");
+        }
+
+        state.ranges = std::make_unique<stealing_range[]>(state.participants);
+
+        const auto base = state.count / state.participants;
+        const auto extra = state.count % state.participants;
+
+        for (size_t i = 0; i < state.participants; i++)
+        {
+            const auto begin = i * base + std::min(i, extra);
+            state.ranges[i].bounds.store(pack(begin, begin + base + (i < extra ? 1 : 0)), std::memory_order_relaxed);
+        }
+    }
+
+    std::vector<thread::pool::handle> handles;
+    handles.reserve(state.participants - 1);
+
+    for (size_t index = 1; index < state.participants; index++)
+    {
+        try
+        {
+            handles.push_back(pool.submit(level, [&state, index]() { participate(state, index); }));
+        }
+        catch (...)
+        {
+            // The jobs already submitted reference the state, they still have to be waited for
+            if (!state.has_failed.exchange(true))
+            {
+                state.exception = std::current_exception();
+            }
+
+            break;
+        }
+    }
+
+    participate(state, 0);
+
+    for (const auto& handle : handles)
+    {
+        handle.wait();
+    }
+
+    if (state.has_failed.load())
+    {
+        std::rethrow_exception(state.exception);
+    }
+
+    result.participants = std::move(state.stats);
+    result.wall_seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    return result;
+}
@@ -0,0 +1,372 @@
+#include <pool.hpp>
+#include <trace.hpp>
+
+#include <thread>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace retro::thread;
+
+pool::handle::handle(std::shared_ptr<job> job)
+    : m_job(std::move(job))
+{
+}
+
+void pool::handle::wait() const
+{
+    if (!m_job)
+    {
+        throw std::runtime_error("Error: No job to wait for");
+    }
+
+    if (m_current_pool != nullptr)
+    {
+        while (!m_job->is_done.load(std::memory_order_acquire))
+        {
+            if (!m_current_pool->try_run_pending())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+    else
+    {
+        m_job->is_done.wait(false, std::memory_order_acquire);
+    }
+
+    if (m_job->exception)
+    {
+        std::rethrow_exception(m_job->exception);
+    }
+}
+
+bool pool::handle::is_done() const
+{
+    return m_job && m_job->is_done.load(std::memory_order_acquire);
+}
+
+bool pool::handle::is_valid() const
+{
+    return m_job != nullptr;
+}
+
+pool::pool(size_t workers_count)
+{
+    if (workers_count == 0)
+    {
+        workers_count = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    for (auto& entry : m_classes)
+    {
+        entry.quota.store(workers_count, std::memory_order_relaxed);
+    }
+
+    m_workers.reserve(workers_count);
+
+    for (size_t i = 0; i < workers_count; i++)
+    {
+        m_workers.emplace_back(std::make_unique<worker>());
+    }
+
+    // Only start the threads once every deque exists, they start stealing right away
+    for (size_t i = 0; i < workers_count; i++)
+    {
+        m_workers.at(i)->thread.run([this, i]() { worker_loop(i); });
+    }
+}
+
+pool::~pool()
+{
+    m_is_stopping.store(true);
+
+    m_wake_epoch.fetch_add(1, std::memory_order_release);
+    m_wake_epoch.notify_all();
+
+    for (auto& pWorker : m_workers)
+    {
+        pWorker->thread.join();
+    }
+}
+
+bool pool::try_run_pending()
+{
+    auto * pJob = find_job(m_current_pool == this ? m_current_index : no_worker);
+
+    if (pJob == nullptr)
+    {
+        return false;
+    }
+
+    run_job(pJob);
+    return true;
+}
+
+size_t pool::size() const
+{
+    return m_workers.size();
+}
+
+void pool::pin(pin_policy policy)
+{
+    const auto& cpus = topology::current();
+
+    for (size_t i = 0; i < m_workers.size(); i++)
+    {
+        m_workers.at(i)->thread.set_affinity(cpus.cpu_for(policy, static_cast<uint32_t>(i)));
+    }
+}
+
+void pool::set_quota(job_priority level, size_t max_workers)
+{
+    class_of(level).quota.store(std::clamp<size_t>(max_workers, 1, m_workers.size()), std::memory_order_relaxed);
+
+    // Jobs that were held back may fit now, and the workers that skipped them might all be parked
+    m_wake_epoch.fetch_add(1, std::memory_order_release);
+    m_wake_epoch.notify_all();
+}
+
+size_t pool::get_quota(job_priority level) const
+{
+    return m_classes.at(static_cast<size_t>(level)).quota.load(std::memory_order_relaxed);
+}
+
+size_t pool::running(job_priority level) const
+{
+    return m_classes.at(static_cast<size_t>(level)).running.load(std::memory_order_relaxed);
+}
+
+void pool::preemption_point()
+{
+    auto * pPool = m_current_pool;
+
+    if (pPool == nullptr || m_current_priority == job_priority::interactive)
+    {
+        return;
+    }
+
+    while (auto * pJob = pPool->take_injected(job_priority::interactive, true))
+    {
+        pPool->run_job(pJob);
+    }
+}
+
+job_priority pool::current_priority()
+{
+    return m_current_priority;
+}
+
+pool& pool::shared()
+{
+    static pool instance;
+    return instance;
+}
+
+pool * pool::current()
+{
+    return m_current_pool;
+}
+
+pool::handle pool::enqueue(std::shared_ptr<job> new_job)
+{
+    auto * pJob = new_job.get();
+    pJob->self = new_job;
+
+    if (m_current_pool == this && pJob->level == job_priority::normal)
+    {
+        m_workers.at(m_current_index)->deque.push(pJob);
+    }
+    else if (m_current_pool == this)
+    {
+        // Parking here could hang the pool once every worker fans out past the capacity: run jobs instead,
+        // the same way wait() does, until the queue has room
+        auto& injection = class_of(pJob->level).injection;
+
+        while (!injection.try_push(pJob))
+        {
+            if (!try_run_pending())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+    else
+    {
+        class_of(pJob->level).injection.push(pJob);
+    }
+
+    // Pairs with the fence in worker_loop: either the parking worker sees the job, or we see it parking
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_sleeping.load(std::memory_order_relaxed) > 0)
+    {
+        m_wake_epoch.fetch_add(1, std::memory_order_release);
+        m_wake_epoch.notify_one();
+    }
+
+    return handle(std::move(new_job));
+}
+
+pool::job_class& pool::class_of(job_priority level)
+{
+    return m_classes.at(static_cast<size_t>(level));
+}
+
+pool::job * pool::take_injected(job_priority level, bool is_nested)
+{
+    auto& entry = class_of(level);
+
+    if (entry.injection.empty())
+    {
+        return nullptr;
+    }
+
+    if (is_nested)
+    {
+        auto pJob = entry.injection.try_pop();
+        return pJob ? *pJob : nullptr;
+    }
+
+    // Reserve first and pop second, otherwise two workers could both see room for one more
+    if (entry.running.fetch_add(1, std::memory_order_acquire) < entry.quota.load(std::memory_order_relaxed))
+    {
+        if (auto pJob = entry.injection.try_pop())
+        {
+            (*pJob)->holds_quota = true;
+            return *pJob;
+        }
+    }
+
+    entry.running.fetch_sub(1, std::memory_order_release);
+    return nullptr;
+}
+
+pool::job * pool::find_job(size_t self)
+{
+    const bool is_nested = m_current_depth > 0;
+
+    if (auto * pJob = take_injected(job_priority::interactive, is_nested))
+    {
+        return pJob;
+    }
+
+    if (self != no_worker)
+    {
+        if (auto pJob = m_workers.at(self)->deque.pop())
+        {
+            return *pJob;
+        }
+    }
+
+    if (auto * pJob = take_injected(job_priority::normal, is_nested))
+    {
+        return pJob;
+    }
+
+    const auto count = m_workers.size();
+    const auto start = self == no_worker ? 0 : self + 1;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto victim = (start + i) % count;
+
+        if (victim == self)
+        {
+            continue;
+        }
+
+        if (auto pJob = m_workers.at(victim)->deque.steal())
+        {
+            return *pJob;
+        }
+    }
+
+    return take_injected(job_priority::background, is_nested);
+}
+
+void pool::run_job(job * pJob)
+{
+    auto owner = std::move(pJob->self);
+
+    const auto previous_priority = std::exchange(m_current_priority, pJob->level);
+    m_current_depth++;
+
+    try
+    {
+        trace::zone _("Pool job");
+        pJob->invoke();
+    }
+    catch (...)
+    {
+        pJob->exception = std::current_exception();
+    }
+
+    m_current_depth--;
+    m_current_priority = previous_priority;
+
+    // Handles may outlive the job by far, whatever the callable captured is released right away
+    pJob->invoke.reset();
+
+    if (pJob->holds_quota)
+    {
+        auto& entry = class_of(pJob->level);
+        entry.running.fetch_sub(1, std::memory_order_release);
+
+        // A worker that skipped the class for lack of room may have parked since. Pairs with the fence in
+        // worker_loop like enqueue does
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!entry.injection.empty() && m_sleeping.load(std::memory_order_relaxed) > 0)
+        {
+            m_wake_epoch.fetch_add(1, std::memory_order_release);
+            m_wake_epoch.notify_one();
+        }
+    }
+
+    pJob->is_done.store(true, std::memory_order_release);
+    pJob->is_done.notify_all();
+}
+
+void pool::worker_loop(size_t index)
+{
+    m_current_pool = this;
+    m_current_index = index;
+
+    trace::set_thread_name("Pool worker " + std::to_string(index));
+
+    while (true)
+    {
+        auto * pJob = find_job(index);
+
+        if (pJob == nullptr)
+        {
+            m_sleeping.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            const auto epoch = m_wake_epoch.load(std::memory_order_acquire);
+            pJob = find_job(index);
+
+            if (pJob == nullptr)
+            {
+                if (m_is_stopping.load())
+                {
+                    m_sleeping.fetch_sub(1);
+                    break;
+                }
+
+                m_wake_epoch.wait(epoch, std::memory_order_acquire);
+            }
+
+            m_sleeping.fetch_sub(1);
+        }
+
+        if (pJob != nullptr)
+        {
+            run_job(pJob);
+        }
+    }
+
+    m_current_pool = nullptr;
+    m_current_index = no_worker;
+}
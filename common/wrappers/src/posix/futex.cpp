@@ -0,0 +1,82 @@
+#include <futex.hpp>
+
+#include <ctime>
+#include <cerrno>
+#include <thread>
+#include <algorithm>
+
+#if defined(__linux__)
+# include <unistd.h>
+# include <linux/futex.h>
+# include <sys/syscall.h>
+#endif
+
+#include <climits>
+
+namespace
+{
+#if defined(__linux__)
+    long futex(std::atomic<uint32_t>& word, int op, uint32_t value, const timespec * timeout)
+    {
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32 bit integer");
+        return syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), op, value, timeout, nullptr, 0);
+    }
+#endif
+}
+
+void retro::sync::futex_wait(std::atomic<uint32_t>& word, uint32_t expected)
+{
+#if defined(__linux__)
+    futex(word, FUTEX_WAIT_PRIVATE, expected, nullptr);
+#else
+    word.wait(expected, std::memory_order_acquire);
+#endif
+}
+
+bool retro::sync::futex_wait_for(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout)
+{
+#if defined(__linux__)
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+
+    timespec relative { };
+    relative.tv_sec = static_cast<time_t>(seconds.count());
+    relative.tv_nsec = static_cast<long>((timeout - seconds).count());
+
+    return !(futex(word, FUTEX_WAIT_PRIVATE, expected, &relative) == -1 && errno == ETIMEDOUT);
+#else
+    // No timed std::atomic::wait, poll with growing sleeps instead
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto nap = std::chrono::microseconds(1);
+
+    while (word.load(std::memory_order_acquire) == expected)
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+
+        std::this_thread::sleep_for(nap);
+        nap = std::min(nap * 2, std::chrono::microseconds(1000));
+    }
+
+    return true;
+#endif
+}
+
+void retro::sync::futex_wake_one(std::atomic<uint32_t>& word)
+{
+#if defined(__linux__)
+    futex(word, FUTEX_WAKE_PRIVATE, 1, nullptr);
+#else
+    word.notify_one();
+#endif
+}
+
+void retro::sync::futex_wake_all(std::atomic<uint32_t>& word)
+{
+#if defined(__linux__)
+    futex(word, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+#else
+    word.notify_all();
+#endif
+}
@@ -0,0 +1,171 @@
+#include <topology.hpp>
+
+#include <set>
+#include <cctype>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+
+#if defined(__linux__)
+# include <sched.h>
+#endif
+
+using namespace retro::thread;
+
+namespace
+{
+    const std::filesystem::path cpu_root = "/sys/devices/system/cpu";
+    const std::filesystem::path node_root = "/sys/devices/system/node";
+
+    bool read_line(const std::filesystem::path& path, std::string& line)
+    {
+        std::ifstream file(path);
+        return static_cast<bool>(std::getline(file, line));
+    }
+
+    // Kernel cpu list format: "0-3,8,10-11"
+    std::set<uint32_t> parse_cpu_list(const std::string& list)
+    {
+        std::set<uint32_t> ids;
+        std::stringstream stream(list);
+        std::string range;
+
+        while (std::getline(stream, range, ','))
+        {
+            if (range.empty() || !std::isdigit(static_cast<unsigned char>(range.front())))
+            {
+                continue;
+            }
+
+            const auto dash = range.find('-');
+            const auto first = static_cast<uint32_t>(std::stoul(range.substr(0, dash)));
+            const auto last = dash == std::string::npos ? first : static_cast<uint32_t>(std::stoul(range.substr(dash + 1)));
+
+            for (auto id = first; id <= last; id++)
+            {
+                ids.insert(id);
+            }
+        }
+
+        return ids;
+    }
+
+    std::set<uint32_t> read_cpu_list(const std::filesystem::path& path)
+    {
+        std::string line;
+        return read_line(path, line) ? parse_cpu_list(line) : std::set<uint32_t> { };
+    }
+
+    uint32_t read_number(const std::filesystem::path& path, uint32_t fallback)
+    {
+        std::string line;
+
+        if (!read_line(path, line) || line.empty() || !std::isdigit(static_cast<unsigned char>(line.front())))
+        {
+            return fallback;
+        }
+
+        return static_cast<uint32_t>(std::stoul(line));
+    }
+
+    // Online CPUs this process is allowed to run on
+    std::set<uint32_t> allowed_cpus()
+    {
+        auto online = read_cpu_list(cpu_root / "online");
+
+#if defined(__linux__)
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+
+        if (sched_getaffinity(0, sizeof(mask), &mask) == 0)
+        {
+            std::erase_if(online, [&](uint32_t id) { return id >= CPU_SETSIZE || !CPU_ISSET(id, &mask); });
+        }
+#endif
+
+        if (online.empty())
+        {
+            for (uint32_t id = 0; id < std::max(std::thread::hardware_concurrency(), 1U); id++)
+            {
+                online.insert(id);
+            }
+        }
+
+        return online;
+    }
+
+    // Key of the highest level cache the CPU shares: the lowest CPU id sharing it
+    uint32_t last_level_cache_key(uint32_t id)
+    {
+        std::error_code error;
+        const auto cache_root = cpu_root / ("cpu" + std::to_string(id)) / "cache";
+
+        uint32_t best_level = 0;
+        uint32_t key = id;
+
+        for (const auto& index : std::filesystem::directory_iterator(cache_root, error))
+        {
+            const auto level = read_number(index.path() / "level", 0);
+            const auto shared = read_cpu_list(index.path() / "shared_cpu_list");
+
+            if (level > best_level && !shared.empty())
+            {
+                best_level = level;
+                key = *shared.begin();
+            }
+        }
+
+        return key;
+    }
+}
+
+topology topology::detect()
+{
+    topology result;
+
+    const auto allowed = allowed_cpus();
+
+    for (const auto id : allowed)
+    {
+        const auto cpu_path = cpu_root / ("cpu" + std::to_string(id)) / "topology";
+
+        logical_cpu cpu;
+        cpu.id = id;
+
+        // The lowest sibling id is unique per core across packages, core_id alone is not
+        const auto siblings = read_cpu_list(cpu_path / "thread_siblings_list");
+        cpu.core = siblings.empty() ? id : *siblings.begin();
+        cpu.package = read_number(cpu_path / "physical_package_id", 0);
+        cpu.llc = last_level_cache_key(id);
+
+        result.m_cpus.push_back(cpu);
+    }
+
+    std::error_code error;
+
+    for (const auto& node : std::filesystem::directory_iterator(node_root, error))
+    {
+        const auto name = node.path().filename().string();
+
+        if (name.rfind("node", 0) != 0 || name.size() == 4 || !std::isdigit(static_cast<unsigned char>(name[4])))
+        {
+            continue;
+        }
+
+        const auto node_id = static_cast<uint32_t>(std::stoul(name.substr(4)));
+        const auto node_cpus = read_cpu_list(node.path() / "cpulist");
+
+        for (auto& cpu : result.m_cpus)
+        {
+            if (node_cpus.count(cpu.id) != 0)
+            {
+                cpu.numa_node = node_id;
+            }
+        }
+    }
+
+    result.normalize();
+    return result;
+}
@@ -0,0 +1,84 @@
+#include <winmutex.hpp>
+
+#include <cerrno>
+
+using namespace retro::mutex;
+
+winmutex::winmutex()
+{
+    pthread_mutexattr_t attributes;
+
+    if (pthread_mutexattr_init(&attributes) != 0)
+    {
+        throw std::runtime_error("Failed to create mutex");
+    }
+
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    const auto result = pthread_mutex_init(&m_mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+
+    if (result != 0)
+    {
+        throw std::runtime_error("Failed to create mutex");
+    }
+}
+
+winmutex::~winmutex()
+{
+    pthread_mutex_destroy(&m_mutex);
+}
+
+#if defined(RETRO_LOCK_PROFILING)
+void winmutex::lock(std::source_location site)
+{
+    const auto started = profiling::clock::now();
+    const bool is_contended = !try_lock_native();
+
+    if (is_contended)
+    {
+        lock_native();
+    }
+
+    m_probe.acquired(started, is_contended, site);
+}
+
+bool winmutex::try_lock_native()
+{
+    return pthread_mutex_trylock(&m_mutex) == 0;
+}
+#else
+void winmutex::lock()
+{
+    lock_native();
+}
+#endif
+
+void winmutex::lock_native()
+{
+    const auto result = pthread_mutex_lock(&m_mutex);
+
+    if (result != 0)
+    {
+        switch (result)
+        {
+            case EDEADLK:
+                throw std::runtime_error("Mutex lock failed, check for deadlocks");
+            case EAGAIN:
+                throw std::runtime_error("Mutex lock failed, recursion limit exceeded");
+            default:
+                throw std::runtime_error("Mutex wait for unknown reasons");
+        }
+    }
+}
+
+void winmutex::unlock()
+{
+#if defined(RETRO_LOCK_PROFILING)
+    m_probe.released(this);
+#endif
+
+    if (pthread_mutex_unlock(&m_mutex) != 0)
+    {
+        throw std::runtime_error("Failed to unlock mutex");
+    }
+}
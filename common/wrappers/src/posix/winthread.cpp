@@ -0,0 +1,332 @@
+#include <winthread.hpp>
+#include <futex.hpp>
+#include <topology.hpp>
+
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#if defined(__linux__)
+# include <sys/syscall.h>
+#endif
+
+#include <stdexcept>
+
+using namespace retro::thread;
+
+namespace
+{
+    struct native_priority
+    {
+        int policy;
+        int nice;
+    };
+
+    // Linux keeps a nice value per thread, so the priority classes map onto nice levels, with the lowest one
+    // additionally marked as SCHED_BATCH. Raising above normal requires CAP_SYS_NICE (or a suitable RLIMIT_NICE)
+    native_priority get_native_priority(priority e_priority)
+    {
+        switch (e_priority)
+        {
+            case priority::low:
+#if defined(SCHED_BATCH)
+                return { SCHED_BATCH, 10 };
+#else
+                return { SCHED_OTHER, 10 };
+#endif
+
+            case priority::below_normal:
+                return { SCHED_OTHER, 5 };
+
+            case priority::normal:
+                return { SCHED_OTHER, 0 };
+
+            case priority::above_normal:
+                return { SCHED_OTHER, -5 };
+
+            case priority::high:
+                return { SCHED_OTHER, -10 };
+        }
+
+        return { SCHED_OTHER, -10 };
+    }
+
+    bool apply_native_priority(pthread_t thread, pid_t native_id, priority e_priority)
+    {
+        const auto native = get_native_priority(e_priority);
+
+#if defined(__linux__)
+        sched_param param { };
+        param.sched_priority = 0;
+
+        if (pthread_setschedparam(thread, native.policy, &param) != 0)
+        {
+            return false;
+        }
+
+        return native_id == 0 || setpriority(PRIO_PROCESS, static_cast<id_t>(native_id), native.nice) == 0;
+#else
+        // No per-thread nice outside of Linux: spread the classes over the SCHED_OTHER priority range instead
+        const auto min = sched_get_priority_min(SCHED_OTHER);
+        const auto max = sched_get_priority_max(SCHED_OTHER);
+
+        sched_param param { };
+        param.sched_priority = min + (max - min) * (10 - native.nice) / 20;
+
+        return pthread_setschedparam(thread, SCHED_OTHER, &param) == 0;
+#endif
+    }
+
+    bool apply_native_affinity(pthread_t thread, int32_t cpu)
+    {
+#if defined(__linux__)
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+
+        if (cpu >= 0)
+        {
+            if (cpu >= CPU_SETSIZE)
+            {
+                return false;
+            }
+
+            CPU_SET(cpu, &mask);
+        }
+        else
+        {
+            // Unbinding means every CPU the process was allowed on at startup
+            for (const auto& allowed : topology::current().cpus())
+            {
+                if (allowed.id < CPU_SETSIZE)
+                {
+                    CPU_SET(allowed.id, &mask);
+                }
+            }
+        }
+
+        return pthread_setaffinity_np(thread, sizeof(mask), &mask) == 0;
+#else
+        // No way to bind a thread to a CPU (macOS only offers affinity tags as hints)
+        (void)thread;
+        return cpu < 0;
+#endif
+    }
+
+    pid_t get_native_id()
+    {
+#if defined(__linux__)
+        return static_cast<pid_t>(syscall(SYS_gettid));
+#else
+        return 0;
+#endif
+    }
+}
+
+winthread& winthread::operator=(winthread&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (m_context && m_context->is_joinable)
+        {
+            pthread_join(m_context->thread, nullptr);
+        }
+
+        m_context = std::move(other.m_context);
+    }
+
+    return *this;
+}
+
+winthread::~winthread()
+{
+    if (!m_context)
+    {
+        return;
+    }
+
+    if (m_context->is_joinable)
+    {
+        m_context->exchange_state(state::paused, state::running);
+        join();
+    }
+}
+
+void winthread::run()
+{
+    if (m_context->invoke)
+    {
+        if (m_context->is_joinable)
+        {
+            join();
+        }
+
+        m_context->start_ticks.store(0, std::memory_order_relaxed);
+        m_context->finish_ticks.store(0, std::memory_order_relaxed);
+        m_context->stop = std::stop_source();
+        m_context->store_state(state::running);
+
+        if (pthread_create(&m_context->thread, nullptr, thread_function, m_context.get()) != 0)
+        {
+            m_context->store_state(state::idle);
+            throw std::runtime_error("Error: the thread could not be created");
+        }
+
+        m_context->is_joinable = true;
+    }
+    else
+    {
+        throw std::runtime_error("Error: Runnable not assigned");
+    }
+}
+
+void winthread::join()
+{
+    if (!m_context->is_joinable)
+    {
+        throw std::runtime_error("Error: No thread to join");
+    }
+
+    // Same as on Windows: joining a paused thread would never return
+    if (m_context->load_state() != state::paused)
+    {
+        pthread_join(m_context->thread, nullptr);
+
+        m_context->is_joinable = false;
+        m_context->native_id = 0;
+    }
+}
+
+void winthread::pause()
+{
+    if (!m_context->exchange_state(state::running, state::paused) && !is_paused())
+    {
+        throw std::runtime_error("Error: No running thread to pause");
+    }
+}
+
+void winthread::resume()
+{
+    if (!m_context->exchange_state(state::paused, state::running) && !is_running())
+    {
+        throw std::runtime_error("Error: No running thread to resume");
+    }
+}
+
+void winthread::terminate()
+{
+    if (is_running())
+    {
+        // Deferred cancellation: the worker unwinds at its next safe point or blocking call, so a paused
+        // worker has to be woken up first to get there
+        pthread_cancel(m_context->thread);
+        m_context->exchange_state(state::paused, state::running);
+
+        pthread_join(m_context->thread, nullptr);
+
+        m_context->is_joinable = false;
+        m_context->native_id = 0;
+
+        if (!is_finished())
+        {
+            m_context->stamp(m_context->finish_ticks);
+            m_context->store_state(state::finished);
+        }
+    }
+    else
+    {
+        throw std::runtime_error("Error: No running thread to stop");
+    }
+}
+
+priority winthread::get_priority()
+{
+    return m_context->current_priority;
+}
+
+void winthread::set_priority(priority priority)
+{
+    m_context->current_priority = priority;
+
+    if (!is_running() || !m_context->is_joinable)
+    {
+        return;
+    }
+
+    if (!apply_native_priority(m_context->thread, m_context->native_id, priority))
+    {
+        throw std::runtime_error("Error: Failed to set thread priority");
+    }
+}
+
+void winthread::set_affinity(int32_t cpu)
+{
+    m_context->affinity = cpu;
+
+    if (!is_running() || !m_context->is_joinable)
+    {
+        return;
+    }
+
+    if (!apply_native_affinity(m_context->thread, cpu))
+    {
+        throw std::runtime_error("Error: Failed to set thread affinity");
+    }
+}
+
+int32_t winthread::get_affinity() const
+{
+    return m_context->affinity;
+}
+
+void winthread::safe_point()
+{
+    auto * pContext = m_current_context;
+
+    if (pContext == nullptr)
+    {
+        return;
+    }
+
+    // Neither futex(2) nor the atomic wait fallback are cancellation points, so there is nothing to unwind
+    // while parked; a pending cancellation is delivered right after
+    constexpr auto paused = static_cast<uint32_t>(state::paused);
+
+    while (pContext->status.load(std::memory_order_acquire) == paused)
+    {
+        sync::futex_wait(pContext->status, paused);
+    }
+
+    pthread_testcancel();
+}
+
+void * winthread::thread_function(void * param)
+{
+    auto * pContext = static_cast<context *>(param);
+
+    m_current_context = pContext;
+    pContext->native_id = get_native_id();
+
+    if (pContext->current_priority != priority::normal)
+    {
+        apply_native_priority(pthread_self(), pContext->native_id, pContext->current_priority);
+    }
+
+    if (pContext->affinity >= 0)
+    {
+        apply_native_affinity(pthread_self(), pContext->affinity);
+    }
+
+    pContext->stamp(pContext->start_ticks);
+
+    pContext->invoke();
+
+    // A pause that never reached a safe point is simply dropped
+    pContext->stamp(pContext->finish_ticks);
+    pContext->store_state(state::finished);
+    return nullptr;
+}
+
+bool retro::thread::pin_current_thread(int32_t cpu)
+{
+    return apply_native_affinity(pthread_self(), cpu);
+}
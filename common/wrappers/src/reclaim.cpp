@@ -0,0 +1,521 @@
+#include <reclaim.hpp>
+
+#include <cpu.hpp>
+
+#include <mutex>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+using namespace retro::concurrent;
+
+namespace
+{
+    struct retired_object
+    {
+        void * pObject = nullptr;
+        reclaim_deleter deleter = nullptr;
+
+        // Global epoch when it was retired, unused by hazard pointers
+        uint64_t epoch = 0;
+    };
+
+    // What the thread_local bindings need from a domain: hand an exiting thread's record back, and tell
+    // whether the domain is gone so stale bindings can be dropped
+    struct domain_state
+        : std::enable_shared_from_this<domain_state>
+    {
+        virtual ~domain_state() = default;
+
+        virtual void release(void * pRecord) = 0;
+
+        std::atomic<bool> is_closed { false };
+    };
+
+    // The records a thread holds, one per domain it used. Destroyed on thread exit, which gives every record
+    // back. Holding the state keeps a destroyed domain's records alive until the last thread that used it exits
+    class thread_bindings
+    {
+    public:
+
+        ~thread_bindings()
+        {
+            for (auto& [pState, pRecord] : m_bindings)
+            {
+                pState->release(pRecord);
+            }
+        }
+
+        [[nodiscard]] void * find(const domain_state * pState) const
+        {
+            for (const auto& [pBound, pRecord] : m_bindings)
+            {
+                if (pBound.get() == pState)
+                {
+                    return pRecord;
+                }
+            }
+
+            return nullptr;
+        }
+
+        void add(std::shared_ptr<domain_state> pState, void * pRecord)
+        {
+            // Only ever grows by one per domain and thread, the slow path is a good time to forget dead domains
+            std::erase_if(m_bindings, [](const auto& binding) { return binding.first->is_closed.load(std::memory_order_relaxed); });
+            m_bindings.emplace_back(std::move(pState), pRecord);
+        }
+
+    private:
+
+        std::vector<std::pair<std::shared_ptr<domain_state>, void *>> m_bindings;
+
+    };
+
+    thread_local thread_bindings bindings;
+
+    void free_all(std::vector<retired_object>& retired)
+    {
+        for (const auto& entry : retired)
+        {
+            entry.deleter(entry.pObject);
+        }
+
+        retired.clear();
+    }
+
+    // Frees the entries the predicate lets go and keeps the others, returns how many were freed
+    template<typename Predicate>
+    size_t free_if(std::vector<retired_object>& retired, Predicate&& is_safe)
+    {
+        const auto kept = std::partition(retired.begin(), retired.end(), [&](const auto& entry) { return !is_safe(entry); });
+        const auto freed = static_cast<size_t>(std::distance(kept, retired.end()));
+
+        for (auto it = kept; it != retired.end(); ++it)
+        {
+            it->deleter(it->pObject);
+        }
+
+        retired.erase(kept, retired.end());
+        return freed;
+    }
+
+    struct alignas(retro::sync::cache_line_size) epoch_record
+    {
+        // Epoch << 1, the low bit set while the owner is inside a guard
+        std::atomic<uint64_t> announced { 0 };
+        std::atomic<bool> in_use { true };
+
+        // Records are never unlinked, only recycled, so the list can be walked without a lock
+        epoch_record * pNext = nullptr;
+
+        const std::atomic<uint64_t> * pGlobal = nullptr;
+
+        // Owner only
+        uint32_t depth = 0;
+        std::vector<retired_object> retired;
+    };
+
+    struct alignas(retro::sync::cache_line_size) hazard_slot
+    {
+        std::atomic<void *> pointer { nullptr };
+        std::atomic<bool> in_use { true };
+
+        hazard_slot * pNext = nullptr;
+    };
+
+    struct hazard_record
+    {
+        bool in_use = true;
+
+        std::vector<retired_object> retired;
+    };
+}
+
+struct epoch_domain::state
+    : domain_state
+{
+    alignas(sync::cache_line_size) std::atomic<uint64_t> global_epoch { 0 };
+
+    std::atomic<epoch_record *> records { nullptr };
+    std::atomic<size_t> pending { 0 };
+
+    std::mutex sync;
+    std::vector<retired_object> orphans;
+
+    ~state() override
+    {
+        close();
+
+        auto * pRecord = records.load();
+        while (pRecord != nullptr)
+        {
+            delete std::exchange(pRecord, pRecord->pNext);
+        }
+    }
+
+    void close()
+    {
+        std::lock_guard lock(sync);
+
+        for (auto * pRecord = records.load(); pRecord != nullptr; pRecord = pRecord->pNext)
+        {
+            free_all(pRecord->retired);
+        }
+
+        free_all(orphans);
+        pending.store(0);
+    }
+
+    void release(void * pRecord) override
+    {
+        auto& record = *static_cast<epoch_record *>(pRecord);
+
+        {
+            std::lock_guard lock(sync);
+
+            orphans.insert(orphans.end(), record.retired.begin(), record.retired.end());
+            record.retired.clear();
+        }
+
+        record.depth = 0;
+
+        record.announced.store(0, std::memory_order_release);
+        record.in_use.store(false, std::memory_order_release);
+    }
+
+    epoch_record& local()
+    {
+        if (auto * pRecord = bindings.find(this))
+        {
+            return *static_cast<epoch_record *>(pRecord);
+        }
+
+        auto * pRecord = acquire_record();
+        bindings.add(shared_from_this(), pRecord);
+
+        return *pRecord;
+    }
+
+    epoch_record * acquire_record()
+    {
+        for (auto * pRecord = records.load(std::memory_order_acquire); pRecord != nullptr; pRecord = pRecord->pNext)
+        {
+            bool is_used = false;
+            if (!pRecord->in_use.load(std::memory_order_relaxed) && pRecord->in_use.compare_exchange_strong(is_used, true, std::memory_order_acquire))
+            {
+                return pRecord;
+            }
+        }
+
+        auto * pRecord = new epoch_record();
+        pRecord->pGlobal = &global_epoch;
+        pRecord->pNext = records.load(std::memory_order_relaxed);
+
+        while (!records.compare_exchange_weak(pRecord->pNext, pRecord, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+
+        return pRecord;
+    }
+
+    // The epoch may only move on once every thread inside a guard has announced the current one
+    void try_advance()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        auto current = global_epoch.load(std::memory_order_seq_cst);
+
+        for (auto * pRecord = records.load(std::memory_order_acquire); pRecord != nullptr; pRecord = pRecord->pNext)
+        {
+            const auto announced = pRecord->announced.load(std::memory_order_seq_cst);
+
+            if ((announced & 1) != 0 && (announced >> 1) != current)
+            {
+                return;
+            }
+        }
+
+        global_epoch.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst);
+    }
+
+    size_t free_safe(std::vector<retired_object>& retired)
+    {
+        const auto current = global_epoch.load(std::memory_order_seq_cst);
+        const auto freed = free_if(retired, [current](const auto& entry) { return entry.epoch + 2 <= current; });
+
+        pending.fetch_sub(freed, std::memory_order_relaxed);
+        return freed;
+    }
+};
+
+epoch_domain::epoch_domain()
+    : m_state(std::make_shared<state>())
+{
+}
+
+epoch_domain::~epoch_domain()
+{
+    m_state->close();
+    m_state->is_closed.store(true);
+}
+
+void epoch_domain::retire(void * pObject, reclaim_deleter deleter)
+{
+    auto& record = m_state->local();
+
+    record.retired.push_back({ pObject, deleter, m_state->global_epoch.load(std::memory_order_seq_cst) });
+    m_state->pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (record.retired.size() >= batch_size)
+    {
+        collect();
+    }
+}
+
+void epoch_domain::collect()
+{
+    m_state->try_advance();
+    m_state->free_safe(m_state->local().retired);
+
+    std::unique_lock lock(m_state->sync, std::try_to_lock);
+
+    if (lock.owns_lock())
+    {
+        m_state->free_safe(m_state->orphans);
+    }
+}
+
+size_t epoch_domain::pending() const
+{
+    return m_state->pending.load(std::memory_order_relaxed);
+}
+
+uint64_t epoch_domain::epoch() const
+{
+    return m_state->global_epoch.load(std::memory_order_relaxed);
+}
+
+epoch_domain& epoch_domain::shared()
+{
+    static epoch_domain instance;
+    return instance;
+}
+
+epoch_guard::epoch_guard(epoch_domain& domain)
+    : m_record(&domain.m_state->local())
+{
+    auto& record = *static_cast<epoch_record *>(m_record);
+
+    if (record.depth++ == 0)
+    {
+        // A stale epoch is fine: it only holds the next advance back until this guard is gone
+        record.announced.store((record.pGlobal->load(std::memory_order_relaxed) << 1) | 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+epoch_guard::~epoch_guard()
+{
+    auto& record = *static_cast<epoch_record *>(m_record);
+
+    if (--record.depth == 0)
+    {
+        record.announced.store(0, std::memory_order_release);
+    }
+}
+
+struct hazard_domain::state
+    : domain_state
+{
+    std::atomic<hazard_slot *> slots { nullptr };
+    std::atomic<size_t> slots_count { 0 };
+
+    std::atomic<size_t> pending { 0 };
+
+    std::mutex sync;
+    std::vector<retired_object> orphans;
+    std::vector<std::unique_ptr<hazard_record>> records;
+
+    ~state() override
+    {
+        close();
+
+        auto * pSlot = slots.load();
+        while (pSlot != nullptr)
+        {
+            delete std::exchange(pSlot, pSlot->pNext);
+        }
+    }
+
+    void close()
+    {
+        std::lock_guard lock(sync);
+
+        for (auto& pRecord : records)
+        {
+            free_all(pRecord->retired);
+        }
+
+        free_all(orphans);
+        pending.store(0);
+    }
+
+    void release(void * pRecord) override
+    {
+        auto& record = *static_cast<hazard_record *>(pRecord);
+
+        std::lock_guard lock(sync);
+
+        orphans.insert(orphans.end(), record.retired.begin(), record.retired.end());
+        record.retired.clear();
+        record.in_use = false;
+    }
+
+    hazard_record& local()
+    {
+        if (auto * pRecord = bindings.find(this))
+        {
+            return *static_cast<hazard_record *>(pRecord);
+        }
+
+        hazard_record * pRecord = nullptr;
+
+        {
+            std::lock_guard lock(sync);
+
+            const auto free_record = std::find_if(records.begin(), records.end(), [](const auto& entry) { return !entry->in_use; });
+
+            if (free_record != records.end())
+            {
+                pRecord = free_record->get();
+                pRecord->in_use = true;
+            }
+            else
+            {
+                pRecord = records.emplace_back(std::make_unique<hazard_record>()).get();
+            }
+        }
+
+        bindings.add(shared_from_this(), pRecord);
+        return *pRecord;
+    }
+
+    hazard_slot * acquire_slot()
+    {
+        for (auto * pSlot = slots.load(std::memory_order_acquire); pSlot != nullptr; pSlot = pSlot->pNext)
+        {
+            bool is_used = false;
+            if (!pSlot->in_use.load(std::memory_order_relaxed) && pSlot->in_use.compare_exchange_strong(is_used, true, std::memory_order_acquire))
+            {
+                return pSlot;
+            }
+        }
+
+        auto * pSlot = new hazard_slot();
+        pSlot->pNext = slots.load(std::memory_order_relaxed);
+
+        while (!slots.compare_exchange_weak(pSlot->pNext, pSlot, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+
+        slots_count.fetch_add(1, std::memory_order_relaxed);
+        return pSlot;
+    }
+
+    // Everything published right now, sorted for the lookups of free_safe
+    std::vector<void *> published() const
+    {
+        std::vector<void *> pointers;
+        pointers.reserve(slots_count.load(std::memory_order_relaxed));
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        for (auto * pSlot = slots.load(std::memory_order_acquire); pSlot != nullptr; pSlot = pSlot->pNext)
+        {
+            if (auto * pObject = pSlot->pointer.load(std::memory_order_seq_cst))
+            {
+                pointers.push_back(pObject);
+            }
+        }
+
+        std::sort(pointers.begin(), pointers.end());
+        return pointers;
+    }
+
+    size_t free_safe(std::vector<retired_object>& retired, const std::vector<void *>& hazards)
+    {
+        const auto freed = free_if(retired, [&hazards](const auto& entry) { return !std::binary_search(hazards.begin(), hazards.end(), entry.pObject); });
+
+        pending.fetch_sub(freed, std::memory_order_relaxed);
+        return freed;
+    }
+};
+
+hazard_domain::hazard_domain()
+    : m_state(std::make_shared<state>())
+{
+}
+
+hazard_domain::~hazard_domain()
+{
+    m_state->close();
+    m_state->is_closed.store(true);
+}
+
+void hazard_domain::retire(void * pObject, reclaim_deleter deleter)
+{
+    auto& record = m_state->local();
+
+    record.retired.push_back({ pObject, deleter, 0 });
+    m_state->pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (record.retired.size() >= std::max(batch_size, 2 * m_state->slots_count.load(std::memory_order_relaxed)))
+    {
+        collect();
+    }
+}
+
+void hazard_domain::collect()
+{
+    const auto hazards = m_state->published();
+
+    m_state->free_safe(m_state->local().retired, hazards);
+
+    std::unique_lock lock(m_state->sync, std::try_to_lock);
+
+    if (lock.owns_lock())
+    {
+        m_state->free_safe(m_state->orphans, hazards);
+    }
+}
+
+size_t hazard_domain::pending() const
+{
+    return m_state->pending.load(std::memory_order_relaxed);
+}
+
+hazard_domain& hazard_domain::shared()
+{
+    static hazard_domain instance;
+    return instance;
+}
+
+hazard_pointer::hazard_pointer(hazard_domain& domain)
+    : m_record(domain.m_state->acquire_slot())
+    , m_slot(&static_cast<hazard_slot *>(m_record)->pointer)
+{
+}
+
+hazard_pointer::~hazard_pointer()
+{
+    auto * pSlot = static_cast<hazard_slot *>(m_record);
+
+    pSlot->pointer.store(nullptr, std::memory_order_release);
+    pSlot->in_use.store(false, std::memory_order_release);
+}
+
+void hazard_pointer::reset()
+{
+    m_slot->store(nullptr, std::memory_order_release);
+}
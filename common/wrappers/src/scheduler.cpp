@@ -0,0 +1,142 @@
+#include <scheduler.hpp>
+
+using namespace retro::thread;
+
+main_thread_queue::main_thread_queue(size_t capacity)
+    : m_queue(capacity)
+{
+}
+
+void main_thread_queue::post(unique_function<void()> work)
+{
+    if (is_main_thread())
+    {
+        // Nobody else drains: waiting for room would hang the owner, so it makes room itself, oldest first
+        while (!m_queue.try_push(std::move(work)))
+        {
+            if (auto queued = m_queue.try_pop())
+            {
+                (*queued)();
+            }
+        }
+    }
+    else
+    {
+        m_queue.push(std::move(work));
+    }
+
+    if (auto * notify = m_notify.load(std::memory_order_acquire))
+    {
+        notify();
+    }
+}
+
+size_t main_thread_queue::drain()
+{
+    const auto pending = m_queue.size();
+    size_t ran = 0;
+
+    while (ran < pending)
+    {
+        auto work = m_queue.try_pop();
+
+        if (!work)
+        {
+            break;
+        }
+
+        (*work)();
+        ran++;
+    }
+
+    return ran;
+}
+
+void main_thread_queue::bind_to_current_thread()
+{
+    m_owner.store(std::this_thread::get_id(), std::memory_order_release);
+}
+
+void main_thread_queue::set_notifier(void (*notify)())
+{
+    m_notify.store(notify, std::memory_order_release);
+}
+
+bool main_thread_queue::is_main_thread() const
+{
+    return m_owner.load(std::memory_order_acquire) == std::this_thread::get_id();
+}
+
+main_thread_queue& main_thread_queue::shared()
+{
+    static main_thread_queue instance;
+    return instance;
+}
+
+timer_service::timer_service()
+{
+    m_thread.run([this]() { loop(); });
+}
+
+timer_service::~timer_service()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_is_stopping = true;
+    }
+
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void timer_service::schedule(clock::time_point deadline, unique_function<void()> callback)
+{
+    bool is_earliest;
+    {
+        std::lock_guard lock(m_mutex);
+
+        is_earliest = m_entries.empty() || deadline < m_entries.top().deadline;
+        m_entries.push(entry { deadline, m_next_sequence++, std::move(callback) });
+    }
+
+    // A later deadline does not change how long the timer thread sleeps
+    if (is_earliest)
+    {
+        m_wake.notify_one();
+    }
+}
+
+timer_service& timer_service::shared()
+{
+    static timer_service instance;
+    return instance;
+}
+
+void timer_service::loop()
+{
+    std::unique_lock lock(m_mutex);
+
+    while (!m_is_stopping)
+    {
+        if (m_entries.empty())
+        {
+            m_wake.wait(lock);
+            continue;
+        }
+
+        const auto deadline = m_entries.top().deadline;
+
+        if (clock::now() < deadline)
+        {
+            m_wake.wait_until(lock, deadline);
+            continue;
+        }
+
+        auto callback = std::move(m_entries.top().callback);
+        m_entries.pop();
+
+        lock.unlock();
+        callback();
+        lock.lock();
+    }
+}
@@ -0,0 +1,115 @@
+#include <team.hpp>
+#include <trace.hpp>
+
+#include <thread>
+#include <utility>
+#include <algorithm>
+
+using namespace retro::thread;
+
+namespace
+{
+    uint32_t resolve_size(uint32_t size)
+    {
+        return size != 0 ? size : std::max(std::thread::hardware_concurrency(), 1U);
+    }
+}
+
+team::team(uint32_t size, pin_policy policy)
+    : m_size(resolve_size(size))
+    , m_pin_policy(policy)
+    , m_barrier(m_size)
+{
+    const auto& cpus = topology::current();
+
+    m_members.reserve(m_size - 1);
+
+    for (uint32_t index = 1; index < m_size; index++)
+    {
+        m_members.emplace_back([this, index]() { member_loop(index); });
+        m_members.back().set_affinity(cpus.cpu_for(policy, index));
+        m_members.back().run();
+    }
+}
+
+team::~team()
+{
+    m_is_stopping = true;
+    m_barrier.arrive_and_wait(0);
+
+    for (auto& member : m_members)
+    {
+        member.join();
+    }
+}
+
+bool team::sync(uint32_t index)
+{
+    return m_barrier.arrive_and_wait(index);
+}
+
+uint32_t team::size() const
+{
+    return m_size;
+}
+
+pin_policy team::get_pin_policy() const
+{
+    return m_pin_policy;
+}
+
+void team::dispatch(void * pBody, invoker invoke)
+{
+    m_body = pBody;
+    m_invoke = invoke;
+
+    m_barrier.arrive_and_wait(0);
+    run_body(0);
+    m_barrier.arrive_and_wait(0);
+
+    m_body = nullptr;
+    m_invoke = nullptr;
+
+    if (m_has_failed.load(std::memory_order_relaxed))
+    {
+        auto exception = std::exchange(m_exception, nullptr);
+        m_has_failed.store(false, std::memory_order_relaxed);
+
+        std::rethrow_exception(exception);
+    }
+}
+
+void team::run_body(uint32_t index)
+{
+    try
+    {
+        // One zone per member and dispatch, the timeline shows the imbalance of a parallel region directly
+        trace::zone _("Team body");
+        m_invoke(m_body, index, m_size);
+    }
+    catch (...)
+    {
+        if (!m_has_failed.exchange(true, std::memory_order_relaxed))
+        {
+            m_exception = std::current_exception();
+        }
+    }
+}
+
+void team::member_loop(uint32_t index)
+{
+    trace::set_thread_name("Team member " + std::to_string(index));
+
+    while (true)
+    {
+        m_barrier.arrive_and_wait(index);
+
+        if (m_is_stopping)
+        {
+            return;
+        }
+
+        run_body(index);
+        m_barrier.arrive_and_wait(index);
+    }
+}
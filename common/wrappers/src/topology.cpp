@@ -0,0 +1,179 @@
+#include <topology.hpp>
+
+#include <map>
+#include <tuple>
+#include <algorithm>
+
+using namespace retro::thread;
+
+namespace
+{
+    // Dense index per distinct key, in order of first appearance
+    template<typename Getter>
+    void renumber(std::vector<logical_cpu>& cpus, Getter&& get)
+    {
+        std::map<uint32_t, uint32_t> dense;
+
+        for (auto& cpu : cpus)
+        {
+            auto& key = get(cpu);
+            key = dense.try_emplace(key, static_cast<uint32_t>(dense.size())).first->second;
+        }
+    }
+
+    template<typename Getter>
+    uint32_t count_distinct(const std::vector<logical_cpu>& cpus, Getter&& get)
+    {
+        uint32_t count = 0;
+
+        for (const auto& cpu : cpus)
+        {
+            count = std::max(count, get(cpu) + 1);
+        }
+
+        return count;
+    }
+
+    const char * plural(uint32_t count, const char * singular, const char * multiple)
+    {
+        return count == 1 ? singular : multiple;
+    }
+}
+
+const topology& topology::current()
+{
+    static const topology instance = detect();
+    return instance;
+}
+
+const std::vector<logical_cpu>& topology::cpus() const
+{
+    return m_cpus;
+}
+
+uint32_t topology::logical_count() const
+{
+    return static_cast<uint32_t>(m_cpus.size());
+}
+
+uint32_t topology::physical_core_count() const
+{
+    return count_distinct(m_cpus, [](const logical_cpu& cpu) { return cpu.core; });
+}
+
+uint32_t topology::package_count() const
+{
+    return count_distinct(m_cpus, [](const logical_cpu& cpu) { return cpu.package; });
+}
+
+uint32_t topology::numa_node_count() const
+{
+    return count_distinct(m_cpus, [](const logical_cpu& cpu) { return cpu.numa_node; });
+}
+
+uint32_t topology::llc_count() const
+{
+    return count_distinct(m_cpus, [](const logical_cpu& cpu) { return cpu.llc; });
+}
+
+std::vector<uint32_t> topology::order(pin_policy policy) const
+{
+    auto sorted = m_cpus;
+
+    switch (policy)
+    {
+        case pin_policy::none:
+            return { };
+
+        case pin_policy::compact:
+        case pin_policy::physical_cores:
+            std::sort(sorted.begin(), sorted.end(),
+                      [](const logical_cpu& lhs, const logical_cpu& rhs)
+                      {
+                          return std::tie(lhs.numa_node, lhs.package, lhs.llc, lhs.core, lhs.smt_index, lhs.id)
+                                 < std::tie(rhs.numa_node, rhs.package, rhs.llc, rhs.core, rhs.smt_index, rhs.id);
+                      });
+
+            if (policy == pin_policy::physical_cores)
+            {
+                std::erase_if(sorted, [](const logical_cpu& cpu) { return cpu.smt_index != 0; });
+            }
+            break;
+
+        case pin_policy::scatter:
+        {
+            // Rank of each core inside its NUMA node, so the k-th core of every node comes before any k+1-th
+            std::vector<uint32_t> core_rank(physical_core_count(), 0);
+            std::map<uint32_t, uint32_t> cores_seen;
+
+            for (const auto& cpu : m_cpus)
+            {
+                if (cpu.smt_index == 0)
+                {
+                    core_rank.at(cpu.core) = cores_seen[cpu.numa_node]++;
+                }
+            }
+
+            std::sort(sorted.begin(), sorted.end(),
+                      [&](const logical_cpu& lhs, const logical_cpu& rhs)
+                      {
+                          return std::make_tuple(lhs.smt_index, core_rank.at(lhs.core), lhs.numa_node, lhs.id)
+                                 < std::make_tuple(rhs.smt_index, core_rank.at(rhs.core), rhs.numa_node, rhs.id);
+                      });
+            break;
+        }
+    }
+
+    std::vector<uint32_t> ids;
+    ids.reserve(sorted.size());
+
+    for (const auto& cpu : sorted)
+    {
+        ids.push_back(cpu.id);
+    }
+
+    return ids;
+}
+
+int32_t topology::cpu_for(pin_policy policy, uint32_t index) const
+{
+    const auto ids = order(policy);
+    return ids.empty() ? -1 : static_cast<int32_t>(ids.at(index % ids.size()));
+}
+
+std::string topology::describe() const
+{
+    const auto logical = logical_count();
+    const auto cores = physical_core_count();
+    const auto packages = package_count();
+    const auto nodes = numa_node_count();
+    const auto caches = llc_count();
+
+    return std::to_string(logical) + plural(logical, " logical CPU, ", " logical CPUs, ")
+           + std::to_string(cores) + plural(cores, " core, ", " cores, ")
+           + std::to_string(packages) + plural(packages, " package, ", " packages, ")
+           + std::to_string(nodes) + plural(nodes, " NUMA node, ", " NUMA nodes, ")
+           + std::to_string(caches) + plural(caches, " LLC group", " LLC groups");
+}
+
+void topology::normalize()
+{
+    std::sort(m_cpus.begin(), m_cpus.end(), [](const logical_cpu& lhs, const logical_cpu& rhs) { return lhs.id < rhs.id; });
+
+    renumber(m_cpus, [](logical_cpu& cpu) -> uint32_t& { return cpu.core; });
+    renumber(m_cpus, [](logical_cpu& cpu) -> uint32_t& { return cpu.package; });
+    renumber(m_cpus, [](logical_cpu& cpu) -> uint32_t& { return cpu.numa_node; });
+    renumber(m_cpus, [](logical_cpu& cpu) -> uint32_t& { return cpu.llc; });
+
+    std::map<uint32_t, uint32_t> siblings_seen;
+
+    for (auto& cpu : m_cpus)
+    {
+        cpu.smt_index = siblings_seen[cpu.core]++;
+    }
+}
+
+bool retro::thread::pin_current_thread(pin_policy policy, uint32_t index)
+{
+    return pin_current_thread(topology::current().cpu_for(policy, index));
+}
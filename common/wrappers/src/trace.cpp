@@ -0,0 +1,394 @@
+#include <trace.hpp>
+
+#include <cpu.hpp>
+
+#include <set>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+
+using namespace retro::trace;
+
+namespace
+{
+    // Written by its thread only, drained by collect() only (under the registry lock): a plain SPSC ring
+    struct thread_ring
+    {
+        static constexpr uint32_t capacity = 8192;
+
+        std::array<event, capacity> events;
+
+        alignas(retro::sync::cache_line_size) std::atomic<uint32_t> head { 0 };
+        alignas(retro::sync::cache_line_size) std::atomic<uint32_t> tail { 0 };
+
+        std::atomic<uint64_t> dropped { 0 };
+
+        // Set once on registration, the rest is guarded by the registry lock
+        uint32_t id = 0;
+        std::string name;
+
+        // Drained events, oldest first
+        std::deque<event> history;
+
+        void push(const event& recorded)
+        {
+            const auto position = head.load(std::memory_order_relaxed);
+
+            if (position - tail.load(std::memory_order_acquire) == capacity)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            events[position % capacity] = recorded;
+            head.store(position + 1, std::memory_order_release);
+        }
+    };
+
+    struct registry
+    {
+        std::mutex sync;
+
+        // Rings outlive their threads until their history ages out, so an exited thread stays on the timeline
+        std::vector<std::shared_ptr<thread_ring>> rings;
+
+        std::set<std::string, std::less<>> names;
+
+        uint32_t next_thread_id = 0;
+        uint64_t dropped = 0;
+
+        std::atomic<int64_t> history_ms { 10000 };
+        std::atomic<uint64_t> next_flow_id { 1 };
+    };
+
+    registry& get_registry()
+    {
+        static registry instance;
+        return instance;
+    }
+
+    // Set by set_thread_name() before the thread recorded anything, picked up when its ring is created
+    thread_local std::string pending_name;
+
+    // The ring is about 400 KB: a thread only gets one once it records its first event, not for being named
+    thread_local std::shared_ptr<thread_ring> current_ring;
+
+    thread_ring& local_ring()
+    {
+        if (!current_ring)
+        {
+            auto created = std::make_shared<thread_ring>();
+
+            auto& shared = get_registry();
+            std::lock_guard lock(shared.sync);
+
+            created->id = shared.next_thread_id++;
+            created->name = pending_name.empty() ? "Thread " + std::to_string(created->id) : std::move(pending_name);
+
+            shared.rings.push_back(created);
+            current_ring = std::move(created);
+        }
+
+        return *current_ring;
+    }
+
+    uint64_t end_of(const event& recorded)
+    {
+        return recorded.start_ns + recorded.duration_ns;
+    }
+
+    // Per thread, whatever the history length: fine-grained zones over a long history would eat the memory
+    constexpr size_t max_history_events = 1 << 20;
+
+    // Expects the registry lock to be held
+    void drain(registry& shared, bool keep)
+    {
+        const auto now = now_ns();
+        const auto history_ns = static_cast<uint64_t>(shared.history_ms.load(std::memory_order_relaxed)) * 1000000;
+        const auto cutoff = now > history_ns ? now - history_ns : 0;
+
+        for (const auto& ring : shared.rings)
+        {
+            const auto end = ring->head.load(std::memory_order_acquire);
+
+            for (auto position = ring->tail.load(std::memory_order_relaxed); keep && position != end; position++)
+            {
+                ring->history.push_back(ring->events[position % thread_ring::capacity]);
+            }
+
+            ring->tail.store(end, std::memory_order_release);
+            shared.dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+
+            if (!keep)
+            {
+                ring->history.clear();
+            }
+
+            // Roughly in end time order, a zone that outlived its children is trimmed after them
+            while (!ring->history.empty() && (end_of(ring->history.front()) < cutoff || ring->history.size() > max_history_events))
+            {
+                ring->history.pop_front();
+            }
+        }
+
+        // Only the registry still points at the ring of a thread that has exited, and nothing of it is left
+        std::erase_if(shared.rings, [](const std::shared_ptr<thread_ring>& ring) { return ring.use_count() == 1 && ring->history.empty(); });
+    }
+
+    void record_point(event_kind kind, const char * name, uint64_t flow_id, double value)
+    {
+        if (!is_recording())
+        {
+            return;
+        }
+
+        event recorded;
+
+        recorded.name = name;
+        recorded.kind = kind;
+        recorded.depth = detail::depth;
+        recorded.start_ns = now_ns();
+        recorded.flow_id = flow_id;
+        recorded.value = value;
+
+        detail::record(recorded);
+    }
+
+    void write_escaped(std::ostream& out, std::string_view text)
+    {
+        for (const auto symbol : text)
+        {
+            if (symbol == '"' || symbol == '\\')
+            {
+                out << '\\' << symbol;
+            }
+            else if (static_cast<unsigned char>(symbol) < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(symbol));
+
+                out << escaped;
+            }
+            else
+            {
+                out << symbol;
+            }
+        }
+    }
+
+    // Chrome wants microseconds, the fraction keeps the nanoseconds
+    void write_time(std::ostream& out, const char * key, uint64_t ns)
+    {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "\"%s\":%.3f", key, static_cast<double>(ns) / 1e3);
+
+        out << buffer;
+    }
+
+    void write_event(std::ostream& out, uint32_t tid, const event& recorded)
+    {
+        static constexpr std::array<const char *, 5> phases = { "X", "C", "s", "t", "f" };
+
+        out << "{\"name\":\"";
+        write_escaped(out, recorded.name);
+        out << "\",\"ph\":\"" << phases.at(static_cast<size_t>(recorded.kind)) << "\",\"pid\":1,\"tid\":" << tid << ",";
+        write_time(out, "ts", recorded.start_ns);
+
+        switch (recorded.kind)
+        {
+            case event_kind::zone:
+                out << ",";
+                write_time(out, "dur", recorded.duration_ns);
+                break;
+
+            case event_kind::counter:
+                out << ",\"args\":{\"value\":" << recorded.value << "}";
+                break;
+
+            default:
+                // "e" binds the end of the arrow to the zone it lands in rather than the next one to start
+                out << ",\"cat\":\"flow\",\"id\":" << recorded.flow_id << (recorded.kind == event_kind::flow_end ? ",\"bp\":\"e\"" : "");
+                break;
+        }
+
+        out << "}";
+    }
+}
+
+void retro::trace::detail::record(const event& recorded)
+{
+    local_ring().push(recorded);
+}
+
+void retro::trace::start()
+{
+    detail::is_recording.store(true, std::memory_order_relaxed);
+}
+
+void retro::trace::stop()
+{
+    detail::is_recording.store(false, std::memory_order_relaxed);
+}
+
+uint64_t retro::trace::now_ns()
+{
+    using clock = std::chrono::steady_clock;
+
+    static const auto origin = clock::now();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - origin).count());
+}
+
+const char * retro::trace::intern(std::string_view name)
+{
+    auto& shared = get_registry();
+    std::lock_guard lock(shared.sync);
+
+    auto found = shared.names.find(name);
+
+    if (found == shared.names.end())
+    {
+        found = shared.names.emplace(name).first;
+    }
+
+    return found->c_str();
+}
+
+void retro::trace::set_thread_name(std::string_view name)
+{
+    if (!current_ring)
+    {
+        pending_name = name;
+        return;
+    }
+
+    auto& shared = get_registry();
+    std::lock_guard lock(shared.sync);
+
+    current_ring->name = name;
+}
+
+void retro::trace::set_history(std::chrono::milliseconds history)
+{
+    get_registry().history_ms.store(std::max<int64_t>(history.count(), 1), std::memory_order_relaxed);
+}
+
+std::chrono::milliseconds retro::trace::history()
+{
+    return std::chrono::milliseconds(get_registry().history_ms.load(std::memory_order_relaxed));
+}
+
+snapshot retro::trace::collect(std::chrono::milliseconds window)
+{
+    auto& shared = get_registry();
+    std::lock_guard lock(shared.sync);
+
+    drain(shared, true);
+
+    snapshot result;
+    result.end_ns = now_ns();
+    result.dropped = shared.dropped;
+
+    const auto window_ns = static_cast<uint64_t>(window.count()) * 1000000;
+    result.begin_ns = window_ns > 0 && result.end_ns > window_ns ? result.end_ns - window_ns : 0;
+
+    for (const auto& ring : shared.rings)
+    {
+        thread_timeline timeline;
+
+        timeline.id = ring->id;
+        timeline.name = ring->name;
+
+        for (const auto& recorded : ring->history)
+        {
+            if (end_of(recorded) >= result.begin_ns)
+            {
+                timeline.events.push_back(recorded);
+            }
+        }
+
+        if (!timeline.events.empty())
+        {
+            result.threads.push_back(std::move(timeline));
+        }
+    }
+
+    std::sort(result.threads.begin(), result.threads.end(), [](const thread_timeline& lhs, const thread_timeline& rhs) { return lhs.id < rhs.id; });
+    return result;
+}
+
+void retro::trace::reset()
+{
+    auto& shared = get_registry();
+    std::lock_guard lock(shared.sync);
+
+    drain(shared, false);
+    shared.dropped = 0;
+}
+
+bool retro::trace::export_chrome(const std::string& path)
+{
+    const auto result = collect();
+    std::ofstream file(path);
+
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+    bool is_first = true;
+
+    const auto separate = [&]()
+    {
+        file << (is_first ? "" : ",\n");
+        is_first = false;
+    };
+
+    for (const auto& thread : result.threads)
+    {
+        separate();
+
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.id << ",\"args\":{\"name\":\"";
+        write_escaped(file, thread.name);
+        file << "\"}}";
+
+        for (const auto& recorded : thread.events)
+        {
+            separate();
+            write_event(file, thread.id, recorded);
+        }
+    }
+
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+uint64_t retro::trace::new_flow_id()
+{
+    return get_registry().next_flow_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+void retro::trace::counter(const char * name, double value)
+{
+    record_point(event_kind::counter, name, 0, value);
+}
+
+void retro::trace::flow_begin(const char * name, uint64_t id)
+{
+    record_point(event_kind::flow_begin, name, id, 0.0);
+}
+
+void retro::trace::flow_step(const char * name, uint64_t id)
+{
+    record_point(event_kind::flow_step, name, id, 0.0);
+}
+
+void retro::trace::flow_end(const char * name, uint64_t id)
+{
+    record_point(event_kind::flow_end, name, id, 0.0);
+}
@@ -0,0 +1,30 @@
+#include <futex.hpp>
+
+#include <windows.h>
+
+void retro::sync::futex_wait(std::atomic<uint32_t>& word, uint32_t expected)
+{
+    WaitOnAddress(&word, &expected, sizeof(expected), INFINITE);
+}
+
+bool retro::sync::futex_wait_for(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout)
+{
+    const auto milliseconds = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+
+    if (!WaitOnAddress(&word, &expected, sizeof(expected), static_cast<DWORD>(milliseconds)))
+    {
+        return GetLastError() != ERROR_TIMEOUT;
+    }
+
+    return true;
+}
+
+void retro::sync::futex_wake_one(std::atomic<uint32_t>& word)
+{
+    WakeByAddressSingle(&word);
+}
+
+void retro::sync::futex_wake_all(std::atomic<uint32_t>& word)
+{
+    WakeByAddressAll(&word);
+}
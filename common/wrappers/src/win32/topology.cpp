@@ -0,0 +1,151 @@
+#include <topology.hpp>
+
+#include <windows.h>
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+using namespace retro::thread;
+
+namespace
+{
+    template<typename Visitor>
+    void for_each_cpu(const GROUP_AFFINITY& affinity, Visitor&& visit)
+    {
+        for (uint32_t bit = 0; bit < sizeof(KAFFINITY) * 8; bit++)
+        {
+            if ((affinity.Mask & (static_cast<KAFFINITY>(1) << bit)) != 0)
+            {
+                visit(static_cast<uint32_t>(affinity.Group) * 64 + bit);
+            }
+        }
+    }
+
+    std::vector<char> query(LOGICAL_PROCESSOR_RELATIONSHIP relationship)
+    {
+        DWORD length = 0;
+        GetLogicalProcessorInformationEx(relationship, nullptr, &length);
+
+        std::vector<char> buffer(length);
+
+        if (length == 0 || !GetLogicalProcessorInformationEx(relationship, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &length))
+        {
+            return { };
+        }
+
+        return buffer;
+    }
+
+    template<typename Visitor>
+    void for_each_entry(LOGICAL_PROCESSOR_RELATIONSHIP relationship, Visitor&& visit)
+    {
+        const auto buffer = query(relationship);
+
+        for (size_t offset = 0; offset < buffer.size();)
+        {
+            const auto * pEntry = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX *>(buffer.data() + offset);
+
+            visit(*pEntry);
+            offset += pEntry->Size;
+        }
+    }
+}
+
+topology topology::detect()
+{
+    topology result;
+
+    // Cores come first, they define the set of CPUs; every other relation only annotates it
+    uint32_t core_key = 0;
+
+    for_each_entry(RelationProcessorCore, [&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& entry)
+    {
+        for (WORD group = 0; group < entry.Processor.GroupCount; group++)
+        {
+            for_each_cpu(entry.Processor.GroupMask[group], [&](uint32_t id)
+            {
+                logical_cpu cpu;
+
+                cpu.id = id;
+                cpu.core = core_key;
+                cpu.llc = core_key;
+
+                result.m_cpus.push_back(cpu);
+            });
+        }
+
+        core_key++;
+    });
+
+    auto annotate = [&](const GROUP_AFFINITY& affinity, auto&& apply)
+    {
+        for_each_cpu(affinity, [&](uint32_t id)
+        {
+            for (auto& cpu : result.m_cpus)
+            {
+                if (cpu.id == id)
+                {
+                    apply(cpu);
+                }
+            }
+        });
+    };
+
+    uint32_t package_key = 0;
+
+    for_each_entry(RelationProcessorPackage, [&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& entry)
+    {
+        for (WORD group = 0; group < entry.Processor.GroupCount; group++)
+        {
+            annotate(entry.Processor.GroupMask[group], [&](logical_cpu& cpu) { cpu.package = package_key; });
+        }
+
+        package_key++;
+    });
+
+    for_each_entry(RelationNumaNode, [&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& entry)
+    {
+        annotate(entry.NumaNode.GroupMask, [&](logical_cpu& cpu) { cpu.numa_node = entry.NumaNode.NodeNumber; });
+    });
+
+    // Keyed by level so that the deepest cache wins whatever order the entries come in
+    std::vector<uint32_t> llc_level(result.m_cpus.size(), 0);
+    uint32_t cache_key = core_key;
+
+    for_each_entry(RelationCache, [&](const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX& entry)
+    {
+        const auto level = static_cast<uint32_t>(entry.Cache.Level);
+
+        for_each_cpu(entry.Cache.GroupMask, [&](uint32_t id)
+        {
+            for (size_t i = 0; i < result.m_cpus.size(); i++)
+            {
+                if (result.m_cpus.at(i).id == id && level >= llc_level.at(i))
+                {
+                    llc_level.at(i) = level;
+                    result.m_cpus.at(i).llc = cache_key;
+                }
+            }
+        });
+
+        cache_key++;
+    });
+
+    if (result.m_cpus.empty())
+    {
+        for (uint32_t id = 0; id < std::max(std::thread::hardware_concurrency(), 1U); id++)
+        {
+            logical_cpu cpu;
+
+            cpu.id = id;
+            cpu.core = id;
+            cpu.llc = id;
+
+            result.m_cpus.push_back(cpu);
+        }
+    }
+
+    result.normalize();
+    return result;
+}
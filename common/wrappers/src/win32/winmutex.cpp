@@ -17,7 +17,32 @@ winmutex::~winmutex()
     CloseHandle(m_hMutex);
 }
 
+#if defined(RETRO_LOCK_PROFILING)
+void winmutex::lock(std::source_location site)
+{
+    const auto started = profiling::clock::now();
+    const bool is_contended = !try_lock_native();
+
+    if (is_contended)
+    {
+        lock_native();
+    }
+
+    m_probe.acquired(started, is_contended, site);
+}
+
+bool winmutex::try_lock_native()
+{
+    return WaitForSingleObject(m_hMutex, 0) == WAIT_OBJECT_0;
+}
+#else
 void winmutex::lock()
+{
+    lock_native();
+}
+#endif
+
+void winmutex::lock_native()
 {
     const auto result = WaitForSingleObject(m_hMutex, INFINITE);
 
@@ -39,6 +64,10 @@ void winmutex::lock()
 
 void winmutex::unlock()
 {
+#if defined(RETRO_LOCK_PROFILING)
+    m_probe.released(this);
+#endif
+
     if (!ReleaseMutex(m_hMutex))
     {
         throw std::runtime_error("Failed to unlock mutex");
@@ -0,0 +1,252 @@
+#include <winthread.hpp>
+#include <topology.hpp>
+
+#include <stdexcept>
+
+using namespace retro::thread;
+
+namespace
+{
+    auto get_native_priority(priority e_priority)
+    {
+        switch (e_priority)
+        {
+            case priority::low:
+                return THREAD_PRIORITY_LOWEST;
+
+            case priority::below_normal:
+                return THREAD_PRIORITY_BELOW_NORMAL;
+
+            case priority::normal:
+                return THREAD_PRIORITY_NORMAL;
+
+            case priority::above_normal:
+                return THREAD_PRIORITY_ABOVE_NORMAL;
+
+            case priority::high:
+                return THREAD_PRIORITY_HIGHEST;
+        }
+
+        return THREAD_PRIORITY_HIGHEST;
+    }
+
+    bool apply_native_affinity(HANDLE hThread, int32_t cpu)
+    {
+        if (cpu < 0)
+        {
+            DWORD_PTR process_mask = 0;
+            DWORD_PTR system_mask = 0;
+
+            return GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)
+                   && SetThreadAffinityMask(hThread, process_mask) != 0;
+        }
+
+        // topology numbers CPUs as group * 64 + index inside the group
+        GROUP_AFFINITY affinity { };
+        affinity.Group = static_cast<WORD>(cpu / 64);
+        affinity.Mask = static_cast<KAFFINITY>(1) << (cpu % 64);
+
+        return SetThreadGroupAffinity(hThread, &affinity, nullptr) != 0;
+    }
+}
+
+winthread& winthread::operator=(winthread&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (m_context && m_context->load_state() == state::running)
+        {
+            join();
+        }
+
+        if (m_context && m_context->hThread != nullptr)
+        {
+            CloseHandle(m_context->hThread);
+        }
+
+        m_context = std::move(other.m_context);
+    }
+
+    return *this;
+}
+
+winthread::~winthread()
+{
+    if (!m_context)
+    {
+        return;
+    }
+
+    if (m_context->load_state() == state::running)
+    {
+        join();
+    }
+
+    if (m_context->hThread != nullptr)
+    {
+        CloseHandle(m_context->hThread);
+    }
+}
+
+void winthread::run()
+{
+    if (m_context->invoke)
+    {
+        if (m_context->load_state() == state::running)
+        {
+            join();
+        }
+
+        if (m_context->hThread != nullptr)
+        {
+            CloseHandle(m_context->hThread);
+        }
+
+        // Flag the thread as running before it exists, otherwise a join() right after run() may return early
+        m_context->start_ticks.store(0, std::memory_order_relaxed);
+        m_context->finish_ticks.store(0, std::memory_order_relaxed);
+        m_context->stop = std::stop_source();
+        m_context->store_state(state::running);
+
+        m_context->hThread = CreateThread(nullptr, 0, thread_function, m_context.get(), 0, nullptr);
+
+        if (m_context->hThread == nullptr)
+        {
+            m_context->store_state(state::idle);
+            throw std::runtime_error("Error: the thread could not be created");
+        }
+    }
+    else
+    {
+        throw std::runtime_error("Error: Runnable not assigned");
+    }
+}
+
+void winthread::join()
+{
+    if (m_context->hThread == nullptr)
+    {
+        throw std::runtime_error("Error: No thread to join");
+    }
+
+    if (m_context->load_state() != state::paused)
+    {
+        WaitForSingleObject(m_context->hThread, INFINITE);
+        CloseHandle(m_context->hThread);
+
+        m_context->hThread = nullptr;
+    }
+}
+
+void winthread::pause()
+{
+    if (m_context->exchange_state(state::running, state::paused))
+    {
+        SuspendThread(m_context->hThread);
+    }
+    else if (!is_paused())
+    {
+        throw std::runtime_error("Error: No running thread to pause");
+    }
+}
+
+void winthread::resume()
+{
+    // A suspended worker can not finish, so paused always goes back to running here
+    if (m_context->exchange_state(state::paused, state::running))
+    {
+        ResumeThread(m_context->hThread);
+    }
+    else if (!is_running())
+    {
+        throw std::runtime_error("Error: No running thread to resume");
+    }
+}
+
+void winthread::terminate()
+{
+    if (is_running())
+    {
+        TerminateThread(m_context->hThread, 0);
+        CloseHandle(m_context->hThread);
+
+        m_context->hThread = nullptr;
+
+        m_context->stamp(m_context->finish_ticks);
+        m_context->store_state(state::finished);
+    }
+    else
+    {
+        throw std::runtime_error("Error: No running thread to stop");
+    }
+}
+
+priority winthread::get_priority()
+{
+    return m_context->current_priority;
+}
+
+void winthread::set_priority(priority priority)
+{
+    m_context->current_priority = priority;
+
+    if (!is_running() || !m_context->hThread)
+    {
+        return;
+    }
+
+    if (!SetThreadPriority(m_context->hThread, get_native_priority(priority)))
+    {
+        throw std::runtime_error("Error: Failed to set thread priority");
+    }
+}
+
+void winthread::set_affinity(int32_t cpu)
+{
+    m_context->affinity = cpu;
+
+    if (!is_running() || !m_context->hThread)
+    {
+        return;
+    }
+
+    if (!apply_native_affinity(m_context->hThread, cpu))
+    {
+        throw std::runtime_error("Error: Failed to set thread affinity");
+    }
+}
+
+int32_t winthread::get_affinity() const
+{
+    return m_context->affinity;
+}
+
+void winthread::safe_point()
+{
+    // SuspendThread stops the worker wherever it is, there is nothing to wait for here
+}
+
+DWORD WINAPI winthread::thread_function(LPVOID lpParam)
+{
+    auto * pContext = static_cast<context *>(lpParam);
+
+    m_current_context = pContext;
+
+    if (pContext->affinity >= 0)
+    {
+        apply_native_affinity(GetCurrentThread(), pContext->affinity);
+    }
+
+    pContext->stamp(pContext->start_ticks);
+
+    pContext->invoke();
+
+    pContext->stamp(pContext->finish_ticks);
+    pContext->store_state(state::finished);
+    return 0;
+}
+
+bool retro::thread::pin_current_thread(int32_t cpu)
+{
+    return apply_native_affinity(GetCurrentThread(), cpu);
+}
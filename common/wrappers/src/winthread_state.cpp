@@ -0,0 +1,93 @@
+#include <winthread.hpp>
+
+#include <futex.hpp>
+
+using namespace retro::thread;
+
+// The state machine is shared by both backends, only the way a thread is started, suspended and killed differs
+
+void winthread::context::store_state(state new_state)
+{
+    status.store(static_cast<uint32_t>(new_state), std::memory_order_release);
+    sync::futex_wake_all(status);
+}
+
+bool winthread::context::exchange_state(state expected, state desired)
+{
+    auto current = static_cast<uint32_t>(expected);
+
+    if (!status.compare_exchange_strong(current, static_cast<uint32_t>(desired), std::memory_order_acq_rel))
+    {
+        return false;
+    }
+
+    sync::futex_wake_all(status);
+    return true;
+}
+
+[[nodiscard]] bool winthread::is_paused() const
+{
+    return m_context->load_state() == state::paused;
+}
+
+[[nodiscard]] bool winthread::is_running() const
+{
+    const auto current = m_context->load_state();
+    return current == state::running || current == state::paused;
+}
+
+[[nodiscard]] bool winthread::is_finished() const
+{
+    return m_context->load_state() == state::finished;
+}
+
+[[nodiscard]] state winthread::get_state() const
+{
+    return m_context->load_state();
+}
+
+bool winthread::wait_for_state(state target, std::chrono::nanoseconds timeout) const
+{
+    const auto deadline = clock::now() + timeout;
+    auto current = m_context->status.load(std::memory_order_acquire);
+
+    while (current != static_cast<uint32_t>(target))
+    {
+        const auto now = clock::now();
+
+        if (now >= deadline)
+        {
+            return false;
+        }
+
+        sync::futex_wait_for(m_context->status, current, deadline - now);
+        current = m_context->status.load(std::memory_order_acquire);
+    }
+
+    return true;
+}
+
+[[nodiscard]] winthread::clock::time_point winthread::get_start_time() const
+{
+    return clock::time_point(clock::duration(m_context->start_ticks.load(std::memory_order_relaxed)));
+}
+
+[[nodiscard]] winthread::clock::time_point winthread::get_finish_time() const
+{
+    return clock::time_point(clock::duration(m_context->finish_ticks.load(std::memory_order_relaxed)));
+}
+
+bool winthread::request_stop()
+{
+    return m_context->stop.request_stop();
+}
+
+[[nodiscard]] std::stop_token winthread::get_stop_token() const
+{
+    return m_context->stop.get_token();
+}
+
+std::stop_token winthread::current_stop_token()
+{
+    return m_current_context != nullptr ? m_current_context->stop.get_token() : std::stop_token();
+}